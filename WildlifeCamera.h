@@ -38,7 +38,13 @@
 #include "config.h"
 #include "pir.h"
 #include "camera.h"
+#include "dedup.h"
+#include "eventlog.h"
+#include "logger.h"
+#include "photoserver.h"
+#include "scheduler.h"
 #include "telegram.h"
+#include "timelapse.h"
 
 
 /**
@@ -49,6 +55,7 @@ struct {
   bool motionDetected = false;
   uint8_t *photo = NULL;
   long photoLength = 0;
+  uint16_t photoCounter = 0;    //Photo DB counter of the photo (0: not saved on SD Card)
 } __PIR;
 
 //Low Battery (data kept across deep sleeps)
@@ -59,12 +66,14 @@ RTC_DATA_ATTR struct {
   uint32_t batteryVoltageMillivoltsEffective = 0;
   uint8_t batteryLastNotificationLevel = 5;
   unsigned long startupTimestamp = 0;
+  long utcOffset = (NTP_TIMEZONE * 3600);   //In seconds, timezone and DST offset of the local time (the timezone is not set after a deep sleep until NTP is configured)
 } __System;
 
 //Wake Up
 struct {
   esp_sleep_wakeup_cause_t reason;
   unsigned long end = 0;
+  bool commandsReceived = false;
 } __WakeUp;
 
 //Timers
@@ -78,12 +87,20 @@ struct {
  * Functions
  */
 unsigned long setWakeupEnd(unsigned long increase);
+unsigned long getWakeupRemaining();
 unsigned long getTimestamp();
 unsigned long getUptime();
+int8_t getHour(unsigned long timestamp);
+unsigned long getWakeupDuration();
+void timezoneSave();
 String getDateFormat(String format, time_t timestamp);
 uint32_t getBatteryVoltage(bool getRaw);
 uint8_t getBatteryLevel();
+uint8_t getBatteryLevelFromVoltage(uint32_t batteryVoltageMillivolts);
 float cameraSdGetUsedSpace();
+int8_t telegramSendPhoto(uint8_t *photo, long photoLength, uint16_t photoCounter, String captionNote = "");
+void timelapseCapture();
+void timelapseUpload();
 void telegramCommandProcessor(const char* command);
 
 
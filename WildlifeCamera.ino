@@ -14,7 +14,12 @@
  */
 Pir pir(PIR_ENABLED, PIR_PIN);
 Telegram telegram(TELEGRAM_BOT_API_TOKEN, TELEGRAM_CHAT_ID, &telegramCommandProcessor);
-Camera camera(CAMERA_FRAME_SIZE, CAMERA_QUALITY, CAMERA_SDCARD_ENABLED);
+Camera camera(CAMERA_FRAME_SIZE, CAMERA_QUALITY, CAMERA_SDCARD_ENABLED, CAMERA_WARMSTART_MAX_AGE);
+PhotoServer photoServer(&camera);
+Dedup dedup(DEDUP_THRESHOLD, DEDUP_RESEND_INTERVAL);
+Scheduler scheduler(_DEEP_SLEEP_DURATION, _WAKEUP_DURATION_BY_TIMER, _WAKEUP_DURATION_BY_PIR, (3600 * _LOWBATTERY_NUMBER_OF_BATTERIES));
+EventLog eventLog(EVENTLOG_DIGEST_INTERVAL, EVENTLOG_IMPORTANCE_THRESHOLD);
+Timelapse timelapse(TIMELAPSE_INTERVAL, TIMELAPSE_START_HOUR, TIMELAPSE_END_HOUR, TIMELAPSE_UPLOAD_INTERVAL);
 
 
 /**
@@ -33,11 +38,12 @@ void setup() {
 
   //Start serial
   Serial.begin(115200);
-  Serial.println(F("\n\n\n\n\n"));
-  Serial.println(F("************************************************************************"));
-  Serial.println(F("***               ~  Wildlife Camera - by WizLab.it  ~               ***"));
-  Serial.println(F("************************************************************************"));
-  Serial.println(F("[~~~~~] Setup:"));
+  Logger::begin();
+  LOG_INFO("\n\n\n\n");
+  LOG_INFO("************************************************************************");
+  LOG_INFO("***               ~  Wildlife Camera - by WizLab.it  ~               ***");
+  LOG_INFO("************************************************************************");
+  LOG_INFO("[~~~~~] Setup:");
 
   //Get wake up reason
   __WakeUp.reason = deepSleepWakeUpCheck();
@@ -45,10 +51,25 @@ void setup() {
   //Initialize camera and check if to take a photo (wake up by PIR)
   bool cameraStatus = camera.init();
   if(cameraStatus && (__WakeUp.reason == ESP_SLEEP_WAKEUP_EXT0)) {
-    Serial.print(" [*] Take photo after PIR wake up... ");
-    delay(1500);
-    Serial.println("now");
+    scheduler.recordPirEvent(getHour());
+    eventLog.log(_EVENTLOG_PIR);
+    camera.waitConvergence(); //Wait for auto exposure and white balance to converge (not after a warm start)
+    LOG_INFO(" [*] Take photo after PIR wake up");
     __PIR.photoLength = camera.takePhoto(&__PIR.photo, false);
+    __PIR.photoCounter = camera.sdGetSavedPhotoCounter();
+    if(CAMERA_CLIP_DURATION > 0) camera.recordClip(CAMERA_CLIP_DURATION, CAMERA_CLIP_FRAME_SIZE);
+  }
+
+  //Timelapse capture on timer wake up: if the wake up is only for the capture, go back to sleep without WiFi
+  if(cameraStatus && (__WakeUp.reason == ESP_SLEEP_WAKEUP_TIMER) && timelapse.isCaptureDue()) {
+    timelapseCapture();
+    if(timelapse.isCaptureOnlyWake() && !timelapse.isUploadDue()) {
+      batteryCriticalCheck(); //On critical level, sleeps for long time with PIR disabled
+      timelapse.recordCaptureOnlyWake(millis());
+      unsigned long deepSleepDuration = timelapse.getSleepDuration(scheduler.getDeepSleepDuration(), false);
+      LOG_INFO("[~~~~~] Going to deep sleep for %lu seconds (timelapse capture only)...", deepSleepDuration);
+      deepSleepActivate(deepSleepDuration, true);
+    }
   }
 
   //Configure built-in led
@@ -58,34 +79,35 @@ void setup() {
   //Configure lob-battery input pin
   pinMode(_LOWBATTERY_PIN, INPUT);
 
+  //Additional telegram recipients, and LAN gateway
+  telegram.addChatIds(TELEGRAM_EXTRA_CHAT_IDS);
+  if(strlen(GATEWAY_HOST) > 0) telegram.setGateway(GATEWAY_HOST, GATEWAY_PORT, ((strlen(GATEWAY_DEVICE_ID) > 0) ? String(GATEWAY_DEVICE_ID) : String(ESP.getEfuseMac())));
+
+  //Calculate sleep and wake up durations from battery and activity history
+  scheduler.update(getBatteryLevel(), getHour());
+
   //Connect to Wi-Fi
   wifiConnect(true);
 
   //Check if camera is available
   if(cameraStatus) {
-    Serial.println(" [+] Camera activated");
-    camera.sdOpen(); //Initiallize SD Card
-    camera.sdClose();
+    LOG_INFO(" [+] Camera activated");
   } else {
-    Serial.println(" [-] Camera initialization");
-    Serial.println(F("[~~~~~] Going to deep sleep..."));
+    LOG_ERROR(" [-] Camera initialization");
+    LOG_INFO("[~~~~~] Going to deep sleep...");
     telegram.sendMessage("Camera initialization failed, going to sleep");
     deepSleepActivate(_DEEP_SLEEP_DURATION, true);
   }
 
   //Set wake up duration based on wake up reason
-  switch(__WakeUp.reason) {
-    case ESP_SLEEP_WAKEUP_EXT0: setWakeupEnd(_WAKEUP_DURATION_BY_PIR); break;
-    case ESP_SLEEP_WAKEUP_TIMER: setWakeupEnd(_WAKEUP_DURATION_BY_TIMER); break;
-    default: setWakeupEnd(_WAKEUP_DURATION_DEFAULT); break;
-  }
+  setWakeupEnd(getWakeupDuration());
 
   //Enable PIR
   if(PIR_ENABLED) pir.enable(&pirInterrupt);
 
   //Setup complete
-  Serial.println(F("[~~~~~] Setup complete."));
-  Serial.println(F("[~~~~~] Running:"));
+  LOG_INFO("[~~~~~] Setup complete.");
+  LOG_INFO("[~~~~~] Running:");
 }
 
 
@@ -95,19 +117,40 @@ void setup() {
 void loop() {
   //If no photos are stored and PIR is enabled and motion is detected, then takes a new photo and calculate new wake up duration
   if(PIR_ENABLED && (__PIR.photo == NULL) && __PIR.motionDetected) {
-    Serial.println(" [i] Motion detected, taking photo");
+    LOG_INFO(" [i] Motion detected, taking photo");
+    scheduler.recordPirEvent(getHour());
+    eventLog.log(_EVENTLOG_PIR);
     __PIR.photoLength = camera.takePhoto(&__PIR.photo, false);
-    setWakeupEnd(_WAKEUP_DURATION_BY_PIR);
+    __PIR.photoCounter = camera.sdGetSavedPhotoCounter();
+    if(CAMERA_CLIP_DURATION > 0) camera.recordClip(CAMERA_CLIP_DURATION, CAMERA_CLIP_FRAME_SIZE);
+    setWakeupEnd(scheduler.getWakeupDurationByPir());
     __PIR.motionDetected = false;
   }
 
   //Check WiFi connection
   if(wifiConnect(false)) {
-    //Check if there is a photo to be sent on telegram
+    //Check if there is a photo to be sent on telegram (photos similar to the recent ones are only saved on SD Card)
     if((__PIR.photoLength > 0) && (__PIR.photo != NULL)) {
-      telegram.sendPhoto(__PIR.photo, __PIR.photoLength);
+      if(dedup.isDuplicate(__PIR.photo, __PIR.photoLength)) {
+        eventLog.log(_EVENTLOG_DUPLICATE);
+      } else {
+        String captionNote = (dedup.getSkipped() > 0) ? ("Similar photos not sent: " + String(dedup.getSkipped())) : "";
+        int8_t telegramStatus = telegramSendPhoto(__PIR.photo, __PIR.photoLength, __PIR.photoCounter, captionNote);
+        if(telegramStatus == 0) {
+          dedup.markSent();
+          eventLog.log(_EVENTLOG_UPLOAD_OK);
+        } else {
+          eventLog.log(_EVENTLOG_UPLOAD_FAILED, telegramStatus);
+        }
+      }
     }
 
+    //Upload the timelapse frames, in a single session
+    if(timelapse.isUploadDue()) timelapseUpload();
+
+    //Send activity digest, if due (events are kept if sending fails)
+    if(eventLog.isDigestDue() && (telegram.sendMessage(eventLog.getDigest()) == 0)) eventLog.clear();
+
     //Check Telegram updates every 5 seconds
     if(__Timers.telegramGetUpdates < millis()) {
       __Timers.telegramGetUpdates = millis() + 5000;
@@ -116,10 +159,16 @@ void loop() {
       int8_t telegramUpdatesCount = telegram.getUpdates();
 
       //If there are updates, then recalculate wake up duration
-      if(telegramUpdatesCount > 0) setWakeupEnd(_WAKEUP_INCREASE_BY_TELEGRAM);
+      if(telegramUpdatesCount > 0) {
+        __WakeUp.commandsReceived = true;
+        setWakeupEnd(_WAKEUP_INCREASE_BY_TELEGRAM);
+      }
     }
   }
 
+  //Serve photo server requests
+  photoServer.handleClient();
+
   //Battery level check
   batteryCheck();
 
@@ -127,15 +176,18 @@ void loop() {
   free(__PIR.photo);
   __PIR.photo = NULL;
   __PIR.photoLength = 0;
+  __PIR.photoCounter = 0;
 
   //Check if go to deep sleep
   if(millis() > __WakeUp.end) {
-    Serial.println(F("[~~~~~] Going to deep sleep..."));
-    deepSleepActivate(_DEEP_SLEEP_DURATION, true);
+    if(__WakeUp.reason == ESP_SLEEP_WAKEUP_TIMER) scheduler.recordTimerWake(__WakeUp.commandsReceived);
+    unsigned long deepSleepDuration = timelapse.getSleepDuration(scheduler.getDeepSleepDuration(), true); //Shorter if a timelapse capture comes first
+    LOG_INFO("[~~~~~] Going to deep sleep for %lu seconds...", deepSleepDuration);
+    deepSleepActivate(deepSleepDuration, true);
   }
 
-  //Loop end
-  delay(500);
+  //Loop end (shorter delay when photo server is active, to serve requests quickly)
+  delay(photoServer.isActive() ? 10 : 500);
 }
 
 
@@ -166,6 +218,9 @@ bool wifiConnect(bool blocking) {
       }
     }
 
+    //Save UTC offset, for the local hour after deep sleeps
+    timezoneSave();
+
     return true;
   }
 
@@ -181,27 +236,26 @@ bool wifiConnect(bool blocking) {
 
   //Try to connect
   if(blocking) {
-    Serial.printf(" [*] WiFi: connecting to %s: ", WIFI_SSID);
+    LOG_INFO(" [*] WiFi: connecting to %s", WIFI_SSID);
     uint8_t i = 0;
     while(WiFi.status() != WL_CONNECTED) {
-      Serial.print(".");
       if(i++ > _WIFI_CONNECTION_TIMEOUT) break;
       delay(1000);
     }
-    if(WiFi.status() == WL_CONNECTED) {
-      Serial.println(" OK");
-    } else {
-      Serial.println(" failed");
+    if(WiFi.status() != WL_CONNECTED) {
+      LOG_ERROR(" [-] WiFi: connection to %s failed", WIFI_SSID);
+      eventLog.log(_EVENTLOG_WIFI_FAILURE);
       WiFi.disconnect(true);
     }
   } else {
     if(wifiConnectionJustInitiated) {
       __Timers.wifiConnectionTimeout = millis() + (_WIFI_CONNECTION_TIMEOUT * 1000);
-      Serial.printf(" [*] WiFi: try to connect to %s (non-blocking)\n", WIFI_SSID);
+      LOG_INFO(" [*] WiFi: try to connect to %s (non-blocking)", WIFI_SSID);
     } else {
       if((WiFi.status() == WL_DISCONNECTED)) { //Connecting
         if(__Timers.wifiConnectionTimeout < millis()) {
-          Serial.printf(" [-] WiFi: connection to %s failed\n", WIFI_SSID);
+          LOG_ERROR(" [-] WiFi: connection to %s failed", WIFI_SSID);
+          eventLog.log(_EVENTLOG_WIFI_FAILURE);
           WiFi.disconnect(true);
         }
       }
@@ -210,10 +264,11 @@ bool wifiConnect(bool blocking) {
 
   //Check connection status
   if(WiFi.status() == WL_CONNECTED) {
-    Serial.printf(" [+] WiFi: connected to %s (%s)\n", WIFI_SSID, WiFi.localIP().toString().c_str());
+    LOG_INFO(" [+] WiFi: connected to %s (%s)", WIFI_SSID, WiFi.localIP().toString().c_str());
 
     //Set local time via NTP
     configTime((NTP_TIMEZONE * 3600), 3600, NTP_SERVER);
+    timezoneSave();
 
     return true;
   }
@@ -239,6 +294,17 @@ unsigned long setWakeupEnd(unsigned long increase) {
 }
 
 
+/**
+ * getWakeupRemaining
+ * Get remaining wake up time
+ * @return    Milliseconds before going to deep sleep
+ */
+unsigned long getWakeupRemaining() {
+  unsigned long now = millis();
+  return (__WakeUp.end > now) ? (__WakeUp.end - now) : 0;
+}
+
+
 /**
  * getTimestamp
  * Get current timestamp
@@ -291,6 +357,52 @@ String getDateFormat(String format, time_t timestamp) {
 }
 
 
+/**
+ * getHour
+ * Get hour of day in local time, using the UTC offset saved in RTC memory: it's the same before and after WiFi is
+ * connected (the timezone is set only when NTP is configured, until then localtime() is UTC)
+ * @param timestamp   (optional) If set, use this timestamp, otherwise use current timestamp
+ * @return            Hour (0-23), -1 if date and time are unknown
+ */
+int8_t getHour(unsigned long timestamp) {
+  if(timestamp == 0) timestamp = getTimestamp();
+  if(timestamp < 1000000000) return -1;
+  return ((timestamp + __System.utcOffset) / 3600) % 24;
+}
+
+
+/**
+ * timezoneSave
+ * Save the UTC offset of the local time (timezone and DST) in RTC memory, to be used by getHour()
+ * To be called when the timezone is set (after NTP is configured)
+ */
+void timezoneSave() {
+  time_t now;
+  time(&now);
+  if(now < 1000000000) return;
+
+  struct tm local, utc;
+  localtime_r(&now, &local);
+  gmtime_r(&now, &utc);
+  int days = (local.tm_year != utc.tm_year) ? (local.tm_year - utc.tm_year) : (local.tm_yday - utc.tm_yday);
+  __System.utcOffset = (days * 86400L) + ((local.tm_hour - utc.tm_hour) * 3600L) + ((local.tm_min - utc.tm_min) * 60L);
+}
+
+
+/**
+ * getWakeupDuration
+ * Get wake up duration for the current wake up reason, as calculated by the scheduler
+ * @return    Wake up duration in seconds
+ */
+unsigned long getWakeupDuration() {
+  switch(__WakeUp.reason) {
+    case ESP_SLEEP_WAKEUP_EXT0: return scheduler.getWakeupDurationByPir();
+    case ESP_SLEEP_WAKEUP_TIMER: return scheduler.getWakeupDurationByTimer();
+    default: return _WAKEUP_DURATION_DEFAULT;
+  }
+}
+
+
 /**
  * getUptime
  * Get uptime
@@ -313,20 +425,18 @@ void batteryCheck() {
   //Battery level check (also update __System battery level variables)
   uint8_t batteryLevel = getBatteryLevel();
 
+  //Battery level decrease is notified with the activity digest
   if(batteryLevel < __System.batteryLastNotificationLevel) {
-    Serial.println(" [*] Battery level: " + String(batteryLevel) + "/5");
-    int8_t telegramStatus = telegram.sendMessage("Wildlife Camera battery status\n"
-      " [+] Battery level: " + String(batteryLevel) + "/5 (" + String(_LOWBATTERY_NUMBER_OF_BATTERIES) + " batteries)\n"
-      " [+] PIN voltage: " + String(__System.batteryVoltageMillivoltsOnAnalogPin / 1000.0) + "V\n"
-      " [+] Pack voltage: " + String(__System.batteryVoltageMillivoltsEffective / 1000.0) + "V\n"
-      " [+] Single voltage: " + String(__System.batteryVoltageMillivoltsEffective / (1000.0 * _LOWBATTERY_NUMBER_OF_BATTERIES)) + "V\n");
-    if(telegramStatus == 0) __System.batteryLastNotificationLevel = batteryLevel;
+    LOG_INFO(" [*] Battery level: %d/5", batteryLevel);
+    eventLog.log(_EVENTLOG_BATTERY_LEVEL, batteryLevel);
+    __System.batteryLastNotificationLevel = batteryLevel;
   }
 
-  //If battery is critically low, disable PIR and go to sleep for long time
+  //If battery is critically low, disable PIR and go to sleep for long time (without WiFi, i.e. on timelapse capture
+  //only wake ups, the level is reported by the activity digest)
   if(batteryLevel == 0) {
-    Serial.println(" [~~~~~] Battery level critically low!\nSleeping for " + String(_LOWBATTERY_CRITICAL_DEEP_SLEEP) + " hours.");
-    telegram.sendMessage("Wildlife Camera battery level critically low!\n"
+    LOG_ERROR("[~~~~~] Battery level critically low! Sleeping for %d hours.", _LOWBATTERY_CRITICAL_DEEP_SLEEP);
+    if(WiFi.status() == WL_CONNECTED) telegram.sendMessage("Wildlife Camera battery level critically low!\n"
       " [+] Battery level: " + String(batteryLevel) + "/5 (" + String(_LOWBATTERY_NUMBER_OF_BATTERIES) + " batteries)\n"
       " [+] PIN voltage: " + String(__System.batteryVoltageMillivoltsOnAnalogPin / 1000.0) + "V\n"
       " [+] Pack voltage: " + String(__System.batteryVoltageMillivoltsEffective / 1000.0) + "V\n"
@@ -337,6 +447,21 @@ void batteryCheck() {
 }
 
 
+/**
+ * batteryCriticalCheck
+ * Battery check on timelapse capture only wake ups: WiFi is never started, so a single ADC read without delays is enough.
+ * The read is not cached nor recorded (the full check is done on the upload wake up); if the battery is critically low,
+ * go to sleep for long time with PIR disabled
+ */
+void batteryCriticalCheck() {
+  uint32_t batteryVoltageMillivolts = analogReadMilliVolts(_LOWBATTERY_PIN) * _LOWBATTERY_VDIV_RATIO;
+  if(getBatteryLevelFromVoltage(batteryVoltageMillivolts) == 0) {
+    LOG_ERROR("[~~~~~] Battery level critically low (%0.2fV)! Sleeping for %d hours.", (batteryVoltageMillivolts / 1000.0), _LOWBATTERY_CRITICAL_DEEP_SLEEP);
+    deepSleepActivate(_LOWBATTERY_CRITICAL_DEEP_SLEEP * 60 * 60, false);
+  }
+}
+
+
 /**
  * getBatteryVoltage
  * Get the battery voltage
@@ -344,23 +469,26 @@ void batteryCheck() {
  * @return          Battery voltage (raw ADC or millivolts)
  */
 uint32_t getBatteryVoltage(bool getRaw) {
-  //Check if battery ADC needs to be updated
-  if(__System.batteryVoltageCacheExpire < getTimestamp()) {
+  //Check if battery ADC needs to be updated (not while photo server is active: WiFi is turned off when sampling)
+  if((__System.batteryVoltageCacheExpire < getTimestamp()) && !photoServer.isActive()) {
     __System.batteryVoltageCacheExpire = getTimestamp() + _LOWBATTERY_CACHE_TIMEOUT;
 
-    //New battery ADC sample (disable WiFi when sampling)
+    //New battery ADC sample (disable WiFi when sampling, then reconnect only if it was connected)
+    bool wifiConnected = (WiFi.status() == WL_CONNECTED);
     WiFi.disconnect(true);
     delay(1000);
     __System.batteryVoltageRaw = analogRead(_LOWBATTERY_PIN);
     delay(500);
     __System.batteryVoltageMillivoltsOnAnalogPin = analogReadMilliVolts(_LOWBATTERY_PIN);
     __System.batteryVoltageMillivoltsEffective = __System.batteryVoltageMillivoltsOnAnalogPin * _LOWBATTERY_VDIV_RATIO;  //Calculate effective battery voltage after voltage divider
-    Serial.printf(" [i] Single battery voltage: %0.2fV (original: %0.2fV; raw: %d) (next sample on %s)\n", (__System.batteryVoltageMillivoltsEffective / (1000.0 * _LOWBATTERY_NUMBER_OF_BATTERIES)), (__System.batteryVoltageMillivoltsOnAnalogPin / (1000.0 * _LOWBATTERY_NUMBER_OF_BATTERIES)), (__System.batteryVoltageRaw / _LOWBATTERY_NUMBER_OF_BATTERIES), getDateFormat("%F, %T", __System.batteryVoltageCacheExpire).c_str());
-    Serial.printf(" [i] %d-pack battery voltage: %0.2fV (original: %0.2fV; raw: %d) (next sample on %s)\n", _LOWBATTERY_NUMBER_OF_BATTERIES, (__System.batteryVoltageMillivoltsEffective / 1000.0), (__System.batteryVoltageMillivoltsOnAnalogPin / 1000.0), __System.batteryVoltageRaw, getDateFormat("%F, %T", __System.batteryVoltageCacheExpire).c_str());
-    wifiConnect(true);
-
-    //Set new wakeup duration
-    setWakeupEnd(_WAKEUP_DURATION_DEFAULT);
+    LOG_DEBUG(" [i] Single battery voltage: %0.2fV (original: %0.2fV; raw: %d) (next sample on %s)", (__System.batteryVoltageMillivoltsEffective / (1000.0 * _LOWBATTERY_NUMBER_OF_BATTERIES)), (__System.batteryVoltageMillivoltsOnAnalogPin / (1000.0 * _LOWBATTERY_NUMBER_OF_BATTERIES)), (__System.batteryVoltageRaw / _LOWBATTERY_NUMBER_OF_BATTERIES), getDateFormat("%F, %T", __System.batteryVoltageCacheExpire).c_str());
+    scheduler.recordBatterySample(__System.batteryVoltageMillivoltsEffective, getTimestamp());
+    eventLog.log(_EVENTLOG_BATTERY, __System.batteryVoltageMillivoltsEffective);
+    LOG_INFO(" [i] %d-pack battery voltage: %0.2fV (original: %0.2fV; raw: %d) (next sample on %s)", _LOWBATTERY_NUMBER_OF_BATTERIES, (__System.batteryVoltageMillivoltsEffective / 1000.0), (__System.batteryVoltageMillivoltsOnAnalogPin / 1000.0), __System.batteryVoltageRaw, getDateFormat("%F, %T", __System.batteryVoltageCacheExpire).c_str());
+    if(wifiConnected) wifiConnect(true);
+
+    //Set new wakeup duration (sampling took part of it)
+    setWakeupEnd(getWakeupDuration());
   }
 
   return (getRaw) ? __System.batteryVoltageRaw : __System.batteryVoltageMillivoltsEffective;
@@ -373,8 +501,17 @@ uint32_t getBatteryVoltage(bool getRaw) {
  * @return      Battery level (0-5)
  */
 uint8_t getBatteryLevel() {
-  uint32_t batteryVoltageMillivolts = getBatteryVoltage(false);
+  return getBatteryLevelFromVoltage(getBatteryVoltage(false));
+}
+
 
+/**
+ * getBatteryLevelFromVoltage
+ * Get battery level (0 to 5) of a battery pack voltage
+ * @param batteryVoltageMillivolts    Battery pack voltage, in millivolts
+ * @return                            Battery level (0-5)
+ */
+uint8_t getBatteryLevelFromVoltage(uint32_t batteryVoltageMillivolts) {
   //If battery voltage is <6000 mV, then it's connected to USB
   if(batteryVoltageMillivolts < (3000 * _LOWBATTERY_NUMBER_OF_BATTERIES)) return 5;
 
@@ -395,6 +532,10 @@ uint8_t getBatteryLevel() {
  * @param enableWakeupByPir   if true, wake up by PIR is enabled; if false PIR won't wake up the device
  */
 void deepSleepActivate(uint16_t seconds, bool enableWakeupByPir) {
+  //Save converged camera sensor state and pending Photo DB changes
+  camera.sensorSaveState();
+  camera.sdSync();
+
   //Hold flash when sleeping
   camera.flashGpioHold(true);
 
@@ -402,9 +543,10 @@ void deepSleepActivate(uint16_t seconds, bool enableWakeupByPir) {
   pir.prepareDeepSleep(enableWakeupByPir);
 
   //Timer wake up
-  esp_sleep_enable_timer_wakeup(seconds * 1000 * 1000);
+  esp_sleep_enable_timer_wakeup((uint64_t)seconds * 1000 * 1000);
 
-  //Go to deep sleep
+  //Write buffered logs, then go to deep sleep
+  Logger::flush();
   gpio_deep_sleep_hold_en();
   esp_deep_sleep_start();
 }
@@ -424,10 +566,12 @@ esp_sleep_wakeup_cause_t deepSleepWakeUpCheck() {
   esp_sleep_wakeup_cause_t wakeup_reason = esp_sleep_get_wakeup_cause();
   switch(wakeup_reason) {
     case ESP_SLEEP_WAKEUP_EXT0: //Wake up from PIR
-      Serial.println(" [*] Wake up by PIR (EXT0)");
+      LOG_INFO(" [*] Wake up by PIR (EXT0)");
       break;
     case ESP_SLEEP_WAKEUP_TIMER: //Wake up from TIMER
-      Serial.println(" [*] Wake up by TIMER");
+      LOG_INFO(" [*] Wake up by TIMER");
+      break;
+    default: //Power on or reset
       break;
   }
 
@@ -445,6 +589,69 @@ float cameraSdGetUsedSpace() {
 }
 
 
+/**
+ * telegramSendPhoto
+ * Send a photo on telegram and save the returned file_id in Photo DB
+ * @param photo         pointer to the photo data
+ * @param photoLength   length of the photo data
+ * @param photoCounter  Photo DB counter of the photo (camera.sdGetSavedPhotoCounter after takePhoto; 0 if not saved on SD Card)
+ * @param captionNote   (optional) additional line appended to the caption
+ * @return              0 if successful, negative value if error
+ */
+int8_t telegramSendPhoto(uint8_t *photo, long photoLength, uint16_t photoCounter, String captionNote) {
+  char fileId[_TELEGRAM_FILEID_MAX_LENGTH];
+  int8_t telegramStatus = telegram.sendPhoto(photo, photoLength, fileId, captionNote);
+  if(telegramStatus == 0) camera.sdSetLastPhotoFileId(fileId, photoCounter);
+  return telegramStatus;
+}
+
+
+/**
+ * timelapseCapture
+ * Capture a timelapse frame and save it on SD Card, to be uploaded later
+ */
+void timelapseCapture() {
+  camera.waitConvergence(); //Wait for auto exposure and white balance to converge (not after a warm start)
+  uint16_t photoCounter = camera.sdGetPhotoCounter();
+  uint8_t *photo = NULL;
+  long photoLength = camera.takePhoto(&photo, false);
+  free(photo);
+  photo = NULL;
+
+  if((photoLength > 0) && (camera.sdGetPhotoCounter() != photoCounter)) {
+    timelapse.recordFrame((camera.sdGetLastPhotoFilename() + strlen(_CAMERA_SD_BASE_PATH)), camera.sdGetLastPhotoTimestamp());
+    LOG_INFO(" [+] Timelapse frame captured (%d waiting for upload)", timelapse.getPendingFrames());
+  } else {
+    LOG_ERROR(" [-] Timelapse frame not saved on SD Card");
+  }
+}
+
+
+/**
+ * timelapseUpload
+ * Upload the timelapse frames waiting on SD Card, from the oldest
+ */
+void timelapseUpload() {
+  uint8_t frames = 0;
+  uint8_t total = timelapse.getPendingFrames();
+  LOG_INFO(" [*] Timelapse: uploading %d frames", total);
+  while(timelapse.getPendingFrames() > 0) {
+    setWakeupEnd(_WAKEUP_INCREASE_BY_TELEGRAM);
+    String pathfilename = String(_CAMERA_SD_BASE_PATH) + timelapse.getPendingFrame();
+    uint8_t *photo = NULL;
+    long photoLength = camera.sdReadPhoto(pathfilename.c_str(), &photo);
+    int8_t telegramStatus = (photoLength == -1) ? -1 : 0; //SD Card not available: retry later; photo not found: skip it
+    if(photoLength > 0) telegramStatus = telegram.sendPhoto(photo, photoLength, NULL, "Timelapse frame " + String(frames + 1) + "/" + String(total) + " taken on " + getDateFormat("%F, %T", timelapse.getPendingFrameTimestamp()));
+    free(photo);
+    photo = NULL;
+    if(telegramStatus != 0) break;
+    timelapse.removePendingFrame();
+    if(photoLength > 0) frames++;
+  }
+  timelapse.recordUpload(frames, millis());
+}
+
+
 /**
  * telegramCommandProcessor
  * External function that processes the received telegram commands
@@ -453,7 +660,11 @@ float cameraSdGetUsedSpace() {
  * wakeup - Wake up from deep sleep
  * photo - Take a photo
  * photoflash - Take a photo with flash
+ * get - Send the last photo again
+ * server - Start the photo server on the LAN
  * status - Device status
+ * log - Last log records
+ * timelapse - Timelapse schedule (i.e. /timelapse 15 7 19: every 15 minutes from 7 to 19; /timelapse off)
  * blink - Blink flash (identify device)
  * ----------------------------------------
  * @param command     command string (i.e. /status)
@@ -471,7 +682,7 @@ void telegramCommandProcessor(const char* command) {
   else if(strcmp("/photo", command) == 0) {
     uint8_t *photo = NULL;
     long photoLength = camera.takePhoto(&photo, false);
-    if(photoLength > 0) telegram.sendPhoto(photo, photoLength);
+    if(photoLength > 0) telegramSendPhoto(photo, photoLength, camera.sdGetSavedPhotoCounter());
     free(photo);
     photo = NULL;
   }
@@ -481,11 +692,41 @@ void telegramCommandProcessor(const char* command) {
   else if(strcmp("/photoflash", command) == 0) {
     uint8_t *photo = NULL;
     long photoLength = camera.takePhoto(&photo, true);
-    if(photoLength > 0) telegram.sendPhoto(photo, photoLength);
+    if(photoLength > 0) telegramSendPhoto(photo, photoLength, camera.sdGetSavedPhotoCounter());
     free(photo);
     photo = NULL;
   }
 
+  //Command: /get
+  //Send the last photo again, only to the chat that sent the command: by telegram file_id if already uploaded, otherwise reading it from SD Card
+  else if(strcmp("/get", command) == 0) {
+    bool sdStatus = camera.sdOpen(); //Load Photo DB
+    camera.sdClose();
+    int64_t chatId = telegram.getCommandChatId();
+    unsigned long photoTimestamp = camera.sdGetLastPhotoTimestamp();
+    if(!sdStatus || (camera.sdGetPhotoCounter() == 0)) {
+      telegram.sendMessage("No photos available");
+    } else if(telegram.sendPhotoByFileId(camera.sdGetLastPhotoFileId(), chatId, photoTimestamp) != 0) {
+      char fileId[_TELEGRAM_FILEID_MAX_LENGTH];
+      uint8_t *photo = NULL;
+      long photoLength = camera.sdReadLastPhoto(&photo);
+      if((photoLength > 0) && (telegram.sendPhotoToChat(photo, photoLength, chatId, photoTimestamp, fileId) == 0)) camera.sdSetLastPhotoFileId(fileId, camera.sdGetPhotoCounter());
+      free(photo);
+      photo = NULL;
+    }
+  }
+
+  //Command: /server
+  //Start the photo server on the LAN for a limited time (plain HTTP without authentication: only from the authorized chats)
+  else if(strcmp("/server", command) == 0) {
+    if(photoServer.start(PHOTOSERVER_DURATION)) {
+      setWakeupEnd(PHOTOSERVER_DURATION);
+      telegram.sendMessage("Photo server available for " + String(PHOTOSERVER_DURATION / 60) + " minutes at http://" + WiFi.localIP().toString() + "/");
+    } else {
+      telegram.sendMessage("Photo server not available (SD Card or WiFi not ready)");
+    }
+  }
+
   //Command: /status
   //Send device status
   else if(strcmp("/status", command) == 0) {
@@ -506,7 +747,8 @@ void telegramCommandProcessor(const char* command) {
     statusMessage += "\nDevice:\n"
       " [" + String((datetime == "") ? "-" : "+") + "] Date and time: " + ((datetime == "") ? "unknown" : datetime) + "\n"
       " [+] Uptime: " + String(uptimeHours) + " hours, " + String(uptimeMinutes) + " minutes, " + String(uptimeSeconds) + " seconds\n"
-      " [+] Device ID: " + String(ESP.getEfuseMac()) + "\n";
+      " [+] Device ID: " + String(ESP.getEfuseMac()) + "\n"
+      " [+] Camera warm starts: " + String(camera.sensorGetWarmStarts()) + " of " + String(camera.sensorGetWarmStarts() + camera.sensorGetColdStarts()) + "\n";
 
     //WiFi status
     statusMessage += "\nWiFi:\n"
@@ -514,6 +756,14 @@ void telegramCommandProcessor(const char* command) {
       " [+] RSSI: " + String(WiFi.RSSI()) + "\n"
       " [+] IP Address: " + String(WiFi.localIP().toString()) + "\n";
 
+    //Telegram status
+    statusMessage += "\nTelegram:\n"
+      " [+] Connection: " + String(telegram.isGateway() ? ("via gateway " GATEWAY_HOST) : "direct") + "\n"
+      " [+] Requests: " + String(telegram.getStatsRequests()) + "\n"
+      " [+] Retries: " + String(telegram.getStatsRetries()) + "\n"
+      " [+] Failures: " + String(telegram.getStatsFailures()) + "\n"
+      " [+] Events waiting for the digest: " + String(eventLog.getPendingEvents()) + "\n";
+
     //Battery status
     statusMessage += "\nBattery:\n"
       " [+] Level: " + String(getBatteryLevel()) + "/5\n"
@@ -522,12 +772,29 @@ void telegramCommandProcessor(const char* command) {
       " [+] Pack voltage: " + String(__System.batteryVoltageMillivoltsEffective / 1000.0) + "V\n"
       " [+] Single voltage: " + String(__System.batteryVoltageMillivoltsEffective / (1000.0 * _LOWBATTERY_NUMBER_OF_BATTERIES)) + "V\n";
 
+    //Scheduler status
+    long lifetime = scheduler.getProjectedLifetime();
+    statusMessage += "\nScheduler:\n"
+      " [+] Policy: " + scheduler.getPolicy() + "\n"
+      " [+] Deep sleep: " + String(scheduler.getDeepSleepDuration()) + " seconds\n"
+      " [+] Wake up by timer: " + String(scheduler.getWakeupDurationByTimer()) + " seconds\n"
+      " [+] Wake up by PIR: " + String(scheduler.getWakeupDurationByPir()) + " seconds\n"
+      " [+] Battery trend: " + String(scheduler.getBatteryTrend(), 1) + " mV/hour\n"
+      " [" + String((lifetime < 0) ? "-" : "+") + "] Projected lifetime: " + ((lifetime < 0) ? "unknown" : String(lifetime) + " hours") + "\n";
+
+    //Timelapse status
+    statusMessage += "\nTimelapse:\n"
+      " [+] Schedule: " + timelapse.getSchedule() + "\n" + timelapse.getStats();
+
     //SD Card status
     statusMessage += "\nSD Card:\n";
     if(camera.sdOpen()) {
       statusMessage += " [+] Used space: " + String(camera.sdGetUsedSpace()) + "%\n"
         " [+] Number of photos: " + String(camera.sdGetPhotoCounter()) + "\n"
         " [+] Last photo date: " + ((camera.sdGetLastPhotoTimestamp() == 0) ? "-" : getDateFormat("%F, %T", camera.sdGetLastPhotoTimestamp())) + "\n";
+      if(camera.clipGetLastFps() > 0) {
+        statusMessage += " [+] Last clip: " + String(camera.clipGetLastFps()) + " fps, " + String(camera.clipGetLastBandwidth()) + " KB/s\n";
+      }
     } else {
       statusMessage += " [-] not available\n";
     }
@@ -537,6 +804,31 @@ void telegramCommandProcessor(const char* command) {
     telegram.sendMessage(statusMessage);
   }
 
+  //Command: /timelapse [off | <minutes> [<start hour> <end hour>]]
+  //Set the timelapse schedule, then send it with the frames statistics
+  else if((strncmp("/timelapse", command, 10) == 0) && ((command[10] == '\0') || (command[10] == ' '))) {
+    unsigned int interval = 0, startHour = TIMELAPSE_START_HOUR, endHour = TIMELAPSE_END_HOUR;
+    String reply = "";
+    if(strcmp("/timelapse off", command) == 0) {
+      timelapse.configure(0, TIMELAPSE_START_HOUR, TIMELAPSE_END_HOUR);
+    } else if(command[10] != '\0') {
+      //Values are range checked before being narrowed, and nothing may follow them
+      int length = 0;
+      int values = sscanf(command, "/timelapse %u%n %u %u%n", &interval, &length, &startHour, &endHour, &length);
+      bool parsed = ((values == 1) || (values == 3)) && (command[length] == '\0') && (interval <= 1440) && (startHour <= 23) && (endHour <= 24);
+      if(!parsed || !timelapse.configure(interval, startHour, endHour)) reply = "Invalid schedule, use /timelapse off or /timelapse {MINUTES} [{START_HOUR} {END_HOUR}]\n";
+    }
+    reply += "Timelapse: " + timelapse.getSchedule() + "\n" + timelapse.getStats();
+    telegram.sendMessage(reply);
+  }
+
+  //Command: /log
+  //Send the last log records (kept across deep sleeps and resets)
+  else if(strcmp("/log", command) == 0) {
+    String records = Logger::getPersisted();
+    telegram.sendMessage((records == "") ? "No log records available" : "Wildlife Camera last log records\n" + records);
+  }
+
   //Command: /blink
   //Blink the flash 5 times
   else if(strcmp("/blink", command) == 0) {
@@ -548,6 +840,6 @@ void telegramCommandProcessor(const char* command) {
 
   //Unknown command
   else {
-    Serial.println(" [-] Unknown command");
+    LOG_WARNING(" [-] Unknown command");
   }
 }
\ No newline at end of file
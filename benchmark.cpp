@@ -0,0 +1,71 @@
+/**
+ * @package Wildlife Camera
+ * Data-path measurements
+ * @author WizLab.it
+ * @board AI-Thinker ESP32-CAM
+ * @version 20261018.001
+ */
+
+#include "benchmark.h"
+#include "logger.h"
+#include <esp_heap_caps.h>
+
+#if _BENCHMARK_ACTIVE
+
+
+/**
+ * Benchmark
+ * Class constructor, starts the measurement
+ * @param operation   Name of the measured operation
+ */
+Benchmark::Benchmark(const char* operation) {
+  _operation = operation;
+  _heapStart = ESP.getFreeHeap();
+  _psramStart = ESP.getFreePsram();
+
+  //Track the minimum free heap from now on (fails if a measurement is already running, then its minimum is used)
+#if _BENCHMARK_HEAP_MONITOR
+  _heapMonitor = (heap_caps_monitor_local_minimum_free_size_start() == ESP_OK);
+#else
+  _heapMinStart = ESP.getMinFreeHeap();
+  _psramMinStart = ESP.getMinFreePsram();
+#endif
+#ifdef HOST_BUILD
+  _allocationsStart = hostHeapGetAllocations();
+#endif
+  _start = micros();
+}
+
+
+/**
+ * Benchmark::end
+ * Stop the measurement and print the result
+ * *_delta is the memory still allocated by the operation, *_peak is the largest amount allocated while it was running
+ * @param bytes   (optional) Number of bytes processed by the operation, used to calculate the throughput
+ */
+void Benchmark::end(long bytes) {
+  unsigned long duration = micros() - _start;
+  uint32_t heapEnd = ESP.getFreeHeap();
+  uint32_t heapMin = ESP.getMinFreeHeap();
+  uint32_t psramEnd = ESP.getFreePsram();
+  uint32_t psramMin = ESP.getMinFreePsram();
+#if _BENCHMARK_HEAP_MONITOR
+  if(_heapMonitor) heap_caps_monitor_local_minimum_free_size_stop();
+#else
+  if(heapMin >= _heapMinStart) heapMin = min(heapEnd, _heapStart);
+  if(psramMin >= _psramMinStart) psramMin = min(psramEnd, _psramStart);
+#endif
+  int32_t heapPeak = (heapMin < _heapStart) ? (_heapStart - heapMin) : 0;
+  int32_t psramPeak = (psramMin < _psramStart) ? (_psramStart - psramMin) : 0;
+  float kbps = (duration > 0) ? (bytes * 1000000.0 / 1024.0 / duration) : 0;
+#ifdef HOST_BUILD
+  Logger::write("{\"bench\":\"%s\",\"bytes\":%ld,\"us\":%lu,\"kbps\":%0.1f,\"heap_free\":%u,\"heap_delta\":%d,\"heap_peak\":%d,\"psram_free\":%u,\"psram_delta\":%d,\"psram_peak\":%d,\"allocs\":%llu}", _operation, bytes, duration, kbps,
+    (unsigned)heapEnd, (int)(_heapStart - heapEnd), (int)heapPeak, (unsigned)psramEnd, (int)(_psramStart - psramEnd), (int)psramPeak, (unsigned long long)(hostHeapGetAllocations() - _allocationsStart));
+#else
+  Logger::write("{\"bench\":\"%s\",\"bytes\":%ld,\"us\":%lu,\"kbps\":%0.1f,\"heap_free\":%u,\"heap_delta\":%d,\"heap_peak\":%d,\"psram_free\":%u,\"psram_delta\":%d,\"psram_peak\":%d}", _operation, bytes, duration, kbps,
+    (unsigned)heapEnd, (int)(_heapStart - heapEnd), (int)heapPeak, (unsigned)psramEnd, (int)(_psramStart - psramEnd), (int)psramPeak);
+#endif
+}
+
+
+#endif
@@ -0,0 +1,76 @@
+/**
+ * @package Wildlife Camera
+ * Data-path measurements header
+ * @author WizLab.it
+ * @board AI-Thinker ESP32-CAM
+ * @version 20261018.001
+ */
+
+#ifndef BENCHMARK_H
+#define BENCHMARK_H
+
+
+/**
+ * Includes
+ */
+#include <Arduino.h>
+#include <esp_idf_version.h>
+#include "config.h"
+
+
+/**
+ * Defines
+ */
+//Measurements are compiled only if BENCHMARK_ENABLED is set to true in config.h
+#if defined(BENCHMARK_ENABLED) && BENCHMARK_ENABLED
+  #define _BENCHMARK_ACTIVE 1
+#else
+  #define _BENCHMARK_ACTIVE 0
+#endif
+
+//Minimum free heap of the operation only with ESP-IDF 5.1 or later (Arduino core 3); before, the minimum since boot is
+//used if the operation lowered it, otherwise the peak is sampled when the operation ends
+#if ESP_IDF_VERSION >= ESP_IDF_VERSION_VAL(5, 1, 0)
+  #define _BENCHMARK_HEAP_MONITOR 1
+#else
+  #define _BENCHMARK_HEAP_MONITOR 0
+#endif
+
+
+/**
+ * Class definition
+ * Measures one operation, from construction to end(), and prints the result on serial as a JSON line:
+ * {"bench":"<operation>","bytes":<n>,"us":<n>,"kbps":<n>,"heap_free":<n>,"heap_delta":<n>,"heap_peak":<n>,"psram_free":<n>,"psram_delta":<n>,"psram_peak":<n>}
+ * heap_* are the internal heap, psram_* the PSRAM (large buffers, i.e. photo payloads, are allocated there)
+ * Host builds add "allocs", the number of allocations done by the operation
+ */
+class Benchmark {
+  private:
+#if _BENCHMARK_ACTIVE
+    const char* _operation;
+    unsigned long _start;
+    uint32_t _heapStart;
+    uint32_t _psramStart;
+#if _BENCHMARK_HEAP_MONITOR
+    bool _heapMonitor;
+#else
+    uint32_t _heapMinStart;
+    uint32_t _psramMinStart;
+#endif
+#ifdef HOST_BUILD
+    uint64_t _allocationsStart;
+#endif
+#endif
+
+  public:
+#if _BENCHMARK_ACTIVE
+    Benchmark(const char* operation);
+    void end(long bytes = 0);
+#else
+    Benchmark(const char* operation) {}
+    void end(long bytes = 0) {}
+#endif
+};
+
+
+#endif
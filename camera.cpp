@@ -9,18 +9,61 @@
 #include "camera.h"
 
 
+/**
+ * Variables
+ * Photo DB, with its copy on SD Card, and converged sensor state (kept across deep sleeps)
+ */
+struct _PhotoDB {
+  uint16_t photoCounter = 0;
+  char lastPhotoFilename[_CAMERA_PHOTODB_FILENAME_MAX_LENGTH];
+  unsigned long lastPhotoTimestamp = 0;
+  char lastPhotoFileId[_CAMERA_PHOTODB_FILEID_MAX_LENGTH];  //Telegram file_id of the last photo (empty if not uploaded)
+};
+
+struct _PhotoDBPackage {
+  _PhotoDB photoDB;
+  uint32_t crc;
+};
+
+RTC_DATA_ATTR struct {
+  uint8_t version = 0;              //_CAMERA_PHOTODB_VERSION when the cache is valid (0 after power on)
+  bool dirty = false;               //Photo DB changed since the last save on SD Card
+  float usedSpace = -1.0;           //SD Card usage percentage, updated when files are written (negative if unknown)
+  struct _PhotoDBPackage photoDBPack;
+} __cameraPhotoDbCache;
+
+
+RTC_DATA_ATTR struct {
+  bool valid = false;
+  unsigned long timestamp = 0;
+  uint8_t gain = 0;
+  uint8_t reg04 = 0;
+  uint8_t aec = 0;
+  uint8_t reg45 = 0;
+  uint32_t warmStarts = 0;
+  uint32_t coldStarts = 0;
+} __cameraSensorState;
+
+
 /**
  * Camera
  * Class constructor
  * @param frameSize       Size of the photo (see framesize_t)
  * @param jpegQuality     JPG quality (1-100, low value is better quality)
  * @param sdCardEnabled   Use SD Card to save photos
+ * @param warmStartMaxAge (optional) In seconds, max age of the sensor state saved before deep sleep to be restored on wake up (0: disabled)
  */
-Camera::Camera(framesize_t frameSize, int jpegQuality, bool sdCardEnabled) {
+Camera::Camera(framesize_t frameSize, int jpegQuality, bool sdCardEnabled, unsigned long warmStartMaxAge) {
   _frameSize = frameSize;
+  _warmStartMaxAge = warmStartMaxAge;
+  _warmStart = false;
+  _convergenceSkipped = false;
   _jpegQuality = jpegQuality;
   _sdCardEnabled = sdCardEnabled;
   _sdIsOpen = false;
+  _clipLastFps = 0;
+  _clipLastBandwidth = 0;
+  _savedPhotoCounter = 0;
 }
 
 
@@ -60,10 +103,30 @@ bool Camera::init() {
   //Initialize camera
   esp_err_t err = esp_camera_init(&config);
   if(err != ESP_OK) {
-    Serial.printf("Camera init failed with error 0x%x", err);
+    LOG_ERROR(" [-] Camera init failed with error 0x%x", err);
     return false;
   }
 
+  //Restore sensor state saved before deep sleep, if recent (similar lighting conditions): exposure and gain are
+  //set manually until the first photo is taken, so it's usable without waiting for auto exposure to converge
+  sensor_t *sensor = esp_camera_sensor_get();
+  unsigned long now = getTimestamp();
+  _warmStart = false;
+  if((_warmStartMaxAge > 0) && __cameraSensorState.valid && (sensor != NULL) && (sensor->id.PID == OV2640_PID) && (now > 1000000000) && (now >= __cameraSensorState.timestamp) && ((now - __cameraSensorState.timestamp) < _warmStartMaxAge)) {
+    sensor->set_exposure_ctrl(sensor, 0);
+    sensor->set_gain_ctrl(sensor, 0);
+    sensor->set_reg(sensor, _CAMERA_REG_REG45, 0x3F, __cameraSensorState.reg45);
+    sensor->set_reg(sensor, _CAMERA_REG_AEC, 0xFF, __cameraSensorState.aec);
+    sensor->set_reg(sensor, _CAMERA_REG_REG04, 0x03, __cameraSensorState.reg04);
+    sensor->set_reg(sensor, _CAMERA_REG_GAIN, 0xFF, __cameraSensorState.gain);
+    _warmStart = true;
+    __cameraSensorState.warmStarts++;
+    LOG_INFO(" [+] Camera warm start (sensor state saved %lu seconds ago)", (now - __cameraSensorState.timestamp));
+  } else {
+    __cameraSensorState.coldStarts++;
+  }
+  __cameraSensorState.valid = false;
+
   //Flash
   pinMode(_CAMERA_FLASH_PIN, OUTPUT);
   digitalWrite(_CAMERA_FLASH_PIN, LOW);
@@ -73,6 +136,66 @@ bool Camera::init() {
 }
 
 
+/**
+ * Camera::isWarmStart
+ * Check if the sensor state was restored on init, and no photos are taken yet
+ * @return    true if the sensor is warm started; false otherwise
+ */
+bool Camera::isWarmStart() {
+  return _warmStart;
+}
+
+
+/**
+ * Camera::waitConvergence
+ * Wait for auto exposure and white balance to converge, before the first photo after a cold start (after a warm
+ * start the sensor state is already converged, no wait)
+ */
+void Camera::waitConvergence() {
+  _convergenceSkipped = _warmStart;
+  if(!_warmStart) delay(_CAMERA_CONVERGENCE_DELAY);
+}
+
+
+/**
+ * Camera::sensorSaveState
+ * Save the converged sensor state (exposure and gain) in RTC memory, to be restored on wake up
+ * To be called before deep sleep
+ */
+void Camera::sensorSaveState() {
+  sensor_t *sensor = esp_camera_sensor_get();
+  unsigned long now = getTimestamp();
+  if((_warmStartMaxAge == 0) || _warmStart || (sensor == NULL) || (sensor->id.PID != OV2640_PID) || (now < 1000000000)) return;
+
+  __cameraSensorState.reg45 = sensor->get_reg(sensor, _CAMERA_REG_REG45, 0x3F);
+  __cameraSensorState.aec = sensor->get_reg(sensor, _CAMERA_REG_AEC, 0xFF);
+  __cameraSensorState.reg04 = sensor->get_reg(sensor, _CAMERA_REG_REG04, 0x03);
+  __cameraSensorState.gain = sensor->get_reg(sensor, _CAMERA_REG_GAIN, 0xFF);
+  __cameraSensorState.timestamp = now;
+  __cameraSensorState.valid = true;
+}
+
+
+/**
+ * Camera::sensorGetWarmStarts
+ * Get number of camera initializations with restored sensor state
+ * @return    Number of warm starts
+ */
+uint32_t Camera::sensorGetWarmStarts() {
+  return __cameraSensorState.warmStarts;
+}
+
+
+/**
+ * Camera::sensorGetColdStarts
+ * Get number of camera initializations without restored sensor state
+ * @return    Number of cold starts
+ */
+uint32_t Camera::sensorGetColdStarts() {
+  return __cameraSensorState.coldStarts;
+}
+
+
 /**
  * Camera::takePhoto
  * Takes a photo, optionally using the built-in flash
@@ -87,55 +210,61 @@ long Camera::takePhoto(uint8_t **image, bool useFlash) {
     delay(50);
   }
 
-  //Dispose first picture because of bad quality
-  camera_fb_t *fb = NULL;
-  fb = esp_camera_fb_get();
+  //Dispose first picture because of bad quality (also after a warm start: it may be exposed before the sensor state was restored)
+  camera_fb_t *fb = esp_camera_fb_get();
   esp_camera_fb_return(fb);
 
   //Takes a new photo
   fb = NULL;
   fb = esp_camera_fb_get();
 
+  //After a warm start, give back exposure and gain control to the sensor
+  if(_warmStart) {
+    sensor_t *sensor = esp_camera_sensor_get();
+    if(sensor != NULL) {
+      sensor->set_exposure_ctrl(sensor, 1);
+      sensor->set_gain_ctrl(sensor, 1);
+    }
+    if(_convergenceSkipped) LOG_DEBUG(" [i] Warm start: saved %d ms (convergence delay skipped)", _CAMERA_CONVERGENCE_DELAY);
+    _warmStart = false;
+    _convergenceSkipped = false;
+  }
+
   //Deactivate flash
   digitalWrite(_CAMERA_FLASH_PIN, LOW);
 
   //Check if photo capture failed
+  _savedPhotoCounter = 0;
   if(!fb) return -1;
   if(fb->len == 0) return -2;
 
   //Save photo on SD Card
   if(sdOpen()) {
-
-    //Build path and file name based on datetime info
-    String path = _CAMERA_SD_BASE_PATH;
-    String filename = "/WCP-";
-    if(getDateFormat("%Y") == "") {
-      //No datetime info
-      path += "/UnknownDate";
-      filename += String(random(100000000, 999999999)) + ".jpg";
-    } else {
-      //Datetime info available
-      path += "/" + getDateFormat("%F");
-      filename += getDateFormat("%Y%m%d-%H%M%S") + ".jpg";
-    }
-    String pathfilename = path + filename;
-
-    //Save photo on SD Card
-    if(SD_MMC.mkdir(path.c_str())) {
+    String pathfilename = _sdGetPathFilename("jpg");
+    if(pathfilename != "") {
       fs::FS &fs = SD_MMC; 
       File file = fs.open(pathfilename.c_str(), FILE_WRITE);
+      size_t wb = 0;
       if(file) {
-        size_t wb = file.write(fb->buf, fb->len);
-        Serial.printf(" [+] Photo saved on SD Card: %s (%d bytes)\n", pathfilename.c_str(), wb);
+        wb = file.write(fb->buf, fb->len);
+        LOG_INFO(" [+] Photo saved on SD Card: %s (%u bytes)", pathfilename.c_str(), (unsigned)wb);
       }
       file.close();
 
-      //Update Photo DB
-      photoDBPack.photoDB.photoCounter++;
-      memset(photoDBPack.photoDB.lastPhotoFilename, 0x00, _CAMERA_PHOTODB_FILENAME_MAX_LENGTH);
-      strncpy(photoDBPack.photoDB.lastPhotoFilename, pathfilename.c_str(), (_CAMERA_PHOTODB_FILENAME_MAX_LENGTH - 1));
-      photoDBPack.photoDB.lastPhotoTimestamp = getTimestamp();
-      _sdPhotoDbSave();
+      //Update Photo DB, only if the photo was written (otherwise the last photo record stays the previous one)
+      if(wb == fb->len) {
+        __cameraPhotoDbCache.photoDBPack.photoDB.photoCounter++;
+        memset(__cameraPhotoDbCache.photoDBPack.photoDB.lastPhotoFilename, 0x00, _CAMERA_PHOTODB_FILENAME_MAX_LENGTH);
+        strncpy(__cameraPhotoDbCache.photoDBPack.photoDB.lastPhotoFilename, pathfilename.c_str(), (_CAMERA_PHOTODB_FILENAME_MAX_LENGTH - 1));
+        __cameraPhotoDbCache.photoDBPack.photoDB.lastPhotoTimestamp = getTimestamp();
+        memset(__cameraPhotoDbCache.photoDBPack.photoDB.lastPhotoFileId, 0x00, _CAMERA_PHOTODB_FILEID_MAX_LENGTH);
+        _photoDbUpdate();
+        _sdPhotoDbSave();
+        _sdUpdateUsedSpace();
+        _savedPhotoCounter = __cameraPhotoDbCache.photoDBPack.photoDB.photoCounter;
+      } else {
+        LOG_ERROR(" [-] Photo not saved on SD Card: %s", pathfilename.c_str());
+      }
     }
   }
   sdClose();
@@ -150,6 +279,80 @@ long Camera::takePhoto(uint8_t **image, bool useFlash) {
 }
 
 
+/**
+ * Camera::recordClip
+ * Record a Motion-JPEG AVI clip on SD Card
+ * Frames are written straight from the camera frame buffer, without copies
+ * @param seconds     Clip duration in seconds
+ * @param frameSize   Size of the clip frames (see framesize_t)
+ * @return            true if the clip is successfully saved; false otherwise
+ */
+bool Camera::recordClip(uint8_t seconds, framesize_t frameSize) {
+  bool status = false;
+  if((seconds == 0) || !sdOpen()) {
+    sdClose();
+    return false;
+  }
+
+  String pathfilename = _sdGetPathFilename("avi");
+  if(pathfilename != "") {
+    //Set clip frame size, dispose first frame after the change
+    sensor_t *sensor = esp_camera_sensor_get();
+    if(sensor != NULL) sensor->set_framesize(sensor, frameSize);
+    camera_fb_t *fb = esp_camera_fb_get();
+    esp_camera_fb_return(fb);
+
+    //Record frames until the clip duration is reached
+    Clip clip;
+    fs::FS &fs = SD_MMC;
+    if(clip.open(fs.open(pathfilename.c_str(), FILE_WRITE))) {
+      unsigned long recordUntil = millis() + (seconds * 1000);
+      while(millis() < recordUntil) {
+        fb = esp_camera_fb_get();
+        if(!fb) break;
+        bool frameAdded = clip.addFrame(fb->buf, fb->len, fb->width, fb->height);
+        esp_camera_fb_return(fb);
+        if(!frameAdded) break;
+      }
+      status = clip.close();
+      _clipLastFps = clip.getFps();
+      _clipLastBandwidth = clip.getBandwidth();
+      LOG_INFO(" [%c] Clip saved on SD Card: %s (%d frames, %d bytes, %0.1f fps, %0.1f KB/s)", (status ? '+' : '-'), pathfilename.c_str(), clip.getFrames(), clip.getBytes(), _clipLastFps, _clipLastBandwidth);
+      _sdUpdateUsedSpace();
+    } else {
+      LOG_ERROR(" [-] Error creating clip on SD Card");
+      SD_MMC.remove(pathfilename.c_str());
+    }
+
+    //Restore photo frame size
+    if(sensor != NULL) sensor->set_framesize(sensor, _frameSize);
+  }
+  sdClose();
+
+  return status;
+}
+
+
+/**
+ * Camera::clipGetLastFps
+ * Get frame rate achieved by the last clip
+ * @return    Frames per second (0 if no clips recorded)
+ */
+float Camera::clipGetLastFps() {
+  return _clipLastFps;
+}
+
+
+/**
+ * Camera::clipGetLastBandwidth
+ * Get SD Card write bandwidth achieved by the last clip
+ * @return    Write bandwidth in KB/s (0 if no clips recorded)
+ */
+float Camera::clipGetLastBandwidth() {
+  return _clipLastBandwidth;
+}
+
+
 /**
  * Camera::flashBlink
  * Blink the flash
@@ -190,14 +393,16 @@ bool Camera::sdOpen() {
 
   //Try to open SD Card and base path
   if(!SD_MMC.begin("/sdcard", true) || (SD_MMC.cardType() == CARD_NONE) || !SD_MMC.mkdir(_CAMERA_SD_BASE_PATH)) {
-    Serial.println(" [-] Error opening SD Card");
+    LOG_ERROR(" [-] Error opening SD Card");
     sdClose();
     return false;
   }
 
-  //Check system Photo DB CRC: if not valid, then try to load Photo DB from SD Card
-  uint32_t crc = CRC32::calculate((const uint8_t *)&photoDBPack.photoDB, sizeof(_PhotoDB));
-  if(photoDBPack.crc != crc) {
+  //Check Photo DB cached in RTC memory: if not valid (i.e. after power on), then try to load Photo DB from SD Card
+  if(!_photoDbIsValid()) {
+    //Reset cache, it's valid (empty) also if Photo DB on SD Card is not available
+    __cameraPhotoDbCache.photoDBPack = _PhotoDBPackage();
+    __cameraPhotoDbCache.usedSpace = -1.0;
 
     //Try to load Photo DB from SD Card
     if(SD_MMC.exists(_CAMERA_PHOTODB)) {
@@ -205,6 +410,7 @@ bool Camera::sdOpen() {
       uint32_t crcTmp;
 
       //Read Photo DB on SD Card
+      Benchmark benchmark("camera.photoDbLoad");
       struct _PhotoDBPackage photoDBTmp;
       File file = fs.open(_CAMERA_PHOTODB, FILE_READ);
       if(file) file.read((uint8_t *)&photoDBTmp, sizeof(_PhotoDBPackage));
@@ -212,17 +418,24 @@ bool Camera::sdOpen() {
 
       //Check CRC of Photo DB from SD Card and if last photo file exists: if OK, then load it in system Photo DB
       crcTmp = CRC32::calculate((const uint8_t *)&photoDBTmp.photoDB, sizeof(_PhotoDB));
+      benchmark.end(sizeof(_PhotoDBPackage));
       if((photoDBTmp.crc == crcTmp) && SD_MMC.exists(photoDBTmp.photoDB.lastPhotoFilename)) {
-        memcpy(&photoDBPack, &photoDBTmp, sizeof(_PhotoDBPackage));
+        memcpy(&__cameraPhotoDbCache.photoDBPack, &photoDBTmp, sizeof(_PhotoDBPackage));
       } else {
         //Photo DB on SD Card is invalid, delete it
-        Serial.println(" [-] Removed invalid Photo DB on SD Card");
+        LOG_WARNING(" [-] Removed invalid Photo DB on SD Card");
         SD_MMC.remove(_CAMERA_PHOTODB);
       }
     }
+    _photoDbUpdate();
+    __cameraPhotoDbCache.dirty = false;
   }
 
   _sdIsOpen = true;
+
+  //Save pending Photo DB changes
+  if(__cameraPhotoDbCache.dirty) _sdPhotoDbSave();
+
   return true;
 }
 
@@ -241,17 +454,32 @@ void Camera::sdClose() {
 }
 
 
+/**
+ * Camera::sdSync
+ * Save pending Photo DB changes on SD Card (the SD Card is accessed only if there are changes)
+ */
+void Camera::sdSync() {
+  if(!_sdCardEnabled || !__cameraPhotoDbCache.dirty) return;
+  bool sdWasOpen = _sdIsOpen;
+  sdOpen();
+  if(!sdWasOpen) sdClose();
+}
+
+
 /**
  * Camera::sdGetUsedSpace
- * Get percentage of used space on SD Card
+ * Get percentage of used space on SD Card (the SD Card is accessed only if not known yet)
  * @return    SD card usage percentage
  */
 float Camera::sdGetUsedSpace() {
+  if(_photoDbIsValid() && (__cameraPhotoDbCache.usedSpace >= 0)) return __cameraPhotoDbCache.usedSpace;
+  bool sdWasOpen = _sdIsOpen;
   float usedSpace = -1.0;
   if(sdOpen()) {
-    usedSpace = SD_MMC.usedBytes() * 100.00 / SD_MMC.totalBytes();
+    _sdUpdateUsedSpace();
+    usedSpace = __cameraPhotoDbCache.usedSpace;
   }
-  sdClose();
+  if(!sdWasOpen) sdClose();
   return usedSpace;
 }
 
@@ -262,7 +490,17 @@ float Camera::sdGetUsedSpace() {
  * @return    Number of photo in Photo DB
  */
 uint16_t Camera::sdGetPhotoCounter() {
-  return photoDBPack.photoDB.photoCounter;
+  return __cameraPhotoDbCache.photoDBPack.photoDB.photoCounter;
+}
+
+
+/**
+ * Camera::sdGetSavedPhotoCounter
+ * Get Photo DB counter of the photo taken by the last takePhoto
+ * @return    Photo DB counter of the photo, or 0 if it was not saved on SD Card
+ */
+uint16_t Camera::sdGetSavedPhotoCounter() {
+  return _savedPhotoCounter;
 }
 
 
@@ -272,22 +510,160 @@ uint16_t Camera::sdGetPhotoCounter() {
  * @return    Timestamp of the last photo
  */
 unsigned long Camera::sdGetLastPhotoTimestamp() {
-  return photoDBPack.photoDB.lastPhotoTimestamp;
+  return __cameraPhotoDbCache.photoDBPack.photoDB.lastPhotoTimestamp;
 }
 
 
 /**
- * Camera::_photoDbSave
- * Save system Photo DB on SD Card
- * Also check the used space on SD Card
+ * Camera::sdGetLastPhotoFilename
+ * Get path and file name of the last photo
+ * @return    Path and file name of the last photo on SD Card
  */
-void Camera::_sdPhotoDbSave() {
-  //Calculate Photo DB  CRC
-  photoDBPack.crc = CRC32::calculate((const uint8_t *)&photoDBPack.photoDB, sizeof(_PhotoDB));
+const char* Camera::sdGetLastPhotoFilename() {
+  return __cameraPhotoDbCache.photoDBPack.photoDB.lastPhotoFilename;
+}
+
+
+/**
+ * Camera::sdGetLastPhotoFileId
+ * Get telegram file_id of the last photo
+ * @return    file_id of the last photo (empty if the photo was not uploaded)
+ */
+const char* Camera::sdGetLastPhotoFileId() {
+  return __cameraPhotoDbCache.photoDBPack.photoDB.lastPhotoFileId;
+}
+
 
-  //Save on SD Card
+/**
+ * Camera::sdSetLastPhotoFileId
+ * Save telegram file_id of the last photo in Photo DB, so it can be sent again without uploading it
+ * @param fileId        file_id returned by telegram
+ * @param photoCounter  Photo DB counter of the photo that was sent (see sdGetSavedPhotoCounter): the file_id is saved
+ *                      only if it's still the last photo, so it's never stored in the record of another photo
+ */
+void Camera::sdSetLastPhotoFileId(const char* fileId, uint16_t photoCounter) {
+  if((fileId == NULL) || (fileId[0] == '\0')) return;
+  if(!_photoDbIsValid()) return;  //Photo DB is loaded when photos are taken: if not valid, there's no photo to update
+  if((photoCounter == 0) || (photoCounter != __cameraPhotoDbCache.photoDBPack.photoDB.photoCounter)) return;
+  memset(__cameraPhotoDbCache.photoDBPack.photoDB.lastPhotoFileId, 0x00, _CAMERA_PHOTODB_FILEID_MAX_LENGTH);
+  strncpy(__cameraPhotoDbCache.photoDBPack.photoDB.lastPhotoFileId, fileId, (_CAMERA_PHOTODB_FILEID_MAX_LENGTH - 1));
+  _photoDbUpdate();
+}
+
+
+/**
+ * Camera::sdReadLastPhoto
+ * Read the last photo from SD Card
+ * @param image     pointer of a pointer that will be used to store the image data (original variable should be NULL)
+ * @return          size of the *image* memory block, or negative value in the case of failure (-1: SD Card not available; -2: photo not found)
+ */
+long Camera::sdReadLastPhoto(uint8_t **image) {
+  if(!sdOpen()) {
+    sdClose();
+    return -1;
+  }
+  if(__cameraPhotoDbCache.photoDBPack.photoDB.photoCounter == 0) {
+    sdClose();
+    return -2;
+  }
+  return sdReadPhoto(__cameraPhotoDbCache.photoDBPack.photoDB.lastPhotoFilename, image);
+}
+
+
+/**
+ * Camera::sdReadPhoto
+ * Read a photo from SD Card
+ * @param pathfilename  Path and file name of the photo
+ * @param image         pointer of a pointer that will be used to store the image data (original variable should be NULL)
+ * @return              size of the *image* memory block, or negative value in the case of failure (-1: SD Card not available; -2: photo not found)
+ */
+long Camera::sdReadPhoto(const char* pathfilename, uint8_t **image) {
+  long imageSize = -1;
+  if(sdOpen()) {
+    imageSize = -2;
+    fs::FS &fs = SD_MMC;
+    File file = fs.open(pathfilename, FILE_READ);
+    if(file && (file.size() > 0)) {
+      *image = (uint8_t *)malloc(file.size());
+      if(*image != NULL) imageSize = file.read(*image, file.size());
+    }
+    file.close();
+  }
+  sdClose();
+  return imageSize;
+}
+
+
+/**
+ * Camera::_sdGetPathFilename
+ * Build path and file name based on datetime info, and create the path on SD Card
+ * @param extension   File extension
+ * @return            Path and file name, empty if the path can't be created
+ */
+String Camera::_sdGetPathFilename(const char* extension) {
+  Benchmark benchmark("camera.pathFilename");
+  String path = _CAMERA_SD_BASE_PATH;
+  String filename = "/WCP-";
+  if(getDateFormat("%Y") == "") {
+    //No datetime info
+    path += "/UnknownDate";
+    filename += String(random(100000000, 999999999)) + "." + extension;
+  } else {
+    //Datetime info available
+    path += "/" + getDateFormat("%F");
+    filename += getDateFormat("%Y%m%d-%H%M%S") + "." + extension;
+  }
+  benchmark.end(path.length() + filename.length());
+
+  if(!SD_MMC.mkdir(path.c_str())) return "";
+  return path + filename;
+}
+
+
+/**
+ * Camera::_photoDbIsValid
+ * Check if the Photo DB cached in RTC memory is valid (version and CRC)
+ * @return    true if the cache is valid; false otherwise
+ */
+bool Camera::_photoDbIsValid() {
+  if(__cameraPhotoDbCache.version != _CAMERA_PHOTODB_VERSION) return false;
+  uint32_t crc = CRC32::calculate((const uint8_t *)&__cameraPhotoDbCache.photoDBPack.photoDB, sizeof(_PhotoDB));
+  return (__cameraPhotoDbCache.photoDBPack.crc == crc);
+}
+
+
+/**
+ * Camera::_photoDbUpdate
+ * Validate the Photo DB cached in RTC memory after a change (the copy on SD Card is saved later)
+ */
+void Camera::_photoDbUpdate() {
+  __cameraPhotoDbCache.photoDBPack.crc = CRC32::calculate((const uint8_t *)&__cameraPhotoDbCache.photoDBPack.photoDB, sizeof(_PhotoDB));
+  __cameraPhotoDbCache.version = _CAMERA_PHOTODB_VERSION;
+  __cameraPhotoDbCache.dirty = true;
+}
+
+
+/**
+ * Camera::_sdPhotoDbSave
+ * Save system Photo DB on SD Card (SD Card must be open)
+ */
+void Camera::_sdPhotoDbSave() {
+  Benchmark benchmark("camera.photoDbSave");
   fs::FS &fs = SD_MMC;
   File file = fs.open(_CAMERA_PHOTODB, FILE_WRITE);
-  if(file) file.write((uint8_t *)&photoDBPack, sizeof(_PhotoDBPackage));
+  if(file) {
+    file.write((uint8_t *)&__cameraPhotoDbCache.photoDBPack, sizeof(_PhotoDBPackage));
+    __cameraPhotoDbCache.dirty = false;
+  }
   file.close();
-}
\ No newline at end of file
+  benchmark.end(sizeof(_PhotoDBPackage));
+}
+
+
+/**
+ * Camera::_sdUpdateUsedSpace
+ * Update the cached percentage of used space on SD Card (SD Card must be open)
+ */
+void Camera::_sdUpdateUsedSpace() {
+  __cameraPhotoDbCache.usedSpace = SD_MMC.usedBytes() * 100.00 / SD_MMC.totalBytes();
+}
@@ -18,6 +18,9 @@
 #include "FS.h"
 #include "SD_MMC.h"
 #include "esp_camera.h"
+#include "clip.h"
+#include "benchmark.h"
+#include "logger.h"
 #include "extern.h"
 
 
@@ -46,6 +49,15 @@
 #define _CAMERA_SD_BASE_PATH  "/WildlifeCameraPics"
 #define _CAMERA_PHOTODB _CAMERA_SD_BASE_PATH "/photoDB.dat"
 #define _CAMERA_PHOTODB_FILENAME_MAX_LENGTH 100
+#define _CAMERA_PHOTODB_FILEID_MAX_LENGTH 100
+#define _CAMERA_PHOTODB_VERSION 1   //Version of the Photo DB cached in RTC memory (increase when _PhotoDB changes)
+
+//Sensor warm start (OV2640 sensor bank registers, as addressed by sensor_t get_reg/set_reg)
+#define _CAMERA_REG_GAIN    0x100   //AGC gain
+#define _CAMERA_REG_REG04   0x104   //AEC[1:0]
+#define _CAMERA_REG_AEC     0x110   //AEC[9:2]
+#define _CAMERA_REG_REG45   0x145   //AEC[15:10]
+#define _CAMERA_CONVERGENCE_DELAY 1500  //In milliseconds, time needed by auto exposure and white balance to converge after a cold start
 
 //Flash PIN
 #define _CAMERA_FLASH_PIN         GPIO_NUM_4
@@ -56,36 +68,49 @@
  */
 class Camera {
   private:
-    struct _PhotoDB {
-      uint16_t photoCounter = 0;
-      char lastPhotoFilename[_CAMERA_PHOTODB_FILENAME_MAX_LENGTH];
-      unsigned long lastPhotoTimestamp = 0;
-    };
-
-    struct _PhotoDBPackage {
-      _PhotoDB photoDB;
-      uint32_t crc;
-    };
-
-    struct _PhotoDBPackage photoDBPack;
     bool _sdIsOpen;
     framesize_t _frameSize;
     int _jpegQuality;
     bool _sdCardEnabled;
+    unsigned long _warmStartMaxAge;
+    bool _warmStart;
+    bool _convergenceSkipped;   //Convergence delay skipped because of the warm start (until the first photo)
+    float _clipLastFps;
+    float _clipLastBandwidth;
+    uint16_t _savedPhotoCounter;  //Photo DB counter of the photo taken by the last takePhoto (0: not saved on SD Card)
 
+    bool _photoDbIsValid();
+    void _photoDbUpdate();
     void _sdPhotoDbSave();
+    void _sdUpdateUsedSpace();
+    String _sdGetPathFilename(const char* extension);
 
   public:
-    Camera(framesize_t frameSize, int jpegQuality, bool sdCardEnabled);
+    Camera(framesize_t frameSize, int jpegQuality, bool sdCardEnabled, unsigned long warmStartMaxAge = 0);
     bool init();
+    bool isWarmStart();
+    void waitConvergence();
+    void sensorSaveState();
+    uint32_t sensorGetWarmStarts();
+    uint32_t sensorGetColdStarts();
     long takePhoto(uint8_t **image, bool useFlash);
+    bool recordClip(uint8_t seconds, framesize_t frameSize);
+    float clipGetLastFps();
+    float clipGetLastBandwidth();
     void flashBlink(uint16_t duration);
     void flashGpioHold(bool status);
     bool sdOpen();
     void sdClose();
+    void sdSync();
     float sdGetUsedSpace();
     uint16_t sdGetPhotoCounter();
+    uint16_t sdGetSavedPhotoCounter();
     unsigned long sdGetLastPhotoTimestamp();
+    const char* sdGetLastPhotoFilename();
+    const char* sdGetLastPhotoFileId();
+    void sdSetLastPhotoFileId(const char* fileId, uint16_t photoCounter);
+    long sdReadLastPhoto(uint8_t **image);
+    long sdReadPhoto(const char* pathfilename, uint8_t **image);
 };
 
 
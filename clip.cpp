@@ -0,0 +1,296 @@
+/**
+ * @package Wildlife Camera
+ * Motion-JPEG AVI clip writer
+ * @author WizLab.it
+ * @board AI-Thinker ESP32-CAM
+ * @version 20261018.001
+ */
+
+#include "clip.h"
+
+
+/**
+ * Clip
+ * Class constructor
+ */
+Clip::Clip() {
+  _index = NULL;
+  _frames = 0;
+  _moviSize = 0;
+  _junkSize = 0;
+  _maxFrameSize = 0;
+  _width = 0;
+  _height = 0;
+  _startTime = 0;
+  _duration = 0;
+}
+
+
+/**
+ * ~Clip
+ * Class destructor
+ */
+Clip::~Clip() {
+  free(_index);
+  _index = NULL;
+}
+
+
+/**
+ * Clip::open
+ * Start a new clip: allocate the index and reserve space for the AVI header
+ * @param file    File opened for writing
+ * @return        true if the clip is ready to receive frames; false otherwise
+ */
+bool Clip::open(File file) {
+  if(!file) return false;
+
+  //Preallocate index, so no allocations are needed while recording
+  free(_index);
+  _index = (uint8_t *)malloc(_CLIP_MAX_FRAMES * _CLIP_INDEX_ENTRY);
+  if(_index == NULL) return false;
+
+  _file = file;
+  _frames = 0;
+  _moviSize = 0;
+  _junkSize = 0;
+  _maxFrameSize = 0;
+  _width = 0;
+  _height = 0;
+  _duration = 0;
+
+  //Placeholder header, patched on close
+  _buildHeader();
+  if(_file.write(_header, _CLIP_HEADER_SIZE) != _CLIP_HEADER_SIZE) return false;
+
+  _startTime = micros();
+  return true;
+}
+
+
+/**
+ * Clip::addFrame
+ * Append a JPEG frame to the clip, writing it straight from the frame buffer
+ * @param frame         pointer to the JPEG data
+ * @param frameLength   length of the JPEG data
+ * @param width         frame width
+ * @param height        frame height
+ * @return              true if the frame is added; false if the clip is full or the write failed
+ * If a write fails, the file position goes back to the end of the last complete frame, so the partial chunk is
+ * overwritten by the following frames and the index (what's left of it after the index is covered on close)
+ */
+bool Clip::addFrame(const uint8_t *frame, size_t frameLength, uint16_t width, uint16_t height) {
+  if((_index == NULL) || (_frames >= _CLIP_MAX_FRAMES) || (frameLength == 0)) return false;
+
+  //Chunk header, frame data (chunks are padded to even size)
+  uint8_t chunkHeader[8] = { '0', '0', 'd', 'c' };
+  _putU32(chunkHeader + 4, frameLength);
+  uint32_t chunkSize = frameLength;
+  bool written = (_file.write(chunkHeader, 8) == 8) && (_file.write(frame, frameLength) == frameLength);
+  if(written && (chunkSize & 1)) {
+    written = (_file.write((uint8_t)0x00) == 1);
+    chunkSize++;
+  }
+  if(!written) {
+    _file.seek(_CLIP_HEADER_SIZE + _moviSize);
+    return false;
+  }
+
+  //Index entry: offset is relative to the "movi" fourcc
+  uint8_t *entry = _index + (_frames * _CLIP_INDEX_ENTRY);
+  memcpy(entry, "00dc", 4);
+  _putU32(entry + 4, 0x10);  //AVIIF_KEYFRAME
+  _putU32(entry + 8, (4 + _moviSize));
+  _putU32(entry + 12, frameLength);
+
+  //Update counters
+  _moviSize += 8 + chunkSize;
+  if(frameLength > _maxFrameSize) _maxFrameSize = frameLength;
+  if(_frames == 0) {
+    _width = width;
+    _height = height;
+  }
+  _frames++;
+
+  return true;
+}
+
+
+/**
+ * Clip::close
+ * Write the index, patch the header with the final values and close the file
+ * Files can't be truncated on SD_MMC (fs::File has no truncate): if a failed frame write left bytes after the index,
+ * they are covered by a JUNK chunk, so the RIFF still spans the whole file and readers skip them
+ * @return    true if the clip is successfully finalized; false otherwise
+ */
+bool Clip::close() {
+  if(_index == NULL) return false;
+  _duration = micros() - _startTime;
+  if(_duration == 0) _duration = 1;
+  bool status = (_frames > 0);
+
+  //Index
+  uint8_t indexHeader[8] = { 'i', 'd', 'x', '1' };
+  _putU32(indexHeader + 4, (_frames * _CLIP_INDEX_ENTRY));
+  if(_file.write(indexHeader, 8) != 8) status = false;
+  if(_file.write(_index, (_frames * _CLIP_INDEX_ENTRY)) != (size_t)(_frames * _CLIP_INDEX_ENTRY)) status = false;
+
+  //Bytes left after the index: JUNK chunk up to the end of the file (at least its header, padded to even size)
+  uint32_t end = getBytes();
+  _file.flush();
+  uint32_t fileSize = _file.size();
+  if(fileSize > end) {
+    _junkSize = max(fileSize - end, (uint32_t)_CLIP_JUNK_HEADER);
+    bool pad = (_junkSize & 1);
+    _junkSize += pad;
+    uint8_t junkHeader[_CLIP_JUNK_HEADER] = { 'J', 'U', 'N', 'K' };
+    _putU32(junkHeader + 4, (_junkSize - _CLIP_JUNK_HEADER));
+    if(_file.write(junkHeader, _CLIP_JUNK_HEADER) != _CLIP_JUNK_HEADER) status = false;
+    if(pad && (!_file.seek(fileSize) || (_file.write((uint8_t)0x00) != 1))) status = false;
+  }
+
+  //Patch header
+  _buildHeader();
+  if(!_file.seek(0) || (_file.write(_header, _CLIP_HEADER_SIZE) != _CLIP_HEADER_SIZE)) status = false;
+  _file.close();
+
+  free(_index);
+  _index = NULL;
+  return status;
+}
+
+
+/**
+ * Clip::getFrames
+ * Get number of frames in the clip
+ * @return    Number of frames
+ */
+uint16_t Clip::getFrames() {
+  return _frames;
+}
+
+
+/**
+ * Clip::getBytes
+ * Get clip size
+ * @return    Clip size in bytes
+ */
+uint32_t Clip::getBytes() {
+  return _CLIP_HEADER_SIZE + _moviSize + 8 + (_frames * _CLIP_INDEX_ENTRY) + _junkSize;
+}
+
+
+/**
+ * Clip::getFps
+ * Get achieved frame rate (available after close)
+ * @return    Frames per second
+ */
+float Clip::getFps() {
+  return (_duration > 0) ? (_frames * 1000000.0 / _duration) : 0;
+}
+
+
+/**
+ * Clip::getBandwidth
+ * Get achieved SD Card write bandwidth (available after close)
+ * @return    Write bandwidth in KB/s
+ */
+float Clip::getBandwidth() {
+  return (_duration > 0) ? (getBytes() * 1000000.0 / 1024.0 / _duration) : 0;
+}
+
+
+/**
+ * Clip::_buildHeader
+ * Build the AVI header (RIFF, hdrl list with avih, strh and strf, movi list header)
+ * Timing comes from the measured duration and frame count: the stream rate is frames per duration in microseconds
+ * (dwRate / dwScale), so non-integer frame rates are kept exact. Before close, timing fields are 0.
+ */
+void Clip::_buildHeader() {
+  uint8_t *h = _header;
+  memset(h, 0x00, _CLIP_HEADER_SIZE);
+  uint32_t microSecPerFrame = ((_frames > 0) && (_duration > 0)) ? (_duration / _frames) : 0;
+  uint32_t maxBytesPerSec = ((_frames > 0) && (_duration > 0)) ? (uint32_t)(((uint64_t)_maxFrameSize * _frames * 1000000ULL) / _duration) : 0;
+
+  //RIFF
+  memcpy(h, "RIFF", 4);
+  _putU32(h + 4, (getBytes() - 8));
+  memcpy(h + 8, "AVI ", 4);
+
+  //hdrl list
+  memcpy(h + 12, "LIST", 4);
+  _putU32(h + 16, 192);
+  memcpy(h + 20, "hdrl", 4);
+
+  //avih: main AVI header
+  memcpy(h + 24, "avih", 4);
+  _putU32(h + 28, 56);
+  _putU32(h + 32, microSecPerFrame);                  //dwMicroSecPerFrame
+  _putU32(h + 36, maxBytesPerSec);                    //dwMaxBytesPerSec
+  _putU32(h + 44, 0x10);                              //dwFlags: AVIF_HASINDEX
+  _putU32(h + 48, _frames);                           //dwTotalFrames
+  _putU32(h + 56, 1);                                 //dwStreams
+  _putU32(h + 60, _maxFrameSize);                     //dwSuggestedBufferSize
+  _putU32(h + 64, _width);                            //dwWidth
+  _putU32(h + 68, _height);                           //dwHeight
+
+  //strl list
+  memcpy(h + 88, "LIST", 4);
+  _putU32(h + 92, 116);
+  memcpy(h + 96, "strl", 4);
+
+  //strh: stream header
+  memcpy(h + 100, "strh", 4);
+  _putU32(h + 104, 56);
+  memcpy(h + 108, "vids", 4);                         //fccType
+  memcpy(h + 112, "MJPG", 4);                         //fccHandler
+  _putU32(h + 128, (_duration > 0) ? _duration : 1);  //dwScale: duration in microseconds
+  _putU32(h + 132, (_frames * 1000000UL));            //dwRate: frames per second, times dwScale
+  _putU32(h + 140, _frames);                          //dwLength
+  _putU32(h + 144, _maxFrameSize);                    //dwSuggestedBufferSize
+  _putU32(h + 148, 0xFFFFFFFF);                       //dwQuality
+  _putU16(h + 160, _width);                           //rcFrame right
+  _putU16(h + 162, _height);                          //rcFrame bottom
+
+  //strf: BITMAPINFOHEADER
+  memcpy(h + 164, "strf", 4);
+  _putU32(h + 168, 40);
+  _putU32(h + 172, 40);                               //biSize
+  _putU32(h + 176, _width);                           //biWidth
+  _putU32(h + 180, _height);                          //biHeight
+  _putU16(h + 184, 1);                                //biPlanes
+  _putU16(h + 186, 24);                               //biBitCount
+  memcpy(h + 188, "MJPG", 4);                         //biCompression
+  _putU32(h + 192, (_width * _height * 3));           //biSizeImage
+
+  //movi list header
+  memcpy(h + 212, "LIST", 4);
+  _putU32(h + 216, (4 + _moviSize));
+  memcpy(h + 220, "movi", 4);
+}
+
+
+/**
+ * Clip::_putU32
+ * Store a 32-bit value in little-endian order
+ * @param buffer    Destination
+ * @param value     Value to store
+ */
+void Clip::_putU32(uint8_t *buffer, uint32_t value) {
+  buffer[0] = value & 0xFF;
+  buffer[1] = (value >> 8) & 0xFF;
+  buffer[2] = (value >> 16) & 0xFF;
+  buffer[3] = (value >> 24) & 0xFF;
+}
+
+
+/**
+ * Clip::_putU16
+ * Store a 16-bit value in little-endian order
+ * @param buffer    Destination
+ * @param value     Value to store
+ */
+void Clip::_putU16(uint8_t *buffer, uint16_t value) {
+  buffer[0] = value & 0xFF;
+  buffer[1] = (value >> 8) & 0xFF;
+}
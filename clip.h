@@ -0,0 +1,63 @@
+/**
+ * @package Wildlife Camera
+ * Motion-JPEG AVI clip writer header
+ * @author WizLab.it
+ * @board AI-Thinker ESP32-CAM
+ * @version 20261018.001
+ */
+
+#ifndef CLIP_H
+#define CLIP_H
+
+
+/**
+ * Includes
+ */
+#include <Arduino.h>
+#include "FS.h"
+
+
+/**
+ * Defines
+ */
+#define _CLIP_HEADER_SIZE     224   //RIFF + hdrl list (avih, strl) + movi list header
+#define _CLIP_INDEX_ENTRY     16    //idx1 entry: chunk id, flags, offset, size
+#define _CLIP_JUNK_HEADER     8     //JUNK chunk: id, size
+#define _CLIP_MAX_FRAMES      300   //Max number of frames in a clip (size of the preallocated index)
+
+
+/**
+ * Class definition
+ */
+class Clip {
+  private:
+    File _file;
+    uint8_t _header[_CLIP_HEADER_SIZE];
+    uint8_t *_index;
+    uint16_t _frames;
+    uint32_t _moviSize;
+    uint32_t _junkSize;       //JUNK chunk after the index, over the bytes left by a failed frame write
+    uint32_t _maxFrameSize;
+    uint16_t _width;
+    uint16_t _height;
+    unsigned long _startTime;
+    unsigned long _duration;  //In microseconds
+
+    void _buildHeader();
+    static void _putU32(uint8_t *buffer, uint32_t value);
+    static void _putU16(uint8_t *buffer, uint16_t value);
+
+  public:
+    Clip();
+    ~Clip();
+    bool open(File file);
+    bool addFrame(const uint8_t *frame, size_t frameLength, uint16_t width, uint16_t height);
+    bool close();
+    uint16_t getFrames();
+    uint32_t getBytes();
+    float getFps();
+    float getBandwidth();
+};
+
+
+#endif
@@ -27,6 +27,45 @@
 #define CAMERA_FRAME_SIZE       FRAMESIZE_UXGA  //see framesize_t
 #define CAMERA_QUALITY          8               //JPG quality (1-100, low value is better quality)
 #define CAMERA_SDCARD_ENABLED   true            //Use SD Card to save photos
+#define CAMERA_CLIP_DURATION    0               //Seconds of Motion-JPEG AVI clip recorded on SD Card after motion detection (0: disabled)
+#define CAMERA_CLIP_FRAME_SIZE  FRAMESIZE_VGA   //Size of the clip frames (see framesize_t)
+#define CAMERA_WARMSTART_MAX_AGE 1800           //In seconds, max age of the sensor state saved before deep sleep to skip exposure convergence on wake up (0: disabled)
+
+
+//Near-duplicate photos (similar photos taken by motion detection are saved on SD Card, but not sent on telegram)
+#define DEDUP_THRESHOLD         5               //Max fingerprint distance (0-256) of similar photos (0: disabled)
+#define DEDUP_RESEND_INTERVAL   900             //In seconds, similar photos are sent anyway if the last photo was sent before this interval
+
+
+//Timelapse (frames captured on timer wake ups without WiFi, then uploaded in batches; schedule can be changed with the /timelapse telegram command)
+#define TIMELAPSE_INTERVAL        0             //In minutes, time between frames (0: disabled)
+#define TIMELAPSE_START_HOUR      7             //Hour of day when captures start
+#define TIMELAPSE_END_HOUR        19            //Hour of day when captures end
+#define TIMELAPSE_UPLOAD_INTERVAL 3600          //In seconds, time between uploads of the captured frames
+
+
+//LAN gateway (photos, messages and commands go through a gateway on the LAN over plain HTTP, instead of direct TLS connections to telegram)
+#define GATEWAY_HOST            ""              //Gateway host name or IP address (empty: disabled)
+#define GATEWAY_PORT            8080            //Gateway port
+#define GATEWAY_DEVICE_ID       ""              //ID of this camera on the gateway (empty: use the chip ID)
+
+
+//Photo server (LAN HTTP server for photos retrieval, started via the /server telegram command)
+#define PHOTOSERVER_DURATION    600             //In seconds, how long the photo server stays active (no authentication: the SD Card is readable from the LAN)
+
+
+//Activity digest (events are collected across deep sleeps and sent in a single message)
+#define EVENTLOG_DIGEST_INTERVAL      3600      //In seconds, max time between digests (i.e. 3600: hourly; 86400: daily)
+#define EVENTLOG_IMPORTANCE_THRESHOLD 10        //Digest is sent earlier when the events importance reaches this value (battery level decrease: 10; photo not sent: 3; WiFi failure: 2; motion: 1)
+
+
+//Logging (asynchronous, on serial)
+#define LOG_LEVEL               3               //0: none; 1: errors; 2: warnings; 3: info; 4: debug (lower level logs are not compiled)
+#define LOG_PERSIST_RECORDS     20              //Last log records kept in RTC memory across deep sleeps and resets, sent by the /log telegram command (0: disabled)
+
+
+//Benchmark
+#define BENCHMARK_ENABLED       false           //Print data-path measurements on serial as JSON lines (telegram payload and response, JSON parsing, Photo DB, paths)
 
 
 //NTP
@@ -44,6 +83,7 @@
 #define TELEGRAM_BOT_USERNAME   "telegram-bot-username"
 #define TELEGRAM_BOT_API_TOKEN  "telegram-bot-api-token"
 #define TELEGRAM_CHAT_ID        -12345
+#define TELEGRAM_EXTRA_CHAT_IDS ""            //Comma-separated list of additional Chat IDs that receive the photos and can send commands (i.e. "-67890,-13579")
 
 
 #endif
\ No newline at end of file
@@ -0,0 +1,441 @@
+/**
+ * @package Wildlife Camera
+ * Near-duplicate photos detection
+ * @author WizLab.it
+ * @board AI-Thinker ESP32-CAM
+ * @version 20261018.001
+ */
+
+#include "dedup.h"
+
+
+/**
+ * Variables
+ * Window of recent fingerprints (kept across deep sleeps)
+ */
+RTC_DATA_ATTR struct {
+  DedupFingerprint fingerprints[_DEDUP_WINDOW_SIZE];
+  unsigned long timestamps[_DEDUP_WINDOW_SIZE];
+  uint8_t count = 0;                    //Fingerprints in the window (filled from the first one)
+  uint8_t next = 0;
+  uint16_t skipped = 0;
+  unsigned long lastSent = 0;
+} __dedupWindow;
+
+
+/**
+ * Dedup
+ * Class constructor
+ * @param threshold         Max hamming distance between fingerprints of similar photos (0: detection disabled)
+ * @param resendInterval    In seconds, similar photos are sent anyway if the last photo was sent before this interval
+ */
+Dedup::Dedup(uint8_t threshold, unsigned long resendInterval) {
+  _threshold = threshold;
+  _resendInterval = resendInterval;
+}
+
+
+/**
+ * Dedup::fingerprint
+ * Calculate the perceptual fingerprint (256-bit dHash) of a JPEG photo
+ * Only the DC coefficients of the luminance are decoded (AC coefficients are skipped, no IDCT), so it's
+ * like using a 1/8 scaled grayscale image. Baseline Huffman JPEGs only (as produced by the camera).
+ * The 17x16 grid is fine enough for an animal covering a small part of the frame to change several cells.
+ * @param jpeg          pointer to the JPEG data
+ * @param length        length of the JPEG data
+ * @param fingerprint   fingerprint calculated
+ * @return              true if successful; false if the JPEG can't be decoded
+ */
+bool Dedup::fingerprint(const uint8_t *jpeg, size_t length, DedupFingerprint *fingerprint) {
+  memset(fingerprint, 0x00, sizeof(DedupFingerprint));
+  if((length < 4) || (jpeg[0] != 0xFF) || (jpeg[1] != 0xD8)) return false;
+
+  _JpegContext *ctx = (_JpegContext *)calloc(1, sizeof(_JpegContext));
+  if(ctx == NULL) return false;
+
+  uint16_t width = 0;
+  uint16_t height = 0;
+  uint16_t restartInterval = 0;
+  uint8_t components = 0;
+  uint8_t componentIds[4];
+  uint8_t sampling[4];
+  uint8_t scanTables[4];
+  bool valid = true;
+  bool decoded = false;
+
+  //Parse segments up to the scan
+  const uint8_t *p = jpeg + 2;
+  const uint8_t *end = jpeg + length;
+  while(valid && !decoded && ((p + 4) <= end)) {
+    if(p[0] != 0xFF) break;
+    uint8_t marker = p[1];
+    if(marker == 0xFF) {
+      p++;
+      continue;
+    }
+    const uint8_t *segment = p + 4;
+    const uint8_t *segmentEnd = p + 2 + ((p[2] << 8) | p[3]);
+    if((segmentEnd > end) || (segmentEnd < segment)) break;
+
+    switch(marker) {
+      //Start of frame (baseline or extended sequential, Huffman)
+      case 0xC0:
+      case 0xC1:
+        height = (segment[1] << 8) | segment[2];
+        width = (segment[3] << 8) | segment[4];
+        components = segment[5];
+        if((components == 0) || (components > 4) || (width == 0) || (height == 0)) {
+          valid = false;
+          break;
+        }
+        for(uint8_t i=0; i<components; i++) {
+          componentIds[i] = segment[6 + (i * 3)];
+          sampling[i] = segment[7 + (i * 3)];
+        }
+        break;
+
+      //Progressive, lossless and arithmetic coding are not supported
+      case 0xC2: case 0xC3: case 0xC5: case 0xC6: case 0xC7:
+      case 0xC9: case 0xCA: case 0xCB: case 0xCD: case 0xCE: case 0xCF:
+        valid = false;
+        break;
+
+      //Huffman tables
+      case 0xC4:
+        for(const uint8_t *q=segment; (q + 17) <= segmentEnd; ) {
+          uint8_t tableClass = q[0] >> 4;
+          uint8_t tableId = q[0] & 0x0F;
+          uint16_t total = 0;
+          for(uint8_t i=1; i<=16; i++) total += q[i];
+          if((tableClass > 1) || (tableId > 3) || (total > 256) || ((q + 17 + total) > segmentEnd)) {
+            valid = false;
+            break;
+          }
+          _buildTable(&ctx->tables[tableClass][tableId], (q + 1), (q + 17));
+          q += 17 + total;
+        }
+        break;
+
+      //Restart interval
+      case 0xDD:
+        restartInterval = (segment[0] << 8) | segment[1];
+        break;
+
+      //Start of scan: only single-scan JPEGs with all components are supported
+      case 0xDA:
+        if((components == 0) || (segment[0] != components)) {
+          valid = false;
+          break;
+        }
+        for(uint8_t i=0; i<components; i++) {
+          for(uint8_t j=0; j<components; j++) {
+            if(componentIds[j] == segment[1 + (i * 2)]) scanTables[j] = segment[2 + (i * 2)];
+          }
+        }
+        ctx->data = segmentEnd;
+        ctx->end = end;
+        valid = _decodeScan(ctx, width, height, components, sampling, scanTables, restartInterval);
+        decoded = true;
+        break;
+    }
+    p = segmentEnd;
+  }
+
+  //dHash: each bit tells if a cell is brighter than the next one on the same row
+  if(valid && decoded) {
+    uint16_t bit = 0;
+    for(uint8_t y=0; y<_DEDUP_GRID_HEIGHT; y++) {
+      for(uint8_t x=0; x<(_DEDUP_GRID_WIDTH - 1); x++) {
+        int64_t left = (int64_t)ctx->gridSum[y][x] * ctx->gridCount[y][x + 1];
+        int64_t right = (int64_t)ctx->gridSum[y][x + 1] * ctx->gridCount[y][x];
+        if(left > right) fingerprint->bits[bit / 64] |= (1ULL << (bit % 64));
+        bit++;
+      }
+    }
+  }
+
+  free(ctx);
+  return (valid && decoded);
+}
+
+
+/**
+ * Dedup::distance
+ * Hamming distance between two fingerprints
+ * @param a   First fingerprint
+ * @param b   Second fingerprint
+ * @return    Number of different bits (0-256)
+ */
+uint16_t Dedup::distance(const DedupFingerprint &a, const DedupFingerprint &b) {
+  uint16_t bits = 0;
+  for(uint8_t i=0; i<_DEDUP_FINGERPRINT_WORDS; i++) bits += __builtin_popcountll(a.bits[i] ^ b.bits[i]);
+  return bits;
+}
+
+
+/**
+ * Dedup::isDuplicate
+ * Check if a photo is similar to one of the recent photos, then add it to the recent photos
+ * @param jpeg      pointer to the JPEG data
+ * @param length    length of the JPEG data
+ * @return          true if the photo is similar to a recent one and should not be sent; false otherwise
+ */
+bool Dedup::isDuplicate(const uint8_t *jpeg, size_t length) {
+  if(_threshold == 0) return false;
+
+  //Calculate fingerprint
+  Benchmark benchmark("dedup.fingerprint");
+  DedupFingerprint fingerprint;
+  bool decoded = Dedup::fingerprint(jpeg, length, &fingerprint);
+  benchmark.end(length);
+  if(!decoded) return false;
+
+  //Compare with recent fingerprints
+  unsigned long now = getTimestamp();
+  bool similar = false;
+  for(uint8_t i=0; i<__dedupWindow.count; i++) {
+    if(((now - __dedupWindow.timestamps[i]) < _DEDUP_WINDOW_DURATION) && (distance(fingerprint, __dedupWindow.fingerprints[i]) <= _threshold)) {
+      similar = true;
+      break;
+    }
+  }
+
+  //Add to recent fingerprints
+  __dedupWindow.fingerprints[__dedupWindow.next] = fingerprint;
+  __dedupWindow.timestamps[__dedupWindow.next] = now;
+  __dedupWindow.next = (__dedupWindow.next + 1) % _DEDUP_WINDOW_SIZE;
+  if(__dedupWindow.count < _DEDUP_WINDOW_SIZE) __dedupWindow.count++;
+
+  //Similar photos are skipped, unless the last photo was sent long ago
+  if(similar && ((now - __dedupWindow.lastSent) < _resendInterval)) {
+    __dedupWindow.skipped++;
+    LOG_INFO(" [i] Photo similar to a recent one, not sent (%d skipped)", __dedupWindow.skipped);
+    return true;
+  }
+
+  return false;
+}
+
+
+/**
+ * Dedup::markSent
+ * Register that a photo was sent: resets the skipped photos counter
+ */
+void Dedup::markSent() {
+  __dedupWindow.lastSent = getTimestamp();
+  __dedupWindow.skipped = 0;
+}
+
+
+/**
+ * Dedup::getSkipped
+ * Get number of similar photos not sent since the last sent photo
+ * @return    Number of skipped photos
+ */
+uint16_t Dedup::getSkipped() {
+  return __dedupWindow.skipped;
+}
+
+
+/**
+ * Dedup::_buildTable
+ * Build a Huffman decoding table (canonical codes) from a DHT segment
+ * @param table     Table to build
+ * @param counts    Number of codes for each length (16 bytes)
+ * @param symbols   Symbols, in code order
+ */
+void Dedup::_buildTable(_HuffmanTable *table, const uint8_t *counts, const uint8_t *symbols) {
+  memset(table, 0x00, sizeof(_HuffmanTable));
+  uint16_t code = 0;
+  uint16_t k = 0;
+  for(uint8_t length=1; length<=16; length++) {
+    table->valuePointer[length] = k;
+    table->minCode[length] = code;
+    for(uint8_t i=0; i<counts[length - 1]; i++) {
+      table->values[k] = symbols[k];
+
+      //Short codes are also added to the lookup table
+      if(length <= 8) {
+        uint16_t first = code << (8 - length);
+        for(uint16_t j=0; j<(1 << (8 - length)); j++) {
+          table->lookupLength[first + j] = length;
+          table->lookupSymbol[first + j] = symbols[k];
+        }
+      }
+      code++;
+      k++;
+    }
+    table->maxCode[length] = (counts[length - 1] > 0) ? (code - 1) : -1;
+    code <<= 1;
+  }
+}
+
+
+/**
+ * Dedup::_fillBits
+ * Fill the bit buffer from the entropy-coded data (removes 0xFF00 stuffing, feeds zeros at markers)
+ * @param ctx   JPEG decoding context
+ */
+void Dedup::_fillBits(_JpegContext *ctx) {
+  while(ctx->bitCount <= 24) {
+    uint8_t b = 0;
+    if(ctx->data < ctx->end) {
+      b = ctx->data[0];
+      if(b != 0xFF) {
+        ctx->data++;
+      } else if(((ctx->data + 1) < ctx->end) && (ctx->data[1] == 0x00)) {
+        ctx->data += 2;
+      } else {
+        b = 0;
+      }
+    }
+    ctx->bitBuffer |= (uint32_t)b << (24 - ctx->bitCount);
+    ctx->bitCount += 8;
+  }
+}
+
+
+/**
+ * Dedup::_getBits
+ * Read bits from the entropy-coded data
+ * @param ctx   JPEG decoding context
+ * @param n     Number of bits (0-16)
+ * @return      Bits value
+ */
+uint32_t Dedup::_getBits(_JpegContext *ctx, uint8_t n) {
+  if(n == 0) return 0;
+  _fillBits(ctx);
+  uint32_t value = ctx->bitBuffer >> (32 - n);
+  ctx->bitBuffer <<= n;
+  ctx->bitCount -= n;
+  return value;
+}
+
+
+/**
+ * Dedup::_decodeSymbol
+ * Decode a Huffman symbol
+ * @param ctx     JPEG decoding context
+ * @param table   Huffman table
+ * @return        Symbol, negative value if the code is invalid
+ */
+int16_t Dedup::_decodeSymbol(_JpegContext *ctx, _HuffmanTable *table) {
+  _fillBits(ctx);
+
+  //Short codes
+  uint8_t lookup = ctx->bitBuffer >> 24;
+  uint8_t length = table->lookupLength[lookup];
+  if(length > 0) {
+    ctx->bitBuffer <<= length;
+    ctx->bitCount -= length;
+    return table->lookupSymbol[lookup];
+  }
+
+  //Long codes
+  for(length=9; length<=16; length++) {
+    int32_t code = ctx->bitBuffer >> (32 - length);
+    if(code <= table->maxCode[length]) {
+      ctx->bitBuffer <<= length;
+      ctx->bitCount -= length;
+      return table->values[table->valuePointer[length] + code - table->minCode[length]];
+    }
+  }
+
+  return -1;
+}
+
+
+/**
+ * Dedup::_decodeScan
+ * Decode the DC coefficients of the scan, accumulating the luminance in the dHash grid
+ * @param ctx               JPEG decoding context (data points to the entropy-coded data)
+ * @param width             Image width
+ * @param height            Image height
+ * @param components        Number of components
+ * @param sampling          Sampling factors of each component (H << 4 | V)
+ * @param scanTables        Huffman tables of each component (DC << 4 | AC)
+ * @param restartInterval   MCUs between restart markers (0: no restart markers)
+ * @return                  true if the scan is decoded; false otherwise
+ */
+bool Dedup::_decodeScan(_JpegContext *ctx, uint16_t width, uint16_t height, uint8_t components, uint8_t *sampling, uint8_t *scanTables, uint16_t restartInterval) {
+  //MCU size
+  uint8_t hMax = 1;
+  uint8_t vMax = 1;
+  if(components > 1) {
+    for(uint8_t c=0; c<components; c++) {
+      if((sampling[c] >> 4) > hMax) hMax = sampling[c] >> 4;
+      if((sampling[c] & 0x0F) > vMax) vMax = sampling[c] & 0x0F;
+    }
+  }
+  uint16_t mcusX = (width + (8 * hMax) - 1) / (8 * hMax);
+  uint16_t mcusY = (height + (8 * vMax) - 1) / (8 * vMax);
+
+  int32_t predictor[4] = { 0, 0, 0, 0 };
+  uint16_t restartsLeft = restartInterval;
+  ctx->bitBuffer = 0;
+  ctx->bitCount = 0;
+
+  for(uint16_t mcuY=0; mcuY<mcusY; mcuY++) {
+    for(uint16_t mcuX=0; mcuX<mcusX; mcuX++) {
+      //Restart marker: realign to the next byte and reset predictors
+      if(restartInterval > 0) {
+        if(restartsLeft == 0) {
+          ctx->bitBuffer = 0;
+          ctx->bitCount = 0;
+          while(((ctx->data + 1) < ctx->end) && !((ctx->data[0] == 0xFF) && ((ctx->data[1] & 0xF8) == 0xD0))) ctx->data++;
+          ctx->data += 2;
+          memset(predictor, 0x00, sizeof(predictor));
+          restartsLeft = restartInterval;
+        }
+        restartsLeft--;
+      }
+
+      for(uint8_t c=0; c<components; c++) {
+        uint8_t h = (components > 1) ? (sampling[c] >> 4) : 1;
+        uint8_t v = (components > 1) ? (sampling[c] & 0x0F) : 1;
+        _HuffmanTable *dcTable = &ctx->tables[0][(scanTables[c] >> 4) & 0x03];
+        _HuffmanTable *acTable = &ctx->tables[1][scanTables[c] & 0x03];
+
+        for(uint8_t blockV=0; blockV<v; blockV++) {
+          for(uint8_t blockH=0; blockH<h; blockH++) {
+            //DC coefficient
+            int16_t size = _decodeSymbol(ctx, dcTable);
+            if((size < 0) || (size > 16)) return false;
+            int32_t diff = _getBits(ctx, size);
+            if((size > 0) && (diff < (1 << (size - 1)))) diff -= (1 << size) - 1;
+            predictor[c] += diff;
+
+            //Luminance: accumulate in the grid cell of the block
+            if(c == 0) {
+              uint32_t x = ((mcuX * h) + blockH) * 8 * (hMax / h);
+              uint32_t y = ((mcuY * v) + blockV) * 8 * (vMax / v);
+              if((x < width) && (y < height)) {
+                uint8_t gridX = (x * _DEDUP_GRID_WIDTH) / width;
+                uint8_t gridY = (y * _DEDUP_GRID_HEIGHT) / height;
+                ctx->gridSum[gridY][gridX] += predictor[c];
+                ctx->gridCount[gridY][gridX]++;
+              }
+            }
+
+            //AC coefficients are skipped
+            for(uint8_t k=1; k<64; ) {
+              int16_t symbol = _decodeSymbol(ctx, acTable);
+              if(symbol < 0) return false;
+              uint8_t run = symbol >> 4;
+              uint8_t bits = symbol & 0x0F;
+              if(bits == 0) {
+                if(run != 15) break; //End of block
+                k += 16;
+              } else {
+                k += run + 1;
+                _getBits(ctx, bits);
+              }
+            }
+          }
+        }
+      }
+    }
+  }
+
+  return true;
+}
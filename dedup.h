@@ -0,0 +1,85 @@
+/**
+ * @package Wildlife Camera
+ * Near-duplicate photos detection header
+ * @author WizLab.it
+ * @board AI-Thinker ESP32-CAM
+ * @version 20261018.001
+ */
+
+#ifndef DEDUP_H
+#define DEDUP_H
+
+
+/**
+ * Defines
+ */
+#define _DEDUP_WINDOW_SIZE       8      //Number of recent fingerprints kept in RTC memory
+#define _DEDUP_WINDOW_DURATION   1800   //In seconds, fingerprints older than this are ignored
+#define _DEDUP_GRID_WIDTH        17     //dHash grid (17x16 cells: 16 horizontal gradients per row, 256 bits)
+#define _DEDUP_GRID_HEIGHT       16
+#define _DEDUP_FINGERPRINT_WORDS (((_DEDUP_GRID_WIDTH - 1) * _DEDUP_GRID_HEIGHT) / 64)
+
+
+/**
+ * Includes
+ */
+#include <Arduino.h>
+#include "benchmark.h"
+#include "logger.h"
+#include "extern.h"
+
+
+/**
+ * Fingerprint (dHash bits, row by row)
+ */
+struct DedupFingerprint {
+  uint64_t bits[_DEDUP_FINGERPRINT_WORDS];
+};
+
+
+/**
+ * Class definition
+ */
+class Dedup {
+  private:
+    //Huffman table, with 8-bit lookup for short codes
+    struct _HuffmanTable {
+      uint8_t lookupLength[256];
+      uint8_t lookupSymbol[256];
+      int32_t maxCode[18];
+      int32_t minCode[17];
+      uint16_t valuePointer[17];
+      uint8_t values[256];
+    };
+
+    //JPEG decoding context
+    struct _JpegContext {
+      _HuffmanTable tables[2][4];   //[class: 0 DC, 1 AC][id]
+      const uint8_t *data;
+      const uint8_t *end;
+      uint32_t bitBuffer;
+      int8_t bitCount;
+      int32_t gridSum[_DEDUP_GRID_HEIGHT][_DEDUP_GRID_WIDTH];
+      uint16_t gridCount[_DEDUP_GRID_HEIGHT][_DEDUP_GRID_WIDTH];
+    };
+
+    uint8_t _threshold;
+    unsigned long _resendInterval;
+
+    static void _buildTable(_HuffmanTable *table, const uint8_t *counts, const uint8_t *symbols);
+    static void _fillBits(_JpegContext *ctx);
+    static uint32_t _getBits(_JpegContext *ctx, uint8_t n);
+    static int16_t _decodeSymbol(_JpegContext *ctx, _HuffmanTable *table);
+    static bool _decodeScan(_JpegContext *ctx, uint16_t width, uint16_t height, uint8_t components, uint8_t *sampling, uint8_t *scanTables, uint16_t restartInterval);
+
+  public:
+    Dedup(uint8_t threshold, unsigned long resendInterval);
+    static bool fingerprint(const uint8_t *jpeg, size_t length, DedupFingerprint *fingerprint);
+    static uint16_t distance(const DedupFingerprint &a, const DedupFingerprint &b);
+    bool isDuplicate(const uint8_t *jpeg, size_t length);
+    void markSent();
+    uint16_t getSkipped();
+};
+
+
+#endif
@@ -0,0 +1,166 @@
+/**
+ * @package Wildlife Camera
+ * Activity event log and digests
+ * @author WizLab.it
+ * @board AI-Thinker ESP32-CAM
+ * @version 20261018.001
+ */
+
+#include "eventlog.h"
+
+
+/**
+ * Variables
+ * Events since the last digest (kept across deep sleeps)
+ */
+struct _Event {
+  unsigned long timestamp;
+  int16_t value;
+  uint8_t type;
+};
+
+RTC_DATA_ATTR struct {
+  struct _Event events[_EVENTLOG_SIZE];
+  uint8_t next = 0;
+  uint8_t count = 0;
+  uint16_t totals[_EVENTLOG_TYPES];
+  uint16_t importance = 0;
+  unsigned long since = 0;
+} __eventLog;
+
+
+/**
+ * EventLog
+ * Class constructor
+ * @param digestInterval        In seconds, max time between digests
+ * @param importanceThreshold   Digest is sent before the interval if the importance of the events reaches this threshold
+ */
+EventLog::EventLog(unsigned long digestInterval, uint16_t importanceThreshold) {
+  _digestInterval = digestInterval;
+  _importanceThreshold = importanceThreshold;
+}
+
+
+/**
+ * EventLog::log
+ * Add an event to the log
+ * @param type          Event type (_EVENTLOG_*)
+ * @param value         (optional) Event value
+ */
+void EventLog::log(uint8_t type, int16_t value) {
+  static const uint8_t importance[_EVENTLOG_TYPES] = _EVENTLOG_IMPORTANCE;
+  if(type >= _EVENTLOG_TYPES) return;
+  unsigned long now = getTimestamp();
+  if((__eventLog.count == 0) && (__eventLog.importance == 0)) __eventLog.since = now;
+
+  __eventLog.events[__eventLog.next].timestamp = now;
+  __eventLog.events[__eventLog.next].value = value;
+  __eventLog.events[__eventLog.next].type = type;
+  __eventLog.next = (__eventLog.next + 1) % _EVENTLOG_SIZE;
+  if(__eventLog.count < _EVENTLOG_SIZE) __eventLog.count++;
+
+  if(__eventLog.totals[type] < 65535) __eventLog.totals[type]++;
+  __eventLog.importance += importance[type];
+}
+
+
+/**
+ * EventLog::isDigestDue
+ * Check if the digest should be sent: importance threshold reached, or digest interval elapsed with activity to
+ * report (battery samples alone, logged at every wake up, don't make a digest)
+ * @return    true if the digest is due; false otherwise
+ */
+bool EventLog::isDigestDue() {
+  if(__eventLog.count == 0) return false;
+  if(__eventLog.importance >= _importanceThreshold) return true;
+  bool activity = false;
+  for(uint8_t i=0; i<_EVENTLOG_TYPES; i++) {
+    if((i != _EVENTLOG_BATTERY) && (__eventLog.totals[i] > 0)) activity = true;
+  }
+  if(!activity) return false;
+  unsigned long now = getTimestamp();
+  return (now < __eventLog.since) || ((now - __eventLog.since) >= _digestInterval);
+}
+
+
+/**
+ * EventLog::getPendingEvents
+ * Get number of events waiting for the next digest
+ * @return    Number of events
+ */
+uint8_t EventLog::getPendingEvents() {
+  return __eventLog.count;
+}
+
+
+/**
+ * EventLog::getDigest
+ * Build the digest message: totals, last battery sample, then the timeline of the most recent events
+ * @return    Digest message
+ */
+String EventLog::getDigest() {
+  String since = getDateFormat("%F, %T", __eventLog.since);
+  String digest = "Wildlife Camera activity" + ((since == "") ? String("") : " since " + since) + "\n";
+
+  //Totals
+  digest += " [+] Motion events: " + String(__eventLog.totals[_EVENTLOG_PIR]) + "\n"
+    " [+] Photos sent: " + String(__eventLog.totals[_EVENTLOG_UPLOAD_OK]) + "\n"
+    " [" + String((__eventLog.totals[_EVENTLOG_UPLOAD_FAILED] > 0) ? "-" : "+") + "] Photos not sent (errors): " + String(__eventLog.totals[_EVENTLOG_UPLOAD_FAILED]) + "\n"
+    " [+] Similar photos not sent: " + String(__eventLog.totals[_EVENTLOG_DUPLICATE]) + "\n"
+    " [" + String((__eventLog.totals[_EVENTLOG_WIFI_FAILURE] > 0) ? "-" : "+") + "] WiFi failures: " + String(__eventLog.totals[_EVENTLOG_WIFI_FAILURE]) + "\n";
+
+  //Last battery sample and level changes
+  uint8_t oldest = (__eventLog.count < _EVENTLOG_SIZE) ? 0 : __eventLog.next;
+  for(uint8_t i=__eventLog.count; i>0; i--) {
+    struct _Event *event = &__eventLog.events[(oldest + i - 1) % _EVENTLOG_SIZE];
+    if(event->type == _EVENTLOG_BATTERY) {
+      digest += " [+] Battery pack voltage: " + String(event->value / 1000.0) + "V\n";
+      break;
+    }
+  }
+
+  //Timeline (battery samples excluded)
+  String timeline = "";
+  uint8_t listed = 0;
+  uint8_t notListed = 0;
+  for(uint8_t i=__eventLog.count; i>0; i--) {
+    struct _Event *event = &__eventLog.events[(oldest + i - 1) % _EVENTLOG_SIZE];
+    if(event->type == _EVENTLOG_BATTERY) continue;
+    if(listed == _EVENTLOG_TIMELINE_MAX) {
+      notListed++;
+      continue;
+    }
+    String line = getDateFormat("%H:%M:%S", event->timestamp);
+    if(line == "") line = "--:--:--";
+    switch(event->type) {
+      case _EVENTLOG_PIR: line += " motion"; break;
+      case _EVENTLOG_DUPLICATE: line += " similar photo not sent"; break;
+      case _EVENTLOG_BATTERY_LEVEL: line += " battery level " + String(event->value) + "/5"; break;
+      case _EVENTLOG_WIFI_FAILURE: line += " WiFi failure"; break;
+      case _EVENTLOG_UPLOAD_OK: line += " photo sent"; break;
+      case _EVENTLOG_UPLOAD_FAILED: line += " photo not sent (err: " + String(event->value) + ")"; break;
+    }
+    timeline = " " + line + "\n" + timeline;
+    listed++;
+  }
+  if(timeline != "") {
+    digest += "\nEvents:\n";
+    if(notListed > 0) digest += " (" + String(notListed) + " older events not listed)\n";
+    digest += timeline;
+  }
+
+  return digest;
+}
+
+
+/**
+ * EventLog::clear
+ * Clear the log, to be called when the digest is sent
+ */
+void EventLog::clear() {
+  __eventLog.next = 0;
+  __eventLog.count = 0;
+  __eventLog.importance = 0;
+  __eventLog.since = getTimestamp();
+  memset(__eventLog.totals, 0x00, sizeof(__eventLog.totals));
+}
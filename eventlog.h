@@ -0,0 +1,58 @@
+/**
+ * @package Wildlife Camera
+ * Activity event log and digests header
+ * @author WizLab.it
+ * @board AI-Thinker ESP32-CAM
+ * @version 20261018.001
+ */
+
+#ifndef EVENTLOG_H
+#define EVENTLOG_H
+
+
+/**
+ * Defines
+ */
+#define _EVENTLOG_SIZE              64    //Number of events kept in RTC memory (oldest are overwritten)
+#define _EVENTLOG_TIMELINE_MAX      30    //Max number of events listed in a digest
+
+//Event types
+#define _EVENTLOG_PIR               0     //Motion detected
+#define _EVENTLOG_DUPLICATE         1     //Photo similar to a recent one, not sent
+#define _EVENTLOG_BATTERY           2     //Battery sample (value: pack millivolts)
+#define _EVENTLOG_BATTERY_LEVEL     3     //Battery level decreased (value: level)
+#define _EVENTLOG_WIFI_FAILURE      4     //WiFi connection failed
+#define _EVENTLOG_UPLOAD_OK         5     //Photo sent
+#define _EVENTLOG_UPLOAD_FAILED     6     //Photo not sent (value: error code)
+#define _EVENTLOG_TYPES             7
+
+//Event importance, by type (a digest is sent as soon as the sum reaches the importance threshold)
+#define _EVENTLOG_IMPORTANCE        { 1, 0, 0, 10, 2, 0, 3 }
+
+
+/**
+ * Includes
+ */
+#include <Arduino.h>
+#include "extern.h"
+
+
+/**
+ * Class definition
+ */
+class EventLog {
+  private:
+    unsigned long _digestInterval;
+    uint16_t _importanceThreshold;
+
+  public:
+    EventLog(unsigned long digestInterval, uint16_t importanceThreshold);
+    void log(uint8_t type, int16_t value = 0);
+    bool isDigestDue();
+    uint8_t getPendingEvents();
+    String getDigest();
+    void clear();
+};
+
+
+#endif
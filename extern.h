@@ -14,9 +14,11 @@
  * External functions
  */
 extern unsigned long setWakeupEnd(unsigned long increase);
+extern unsigned long getWakeupRemaining();
 extern unsigned long getTimestamp();
 extern unsigned long getUptime();
 extern String getDateFormat(String format, time_t timestamp = 0);
+extern int8_t getHour(unsigned long timestamp = 0);
 extern uint32_t getBatteryVoltage(bool getRaw = true);
 extern uint8_t getBatteryLevel();
 extern float cameraSdGetUsedSpace();
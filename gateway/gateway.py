@@ -0,0 +1,448 @@
+#!/usr/bin/env python3
+#
+# @package Wildlife Camera
+# LAN gateway: cameras send photos, messages and commands polling over plain HTTP to the gateway, that relays them to
+# telegram. Photos are queued, deduplicated by content and sent in batches (media groups of up to 10 photos), then
+# forwarded by file_id to the additional recipients; commands are polled once for all the cameras and relayed to the
+# camera they're addressed to (/command@DEVICE_ID), or to all of them.
+# Standard library only. Requests to telegram are retried on connection errors, rate limit (retry_after) and server
+# errors, never when the response is lost after the whole request was sent (telegram may have delivered it).
+# @author WizLab.it
+# @version 20261018.001
+#
+# python3 gateway.py --token 123456789:ABC --chat-id -1001987654321 [--chat-id 234567891] [--devices cam1,cam2]
+# prints "port <n>" on the first line, then serves until terminated (--port 0 picks a free port)
+#
+
+import argparse
+import collections
+import hashlib
+import http.client
+import http.server
+import json
+import logging
+import os
+import random
+import ssl
+import sys
+import threading
+import time
+import urllib.parse
+import uuid
+
+
+TELEGRAM_MEDIA_GROUP_MAX = 10   #Photos per sendMediaGroup request
+DEVICE_UPDATES_MAX = 100        #Commands kept for each camera, until acknowledged with the getUpdates offset
+
+
+class Stats:
+  """Counters of the gateway"""
+  def __init__(self):
+    self.lock = threading.Lock()
+    self.counters = collections.OrderedDict((name, 0) for name in (
+      "photos_received", "photos_duplicated", "photos_rejected", "photos_sent", "photos_unconfirmed", "photos_failed",
+      "photos_forwarded", "batches", "retries", "relayed", "polls", "commands", "commands_relayed"))
+
+  def add(self, name, value=1):
+    with self.lock:
+      self.counters[name] += value
+
+  def report(self):
+    with self.lock:
+      return dict(self.counters)
+
+
+def multipart(fields, files):
+  """Body and content type of a multipart/form-data request; files are (name, filename, content type, data)"""
+  boundary = "WildlifeCameraGateway" + uuid.uuid4().hex
+  parts = []
+  for name, value in fields.items():
+    parts.append(("--%s\r\nContent-Disposition: form-data; name=\"%s\"\r\n\r\n%s\r\n" % (boundary, name, value)).encode())
+  for name, filename, contentType, data in files:
+    parts.append(("--%s\r\nContent-Disposition: form-data; name=\"%s\"; filename=\"%s\"\r\nContent-Type: %s\r\n\r\n" % (boundary, name, filename, contentType)).encode())
+    parts.append(data)
+    parts.append(b"\r\n")
+  parts.append(("--%s--\r\n" % boundary).encode())
+  return b"".join(parts), "multipart/form-data; boundary=" + boundary
+
+
+class Upstream:
+  """Telegram Bot API client, a new connection for each request"""
+  SENT_NO_RESPONSE = -1   #Status: the whole request was sent, the response is missing or truncated
+  NOT_SENT = 0            #Status: connection failed, or the request was not sent completely
+
+  def __init__(self, api, token, stats, attempts=5, backoff=1.0, timeout=30):
+    url = urllib.parse.urlsplit(api)
+    self.https = (url.scheme == "https")
+    self.host = url.hostname
+    self.port = url.port or (443 if self.https else 80)
+    self.prefix = url.path.rstrip("/") + "/bot" + token + "/"
+    self.stats = stats
+    self.attempts = attempts
+    self.backoff = backoff
+    self.timeout = timeout
+    self.context = ssl.create_default_context() if self.https else None
+
+  def _request(self, method, body, contentType):
+    if self.https:
+      connection = http.client.HTTPSConnection(self.host, self.port, timeout=self.timeout, context=self.context)
+    else:
+      connection = http.client.HTTPConnection(self.host, self.port, timeout=self.timeout)
+    try:
+      try:
+        connection.request("POST", self.prefix + method, body, {"Content-Type": contentType, "Connection": "close"})
+      except (OSError, http.client.HTTPException):
+        return self.NOT_SENT, None
+      try:
+        response = connection.getresponse()
+        data = response.read()
+      except (OSError, http.client.HTTPException):
+        return self.SENT_NO_RESPONSE, None
+      try:
+        return response.status, json.loads(data)
+      except ValueError:
+        return response.status, {"ok": False, "error_code": response.status, "description": "Invalid response"}
+    finally:
+      connection.close()
+
+  def request(self, method, body, contentType, retry=True):
+    """HTTP status and response of a telegram method (see NOT_SENT and SENT_NO_RESPONSE)"""
+    attempt = 1
+    while True:
+      status, result = self._request(method, body, contentType)
+      retryable = (status == self.NOT_SENT) or (status == 429) or (status >= 500)
+      if not retry or not retryable or (attempt >= self.attempts):
+        return status, result
+      if status == 429:
+        wait = (result.get("parameters", {}).get("retry_after", 1)) + random.uniform(0, self.backoff)
+      else:
+        wait = (self.backoff * (2 ** (attempt - 1))) * random.uniform(0.5, 1.0)
+      logging.warning("telegram %s failed (status %d), retry %d in %0.1f s", method, status, attempt, wait)
+      self.stats.add("retries")
+      time.sleep(wait)
+      attempt += 1
+
+
+class Photo:
+  def __init__(self, deviceId, data, caption, chatId, digest):
+    self.deviceId = deviceId
+    self.data = data
+    self.caption = caption
+    self.chatId = chatId          #None: the gateway recipients
+    self.digest = digest
+    self.received = time.monotonic()
+
+
+class Device:
+  def __init__(self, deviceId):
+    self.id = deviceId
+    self.updates = []             #Commands for this camera, not acknowledged yet
+    self.lastSeen = None
+    self.timestamp = None
+    self.uptime = None
+    self.rssi = None
+    self.photos = 0
+    self.duplicates = 0
+
+  def report(self):
+    return {
+      "last_seen": (None if self.lastSeen is None else round(time.monotonic() - self.lastSeen, 1)),
+      "timestamp": self.timestamp,
+      "uptime": self.uptime,
+      "rssi": self.rssi,
+      "photos": self.photos,
+      "duplicates": self.duplicates,
+      "pending_updates": len(self.updates),
+    }
+
+
+class Gateway:
+  """Photo queue with deduplication and batching, command relay and device registry"""
+  def __init__(self, upstream, chatIds, devices=(), batchSize=10, batchDelay=5.0, queueSize=200, dedupWindow=3600, pollInterval=5.0):
+    self.upstream = upstream
+    self.stats = upstream.stats
+    self.chatIds = chatIds
+    self.batchSize = max(1, min(batchSize, TELEGRAM_MEDIA_GROUP_MAX))
+    self.batchDelay = batchDelay
+    self.queueSize = queueSize
+    self.dedupWindow = dedupWindow
+    self.pollInterval = pollInterval
+    self.lock = threading.Condition()
+    self.queue = collections.deque()
+    self.seen = collections.OrderedDict()   #(Hash, chat) of the photos queued or sent: time received
+    self.inFlight = 0
+    self.retryAt = 0
+    self.devices = collections.OrderedDict((deviceId, Device(deviceId)) for deviceId in devices)
+    self.pollLock = threading.Lock()
+    self.lastPoll = 0
+    self.offset = 0
+    threading.Thread(target=self._batcher, daemon=True).start()
+
+  def device(self, deviceId, headers=None):
+    """Device, registered on its first request; headers update its status"""
+    with self.lock:
+      device = self.devices.get(deviceId)
+      if device is None:
+        device = self.devices[deviceId] = Device(deviceId)
+        logging.info("new device %s", deviceId)
+      device.lastSeen = time.monotonic()
+      if headers is not None:
+        device.timestamp = headers.get("X-Device-Timestamp", device.timestamp)
+        device.uptime = headers.get("X-Device-Uptime", device.uptime)
+        device.rssi = headers.get("X-Device-RSSI", device.rssi)
+      return device
+
+  #Photos
+  def queuePhoto(self, device, data, caption, chatId):
+    """Queue a photo: "queued", "duplicate" (same content for the same chat within the deduplication window) or "full\""""
+    digest = hashlib.sha1(data).hexdigest()
+    with self.lock:
+      now = time.monotonic()
+      while self.seen and ((now - next(iter(self.seen.values()))) > self.dedupWindow):
+        self.seen.popitem(last=False)
+      if (digest, chatId) in self.seen:
+        device.duplicates += 1
+        self.stats.add("photos_duplicated")
+        return "duplicate"
+      if len(self.queue) >= self.queueSize:
+        self.stats.add("photos_rejected")
+        return "full"
+      self.seen[(digest, chatId)] = now
+      self.queue.append(Photo(device.id, data, caption, chatId, digest))
+      device.photos += 1
+      self.stats.add("photos_received")
+      self.lock.notify_all()
+      return "queued"
+
+  def _batchWait(self):
+    """Seconds before the next batch is due (None: queue empty)"""
+    if not self.queue:
+      return None
+    now = time.monotonic()
+    due = self.retryAt
+    if len(self.queue) < self.batchSize:
+      due = max(due, self.queue[0].received + self.batchDelay)
+    return max(0, due - now)
+
+  def _batcher(self):
+    while True:
+      with self.lock:
+        wait = self._batchWait()
+        while (wait is None) or (wait > 0):
+          self.lock.wait(wait)
+          wait = self._batchWait()
+        #Photos for the same recipients as the oldest one, in order
+        chatId = self.queue[0].chatId
+        batch = [photo for photo in self.queue if photo.chatId == chatId][:self.batchSize]
+        for photo in batch:
+          self.queue.remove(photo)
+        self.inFlight = len(batch)
+      requeue = self._sendBatch(batch)
+      with self.lock:
+        if requeue:
+          self.queue.extendleft(reversed(batch))
+          self.retryAt = time.monotonic() + self.upstream.backoff
+        self.inFlight = 0
+        self.lock.notify_all()
+
+  def _sendBatch(self, batch):
+    """Upload a batch to the first recipient, then forward it by file_id to the others; True to queue it again"""
+    chatIds = [batch[0].chatId] if batch[0].chatId is not None else self.chatIds
+    if len(batch) == 1:
+      body, contentType = multipart({"chat_id": chatIds[0], "caption": batch[0].caption}, [("photo", "photo.jpg", "image/jpeg", batch[0].data)])
+      status, result = self.upstream.request("sendPhoto", body, contentType)
+    else:
+      media = [{"type": "photo", "media": "attach://photo%d" % n, "caption": photo.caption} for n, photo in enumerate(batch)]
+      files = [("photo%d" % n, "photo%d.jpg" % n, "image/jpeg", photo.data) for n, photo in enumerate(batch)]
+      body, contentType = multipart({"chat_id": chatIds[0], "media": json.dumps(media)}, files)
+      status, result = self.upstream.request("sendMediaGroup", body, contentType)
+
+    if status == Upstream.SENT_NO_RESPONSE:
+      logging.warning("%d photos sent, response lost: not retried", len(batch))
+      self.stats.add("photos_unconfirmed", len(batch))
+      return False
+    if (status != 200) or not result.get("ok"):
+      logging.error("%d photos not sent (status %d: %s)", len(batch), status, (result or {}).get("description", "no response"))
+      if (status == Upstream.NOT_SENT) or (status == 429) or (status >= 500):
+        return True
+      self.stats.add("photos_failed", len(batch))
+      with self.lock:
+        for photo in batch:
+          self.seen.pop((photo.digest, photo.chatId), None)   #Not sent: the device can send it again
+      return False
+    self.stats.add("batches")
+    self.stats.add("photos_sent", len(batch))
+
+    #Forward by file_id (the largest size of each photo)
+    messages = result["result"] if isinstance(result["result"], list) else [result["result"]]
+    fileIds = [message["photo"][-1]["file_id"] for message in messages if message.get("photo")]
+    if len(fileIds) != len(batch):
+      return False
+    for chatId in chatIds[1:]:
+      if len(batch) == 1:
+        method, fields = "sendPhoto", {"chat_id": chatId, "photo": fileIds[0], "caption": batch[0].caption}
+      else:
+        media = [{"type": "photo", "media": fileId, "caption": photo.caption} for fileId, photo in zip(fileIds, batch)]
+        method, fields = "sendMediaGroup", {"chat_id": chatId, "media": json.dumps(media)}
+      status, result = self.upstream.request(method, urllib.parse.urlencode(fields), "application/x-www-form-urlencoded")
+      if (status == 200) and result.get("ok"):
+        self.stats.add("photos_forwarded", len(batch))
+      else:
+        logging.error("%d photos not forwarded to %s (status %d)", len(batch), chatId, status)
+    return False
+
+  #Commands
+  def _pollUpdates(self):
+    """Get the updates from telegram (at most once every pollInterval), and queue the commands for the cameras"""
+    with self.pollLock:
+      if (time.monotonic() - self.lastPoll) < self.pollInterval:
+        return
+      self.lastPoll = time.monotonic()
+      self.stats.add("polls")
+      status, result = self.upstream.request("getUpdates", urllib.parse.urlencode({"offset": self.offset}), "application/x-www-form-urlencoded", retry=False)
+      if (status != 200) or not result.get("ok"):
+        return
+      for update in result["result"]:
+        if update["update_id"] < self.offset:
+          continue
+        self.offset = update["update_id"] + 1
+        text = (update.get("message") or {}).get("text") or ""
+        if not text.startswith("/"):
+          continue
+        #Addressed to a camera (/command@DEVICE_ID), or to all of them (/command, /command@bot_name)
+        target = text.split()[0].partition("@")[2]
+        with self.lock:
+          devices = [self.devices[target]] if target in self.devices else list(self.devices.values())
+          for device in devices:
+            device.updates = (device.updates + [update])[-DEVICE_UPDATES_MAX:]
+        self.stats.add("commands")
+        self.stats.add("commands_relayed", len(devices))
+
+  def deviceUpdates(self, device, offset):
+    """Commands for a camera, in the telegram format; the ones before offset are acknowledged"""
+    self._pollUpdates()
+    with self.lock:
+      device.updates = [update for update in device.updates if update["update_id"] >= offset]
+      return list(device.updates)
+
+  def report(self):
+    with self.lock:
+      return {
+        "queue": len(self.queue),
+        "in_flight": self.inFlight,
+        "devices": {deviceId: device.report() for deviceId, device in self.devices.items()},
+        "stats": self.stats.report(),
+      }
+
+
+class Handler(http.server.BaseHTTPRequestHandler):
+  protocol_version = "HTTP/1.1"
+
+  def log_message(self, format, *args):
+    logging.debug("%s %s", self.address_string(), format % args)
+
+  def _respond(self, status, result):
+    body = json.dumps(result, separators=(",", ":")).encode()
+    self.send_response(status)
+    self.send_header("Content-Type", "application/json")
+    self.send_header("Content-Length", str(len(body)))
+    self.send_header("Connection", "close")
+    self.end_headers()
+    self.wfile.write(body)
+    self.close_connection = True
+
+  def _error(self, status, description, retryAfter=None):
+    result = {"ok": False, "error_code": status, "description": description}
+    if retryAfter is not None:
+      result["parameters"] = {"retry_after": retryAfter}
+    self._respond(status, result)
+
+  def do_GET(self):
+    if self.path == "/status":
+      self._respond(200, self.server.gateway.report())
+    else:
+      self._error(404, "Not Found")
+
+  def do_POST(self):
+    body = self.rfile.read(int(self.headers.get("Content-Length", 0)))
+    url = urllib.parse.urlsplit(self.path)
+    parts = url.path.split("/")
+    if (len(parts) != 4) or (parts[1] != "device") or (parts[2] == ""):
+      self._error(404, "Not Found")
+      return
+    gateway = self.server.gateway
+    device = gateway.device(parts[2], self.headers)
+    method = parts[3]
+    contentType = self.headers.get("Content-Type", "application/x-www-form-urlencoded")
+
+    if method == "photo":
+      query = urllib.parse.parse_qs(url.query)
+      if (contentType != "image/jpeg") or not body.startswith(b"\xff\xd8"):
+        self._error(400, "Bad Request: not a JPEG photo")
+        return
+      chatId = int(query["chat_id"][0]) if "chat_id" in query else None
+      status = gateway.queuePhoto(device, body, query.get("caption", [""])[0], chatId)
+      if status == "full":
+        self._error(429, "Too Many Requests: gateway queue full", max(1, int(gateway.batchDelay)))
+      else:
+        self._respond(200, {"ok": True, "result": {"status": status}})
+    elif method == "getUpdates":
+      offset = int(urllib.parse.parse_qs(body.decode(errors="replace")).get("offset", ["0"])[0])
+      self._respond(200, {"ok": True, "result": gateway.deviceUpdates(device, offset)})
+    elif method in ("sendMessage", "sendPhoto", "sendChatAction"):
+      #Relayed as is; the camera retries on its own, except when the response is lost (it may have been delivered)
+      gateway.stats.add("relayed")
+      status, result = gateway.upstream.request(method, body, contentType, retry=False)
+      if status == Upstream.NOT_SENT:
+        self._error(502, "Bad Gateway: telegram not reachable")
+      elif status == Upstream.SENT_NO_RESPONSE:
+        self._respond(200, {"ok": False, "error_code": 502, "description": "Bad Gateway: telegram response lost, not retried"})
+      else:
+        self._respond(status, result)
+    else:
+      self._error(404, "Not Found: unknown method " + method)
+
+
+class GatewayServer(http.server.ThreadingHTTPServer):
+  daemon_threads = True
+
+  def __init__(self, address, port, gateway):
+    super().__init__((address, port), Handler)
+    self.gateway = gateway
+
+
+def main():
+  parser = argparse.ArgumentParser(description="Wildlife Camera LAN gateway")
+  parser.add_argument("--listen", default="0.0.0.0", help="address to listen on")
+  parser.add_argument("--port", type=int, default=8080, help="port to listen on (GATEWAY_PORT of the cameras; 0: any free port)")
+  parser.add_argument("--token", default=os.environ.get("TELEGRAM_BOT_TOKEN", ""), help="telegram bot token (default: TELEGRAM_BOT_TOKEN)")
+  parser.add_argument("--chat-id", type=int, action="append", required=True, help="recipient of the photos, repeated for additional recipients")
+  parser.add_argument("--api", default="https://api.telegram.org", help="telegram Bot API URL")
+  parser.add_argument("--devices", default="", help="comma separated IDs of the cameras (others are added on their first request)")
+  parser.add_argument("--batch-size", type=int, default=TELEGRAM_MEDIA_GROUP_MAX, help="photos per batch (1 to 10)")
+  parser.add_argument("--batch-delay", type=float, default=5.0, help="seconds a photo waits for a batch to fill")
+  parser.add_argument("--queue-size", type=int, default=200, help="photos queued at most (then cameras are asked to retry)")
+  parser.add_argument("--dedup-window", type=int, default=3600, help="seconds a photo is remembered for deduplication")
+  parser.add_argument("--poll-interval", type=float, default=5.0, help="seconds between getUpdates requests to telegram")
+  parser.add_argument("--attempts", type=int, default=5, help="attempts of each upload to telegram")
+  parser.add_argument("--backoff", type=float, default=1.0, help="seconds of the first retry delay (doubled at each attempt)")
+  parser.add_argument("--verbose", action="store_true")
+  args = parser.parse_args()
+  if args.token == "":
+    parser.error("telegram bot token not set (--token or TELEGRAM_BOT_TOKEN)")
+
+  logging.basicConfig(stream=sys.stderr, level=(logging.DEBUG if args.verbose else logging.INFO), format="%(asctime)s %(levelname)s %(message)s")
+  upstream = Upstream(args.api, args.token, Stats(), args.attempts, args.backoff)
+  devices = [deviceId for deviceId in args.devices.split(",") if deviceId != ""]
+  gateway = Gateway(upstream, args.chat_id, devices, args.batch_size, args.batch_delay, args.queue_size, args.dedup_window, args.poll_interval)
+  server = GatewayServer(args.listen, args.port, gateway)
+  sys.stdout.write("port %d\n" % server.server_address[1])
+  sys.stdout.flush()
+  try:
+    server.serve_forever()
+  except KeyboardInterrupt:
+    pass
+
+
+if __name__ == "__main__":
+  main()
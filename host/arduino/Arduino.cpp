@@ -0,0 +1,343 @@
+/**
+ * @package Wildlife Camera
+ * Host build of the Arduino core subset used by the sketch modules
+ * @author WizLab.it
+ * @version 20261018.001
+ */
+
+#include "Arduino.h"
+#include "esp_heap_caps.h"
+#include <atomic>
+#include <chrono>
+#include <thread>
+#include <malloc.h>
+
+
+/**
+ * Variables
+ */
+HardwareSerial Serial;
+EspClass ESP;
+static unsigned long __hostAdvanced = 0;   //In microseconds, time added by hostAdvanceMillis()
+static const std::chrono::steady_clock::time_point __hostStart = std::chrono::steady_clock::now();
+
+
+/**
+ * Time
+ */
+unsigned long micros() {
+  return (unsigned long)std::chrono::duration_cast<std::chrono::microseconds>(std::chrono::steady_clock::now() - __hostStart).count() + __hostAdvanced;
+}
+
+unsigned long millis() {
+  return micros() / 1000;
+}
+
+void delay(unsigned long ms) {
+  std::this_thread::sleep_for(std::chrono::milliseconds(ms));
+}
+
+void hostAdvanceMillis(unsigned long ms) {
+  __hostAdvanced += ms * 1000;
+}
+
+
+/**
+ * Random numbers
+ */
+long random(long max) {
+  return (max > 0) ? (::random() % max) : 0;
+}
+
+long random(long min, long max) {
+  return (max > min) ? (min + random(max - min)) : min;
+}
+
+void randomSeed(unsigned long seed) {
+  srandom(seed);
+}
+
+
+/**
+ * GPIO (no hardware on the host)
+ */
+void pinMode(uint8_t pin, uint8_t mode) {}
+void digitalWrite(uint8_t pin, uint8_t value) {}
+int digitalRead(uint8_t pin) { return LOW; }
+void gpio_hold_en(gpio_num_t pin) {}
+void gpio_hold_dis(gpio_num_t pin) {}
+
+
+/**
+ * ESP-IDF and FreeRTOS
+ */
+esp_reset_reason_t esp_reset_reason() {
+  return 1; //ESP_RST_POWERON
+}
+
+BaseType_t xTaskCreatePinnedToCore(void (*task)(void *), const char* name, uint32_t stackSize, void *parameters, UBaseType_t priority, TaskHandle_t *handle, BaseType_t core) {
+  return pdFAIL;
+}
+
+void vTaskDelay(uint32_t ticks) {
+  delay(ticks);
+}
+
+
+/**
+ * Heap
+ * The C allocator is wrapped (C++ new and the standard containers go through it): counters are updated with the
+ * usable size of each block, as glibc reports it
+ */
+extern "C" {
+  void *__libc_malloc(size_t size);
+  void *__libc_calloc(size_t count, size_t size);
+  void *__libc_realloc(void *p, size_t size);
+  void *__libc_memalign(size_t alignment, size_t size);
+  void __libc_free(void *p);
+}
+
+static std::atomic<size_t> __hostHeapUsed(0);
+static std::atomic<size_t> __hostHeapPeak(0);
+static std::atomic<size_t> __hostHeapMax(0);   //Peak since start (or since the monitoring started), for ESP.getMinFreeHeap()
+static std::atomic<uint64_t> __hostHeapAllocations(0);
+static std::atomic<bool> __hostHeapMonitor(false);
+static size_t __hostHeapMaxSaved = 0;          //Peak since start, while monitoring
+
+static void __hostHeapRaise(std::atomic<size_t> &peak, size_t used) {
+  size_t current = peak.load(std::memory_order_relaxed);
+  while((used > current) && !peak.compare_exchange_weak(current, used, std::memory_order_relaxed));
+}
+
+static void *__hostHeapAdd(void *p) {
+  if(p == NULL) return p;
+  size_t used = __hostHeapUsed.fetch_add(malloc_usable_size(p), std::memory_order_relaxed) + malloc_usable_size(p);
+  __hostHeapAllocations.fetch_add(1, std::memory_order_relaxed);
+  __hostHeapRaise(__hostHeapPeak, used);
+  __hostHeapRaise(__hostHeapMax, used);
+  return p;
+}
+
+static void __hostHeapRemove(void *p) {
+  if(p != NULL) __hostHeapUsed.fetch_sub(malloc_usable_size(p), std::memory_order_relaxed);
+}
+
+extern "C" {
+  void *malloc(size_t size) { return __hostHeapAdd(__libc_malloc(size)); }
+  void *calloc(size_t count, size_t size) { return __hostHeapAdd(__libc_calloc(count, size)); }
+  void *memalign(size_t alignment, size_t size) { return __hostHeapAdd(__libc_memalign(alignment, size)); }
+  void *aligned_alloc(size_t alignment, size_t size) { return memalign(alignment, size); }
+
+  int posix_memalign(void **p, size_t alignment, size_t size) {
+    *p = memalign(alignment, size);
+    return (*p == NULL) ? 12 : 0; //ENOMEM
+  }
+
+  void *realloc(void *p, size_t size) {
+    __hostHeapRemove(p);
+    void *q = __libc_realloc(p, size);
+    if((q == NULL) && (p != NULL) && (size > 0)) {
+      __hostHeapUsed.fetch_add(malloc_usable_size(p), std::memory_order_relaxed); //Not moved, still allocated
+      return NULL;
+    }
+    return __hostHeapAdd(q);
+  }
+
+  void free(void *p) {
+    __hostHeapRemove(p);
+    __libc_free(p);
+  }
+}
+
+uint32_t EspClass::getFreeHeap() {
+  size_t used = __hostHeapUsed.load(std::memory_order_relaxed);
+  return (used < HOST_HEAP_SIZE) ? (HOST_HEAP_SIZE - used) : 0;
+}
+
+uint32_t EspClass::getMinFreeHeap() {
+  size_t used = __hostHeapMax.load(std::memory_order_relaxed);
+  return (used < HOST_HEAP_SIZE) ? (HOST_HEAP_SIZE - used) : 0;
+}
+
+size_t hostHeapGetUsed() {
+  return __hostHeapUsed.load(std::memory_order_relaxed);
+}
+
+size_t hostHeapGetPeak() {
+  return __hostHeapPeak.load(std::memory_order_relaxed);
+}
+
+uint64_t hostHeapGetAllocations() {
+  return __hostHeapAllocations.load(std::memory_order_relaxed);
+}
+
+void hostHeapResetPeak() {
+  __hostHeapPeak.store(__hostHeapUsed.load(std::memory_order_relaxed), std::memory_order_relaxed);
+}
+
+esp_err_t heap_caps_monitor_local_minimum_free_size_start() {
+  if(__hostHeapMonitor.exchange(true)) return ESP_FAIL;
+  __hostHeapMaxSaved = __hostHeapMax.load(std::memory_order_relaxed);
+  __hostHeapMax.store(__hostHeapUsed.load(std::memory_order_relaxed), std::memory_order_relaxed);
+  return ESP_OK;
+}
+
+esp_err_t heap_caps_monitor_local_minimum_free_size_stop() {
+  if(!__hostHeapMonitor.exchange(false)) return ESP_FAIL;
+  __hostHeapRaise(__hostHeapMax, __hostHeapMaxSaved);
+  return ESP_OK;
+}
+
+
+/**
+ * String
+ */
+static std::string __hostToString(unsigned long long value, bool negative, unsigned char base) {
+  char buffer[72];
+  int i = sizeof(buffer) - 1;
+  buffer[i] = '\0';
+  do {
+    uint8_t digit = value % base;
+    buffer[--i] = (digit < 10) ? ('0' + digit) : ('a' + digit - 10);
+    value /= base;
+  } while(value > 0);
+  if(negative) buffer[--i] = '-';
+  return std::string(buffer + i);
+}
+
+String::String(unsigned char value, unsigned char base) : _s(__hostToString(value, false, base)) {}
+String::String(int value, unsigned char base) : String((long long)value, base) {}
+String::String(unsigned int value, unsigned char base) : _s(__hostToString(value, false, base)) {}
+String::String(long value, unsigned char base) : String((long long)value, base) {}
+String::String(unsigned long value, unsigned char base) : _s(__hostToString(value, false, base)) {}
+String::String(long long value, unsigned char base) : _s(((value < 0) && (base == 10)) ? __hostToString(-(unsigned long long)value, true, base) : __hostToString(value, false, base)) {}
+String::String(unsigned long long value, unsigned char base) : _s(__hostToString(value, false, base)) {}
+String::String(float value, unsigned int decimalPlaces) : String((double)value, decimalPlaces) {}
+
+String::String(double value, unsigned int decimalPlaces) {
+  char buffer[64];
+  snprintf(buffer, sizeof(buffer), "%.*f", decimalPlaces, value);
+  _s = buffer;
+}
+
+bool String::equalsIgnoreCase(const String &s) const {
+  return (_s.length() == s._s.length()) && (strncasecmp(_s.c_str(), s._s.c_str(), _s.length()) == 0);
+}
+
+bool String::endsWith(const String &suffix) const {
+  return (_s.length() >= suffix._s.length()) && (_s.compare(_s.length() - suffix._s.length(), suffix._s.length(), suffix._s) == 0);
+}
+
+int String::indexOf(char c, unsigned int from) const {
+  size_t position = _s.find(c, from);
+  return (position == std::string::npos) ? -1 : (int)position;
+}
+
+int String::indexOf(const String &s, unsigned int from) const {
+  size_t position = _s.find(s._s, from);
+  return (position == std::string::npos) ? -1 : (int)position;
+}
+
+int String::lastIndexOf(char c) const {
+  size_t position = _s.rfind(c);
+  return (position == std::string::npos) ? -1 : (int)position;
+}
+
+String String::substring(unsigned int from, unsigned int to) const {
+  if(from > to) std::swap(from, to);
+  if(from >= _s.length()) return String();
+  return String(_s.substr(from, to - from));
+}
+
+void String::trim() {
+  size_t start = _s.find_first_not_of(" \t\r\n");
+  if(start == std::string::npos) {
+    _s.clear();
+    return;
+  }
+  _s = _s.substr(start, _s.find_last_not_of(" \t\r\n") - start + 1);
+}
+
+void String::toLowerCase() {
+  for(char &c : _s) c = tolower(c);
+}
+
+void String::toCharArray(char *buffer, unsigned int size) const {
+  if(size == 0) return;
+  size_t length = std::min((size_t)(size - 1), _s.length());
+  memcpy(buffer, _s.c_str(), length);
+  buffer[length] = '\0';
+}
+
+String operator+(const String &a, const String &b) { return String(a.str() + b.str()); }
+String operator+(const String &a, const char* b) { return String(a.str() + b); }
+String operator+(const char* a, const String &b) { return String(a + b.str()); }
+String operator+(const String &a, char b) { return String(a.str() + b); }
+bool operator==(const String &a, const String &b) { return a.str() == b.str(); }
+bool operator==(const String &a, const char* b) { return a.str() == b; }
+bool operator==(const char* a, const String &b) { return b.str() == a; }
+bool operator!=(const String &a, const String &b) { return !(a == b); }
+bool operator!=(const String &a, const char* b) { return !(a == b); }
+bool operator!=(const char* a, const String &b) { return !(a == b); }
+
+
+/**
+ * Print and Stream
+ */
+size_t Print::write(const uint8_t *buffer, size_t size) {
+  size_t n = 0;
+  while((n < size) && (write(buffer[n]) == 1)) n++;
+  return n;
+}
+
+size_t Print::printf(const char* format, ...) {
+  char buffer[512];
+  va_list args;
+  va_start(args, format);
+  int length = vsnprintf(buffer, sizeof(buffer), format, args);
+  va_end(args);
+  if(length < 0) return 0;
+  return write((const uint8_t *)buffer, std::min((size_t)length, sizeof(buffer) - 1));
+}
+
+int Stream::_timedRead() {
+  unsigned long start = millis();
+  do {
+    int c = read();
+    if(c >= 0) return c;
+    delay(1);
+  } while((millis() - start) < _timeout);
+  return -1;
+}
+
+String Stream::readStringUntil(char terminator) {
+  String s;
+  int c = _timedRead();
+  while((c >= 0) && (c != terminator)) {
+    s += (char)c;
+    c = _timedRead();
+  }
+  return s;
+}
+
+size_t Stream::readBytes(uint8_t *buffer, size_t length) {
+  size_t n = 0;
+  while(n < length) {
+    int c = _timedRead();
+    if(c < 0) break;
+    buffer[n++] = (uint8_t)c;
+  }
+  return n;
+}
+
+
+/**
+ * Serial
+ */
+size_t HardwareSerial::write(uint8_t c) {
+  return fwrite(&c, 1, 1, stdout);
+}
+
+size_t HardwareSerial::write(const uint8_t *buffer, size_t size) {
+  return fwrite(buffer, 1, size, stdout);
+}
@@ -0,0 +1,230 @@
+/**
+ * @package Wildlife Camera
+ * Host build of the Arduino core subset used by the sketch modules header
+ * @author WizLab.it
+ * @version 20261018.001
+ */
+
+#ifndef ARDUINO_H
+#define ARDUINO_H
+
+
+/**
+ * Includes
+ */
+#include <stdint.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stdio.h>
+#include <stdarg.h>
+#include <math.h>
+#include <time.h>
+#include <string>
+#include <algorithm>
+
+
+/**
+ * Defines
+ */
+#define RTC_DATA_ATTR
+#define RTC_NOINIT_ATTR
+#define IRAM_ATTR
+
+#define LOW     0x0
+#define HIGH    0x1
+#define INPUT   0x01
+#define OUTPUT  0x03
+
+#define ESP_OK    0
+#define ESP_FAIL  -1
+
+#define HOST_HEAP_SIZE  (4 * 1024 * 1024)   //Nominal heap size, ESP.getFreeHeap() is this minus the bytes allocated
+
+using std::min;
+using std::max;
+
+
+/**
+ * Time, random numbers and GPIO
+ * millis() and micros() follow the host clock plus the time added by hostAdvanceMillis(), so tests can simulate
+ * long operations without waiting for them
+ */
+unsigned long millis();
+unsigned long micros();
+void delay(unsigned long ms);
+void hostAdvanceMillis(unsigned long ms);
+long random(long max);
+long random(long min, long max);
+void randomSeed(unsigned long seed);
+void pinMode(uint8_t pin, uint8_t mode);
+void digitalWrite(uint8_t pin, uint8_t value);
+int digitalRead(uint8_t pin);
+
+
+/**
+ * ESP-IDF and FreeRTOS subset
+ * Tasks can't be created on the host, so modules fall back to their synchronous path
+ */
+typedef int esp_err_t;
+typedef int esp_reset_reason_t;
+typedef void* TaskHandle_t;
+typedef int BaseType_t;
+typedef unsigned int UBaseType_t;
+
+typedef enum {
+  GPIO_NUM_4 = 4,
+  GPIO_NUM_12 = 12,
+  GPIO_NUM_13 = 13,
+  GPIO_NUM_33 = 33
+} gpio_num_t;
+
+#define pdPASS              1
+#define pdFAIL              0
+#define pdMS_TO_TICKS(ms)   (ms)
+#define tskIDLE_PRIORITY    0
+
+void gpio_hold_en(gpio_num_t pin);
+void gpio_hold_dis(gpio_num_t pin);
+esp_reset_reason_t esp_reset_reason();
+BaseType_t xTaskCreatePinnedToCore(void (*task)(void *), const char* name, uint32_t stackSize, void *parameters, UBaseType_t priority, TaskHandle_t *handle, BaseType_t core);
+void vTaskDelay(uint32_t ticks);
+
+
+/**
+ * Heap
+ * Every allocation of the process is counted: ESP.getFreeHeap() and ESP.getMinFreeHeap() behave as on the board
+ * (there's no PSRAM: all allocations are internal heap), hostHeapGetPeak() is the peak of allocated bytes since the last hostHeapResetPeak(), to measure a single operation
+ */
+class EspClass {
+  public:
+    uint32_t getFreeHeap();
+    uint32_t getMinFreeHeap();
+    uint32_t getFreePsram() { return 0; }
+    uint32_t getMinFreePsram() { return 0; }
+    uint32_t getHeapSize() { return HOST_HEAP_SIZE; }
+    uint64_t getEfuseMac() { return 0x0000AABBCCDDEEFFULL; }
+};
+
+extern EspClass ESP;
+
+size_t hostHeapGetUsed();
+size_t hostHeapGetPeak();
+uint64_t hostHeapGetAllocations();
+void hostHeapResetPeak();
+
+
+/**
+ * String
+ * Arduino String on top of std::string
+ */
+class String {
+  private:
+    std::string _s;
+
+  public:
+    String(const char* s = "") : _s((s == NULL) ? "" : s) {}
+    String(const std::string &s) : _s(s) {}
+    String(char c) : _s(1, c) {}
+    String(unsigned char value, unsigned char base = 10);
+    String(int value, unsigned char base = 10);
+    String(unsigned int value, unsigned char base = 10);
+    String(long value, unsigned char base = 10);
+    String(unsigned long value, unsigned char base = 10);
+    String(long long value, unsigned char base = 10);
+    String(unsigned long long value, unsigned char base = 10);
+    String(float value, unsigned int decimalPlaces = 2);
+    String(double value, unsigned int decimalPlaces = 2);
+
+    unsigned int length() const { return _s.length(); }
+    const char* c_str() const { return _s.c_str(); }
+    bool reserve(unsigned int size) { _s.reserve(size); return true; }
+    bool isEmpty() const { return _s.empty(); }
+    bool concat(const char* s, unsigned int length) { _s.append(s, length); return true; }
+    bool concat(const String &s) { _s += s._s; return true; }
+    bool concat(const char* s) { if(s != NULL) _s += s; return true; }
+    bool concat(char c) { _s += c; return true; }
+    String &operator+=(const String &s) { concat(s); return *this; }
+    String &operator+=(const char* s) { concat(s); return *this; }
+    String &operator+=(char c) { concat(c); return *this; }
+    char operator[](unsigned int index) const { return (index < _s.length()) ? _s[index] : 0; }
+    char charAt(unsigned int index) const { return (*this)[index]; }
+    bool equals(const String &s) const { return _s == s._s; }
+    bool equalsIgnoreCase(const String &s) const;
+    bool startsWith(const String &prefix) const { return _s.compare(0, prefix._s.length(), prefix._s) == 0; }
+    bool endsWith(const String &suffix) const;
+    int indexOf(char c, unsigned int from = 0) const;
+    int indexOf(const String &s, unsigned int from = 0) const;
+    int lastIndexOf(char c) const;
+    String substring(unsigned int from, unsigned int to = (unsigned int)-1) const;
+    void trim();
+    void toLowerCase();
+    long toInt() const { return atol(_s.c_str()); }
+    float toFloat() const { return atof(_s.c_str()); }
+    void toCharArray(char *buffer, unsigned int size) const;
+    const std::string &str() const { return _s; }
+};
+
+String operator+(const String &a, const String &b);
+String operator+(const String &a, const char* b);
+String operator+(const char* a, const String &b);
+String operator+(const String &a, char b);
+bool operator==(const String &a, const String &b);
+bool operator==(const String &a, const char* b);
+bool operator==(const char* a, const String &b);
+bool operator!=(const String &a, const String &b);
+bool operator!=(const String &a, const char* b);
+bool operator!=(const char* a, const String &b);
+
+
+/**
+ * Print and Stream
+ */
+class Print {
+  public:
+    virtual ~Print() {}
+    virtual size_t write(uint8_t c) = 0;
+    virtual size_t write(const uint8_t *buffer, size_t size);
+    size_t write(const char* s) { return write((const uint8_t *)s, strlen(s)); }
+    size_t print(const String &s) { return write((const uint8_t *)s.c_str(), s.length()); }
+    size_t print(const char* s) { return write(s); }
+    size_t println(const String &s) { return print(s) + print("\r\n"); }
+    size_t println(const char* s) { return print(s) + print("\r\n"); }
+    size_t println() { return print("\r\n"); }
+    size_t printf(const char* format, ...) __attribute__((format(printf, 2, 3)));
+    virtual void flush() {}
+};
+
+class Stream : public Print {
+  protected:
+    unsigned long _timeout = 1000;
+    int _timedRead();
+
+  public:
+    virtual int available() = 0;
+    virtual int read() = 0;
+    virtual int peek() = 0;
+    void setTimeout(unsigned long timeout) { _timeout = timeout; }
+    String readStringUntil(char terminator);
+    size_t readBytes(uint8_t *buffer, size_t length);
+};
+
+
+/**
+ * Serial (standard output)
+ */
+class HardwareSerial : public Stream {
+  public:
+    void begin(unsigned long baud) {}
+    size_t write(uint8_t c) override;
+    size_t write(const uint8_t *buffer, size_t size) override;
+    using Print::write;
+    int available() override { return 0; }
+    int read() override { return -1; }
+    int peek() override { return -1; }
+    void flush() override { fflush(stdout); }
+};
+
+extern HardwareSerial Serial;
+
+
+#endif
@@ -0,0 +1,48 @@
+/**
+ * @package Wildlife Camera
+ * Host build of the CRC32 library header (same polynomial and API as the Arduino library)
+ * @author WizLab.it
+ * @version 20261018.001
+ */
+
+#ifndef CRC32_H
+#define CRC32_H
+
+
+/**
+ * Includes
+ */
+#include <Arduino.h>
+
+
+/**
+ * CRC32
+ */
+class CRC32 {
+  private:
+    uint32_t _state = ~0L;
+
+  public:
+    void reset() { _state = ~0L; }
+
+    void update(const uint8_t &data) {
+      _state ^= data;
+      for(uint8_t i=0; i<8; i++) _state = (_state >> 1) ^ ((_state & 1) ? 0xEDB88320 : 0);
+    }
+
+    template <typename Type> void update(const Type *data, size_t size) {
+      const uint8_t *bytes = (const uint8_t *)data;
+      for(size_t i=0; i<(size * sizeof(Type)); i++) update(bytes[i]);
+    }
+
+    uint32_t finalize() const { return ~_state; }
+
+    template <typename Type> static uint32_t calculate(const Type *data, size_t size) {
+      CRC32 crc;
+      crc.update(data, size);
+      return crc.finalize();
+    }
+};
+
+
+#endif
@@ -0,0 +1,132 @@
+/**
+ * @package Wildlife Camera
+ * Host build of the Arduino file system API
+ * @author WizLab.it
+ * @version 20261018.001
+ */
+
+#include "FS.h"
+#include <dirent.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+using namespace fs;
+
+
+/**
+ * HostFileImpl
+ * File or directory of the host file system
+ */
+class HostFileImpl : public FileImpl {
+  private:
+    std::string _root;
+    std::string _path;   //Path relative to the file system root
+    FILE *_file;
+    DIR *_dir;
+
+  public:
+    HostFileImpl(const std::string &root, const std::string &path, const char* mode) : _root(root), _path(path), _file(NULL), _dir(NULL) {
+      std::string hostPath = _root + _path;
+      struct stat st;
+      if((stat(hostPath.c_str(), &st) == 0) && S_ISDIR(st.st_mode)) {
+        _dir = opendir(hostPath.c_str());
+      } else {
+        _file = fopen(hostPath.c_str(), (strcmp(mode, FILE_WRITE) == 0) ? "w+b" : ((strcmp(mode, FILE_APPEND) == 0) ? "a+b" : "rb"));
+      }
+    }
+
+    ~HostFileImpl() { close(); }
+
+    size_t write(const uint8_t *buffer, size_t size) override { return (_file != NULL) ? fwrite(buffer, 1, size, _file) : 0; }
+    size_t read(uint8_t *buffer, size_t size) override { return (_file != NULL) ? fread(buffer, 1, size, _file) : 0; }
+    void flush() override { if(_file != NULL) fflush(_file); }
+
+    bool seek(uint32_t position, SeekMode mode) override {
+      return (_file != NULL) && (fseek(_file, position, (mode == SeekSet) ? SEEK_SET : ((mode == SeekCur) ? SEEK_CUR : SEEK_END)) == 0);
+    }
+
+    size_t position() const override { return (_file != NULL) ? ftell(_file) : 0; }
+
+    size_t size() const override {
+      if(_file == NULL) return 0;
+      fflush(_file);
+      struct stat st;
+      return (fstat(fileno(_file), &st) == 0) ? st.st_size : 0;
+    }
+
+    void close() override {
+      if(_file != NULL) fclose(_file);
+      if(_dir != NULL) closedir(_dir);
+      _file = NULL;
+      _dir = NULL;
+    }
+
+    time_t getLastWrite() override {
+      struct stat st;
+      return (stat((_root + _path).c_str(), &st) == 0) ? st.st_mtime : 0;
+    }
+
+    const char* path() const override { return _path.c_str(); }
+    const char* name() const override { return _path.c_str() + _path.rfind('/') + 1; }
+    bool isDirectory() override { return (_dir != NULL); }
+
+    FileImplPtr openNextFile(const char* mode) override {
+      if(_dir == NULL) return FileImplPtr();
+      struct dirent *entry;
+      while((entry = readdir(_dir)) != NULL) {
+        if((strcmp(entry->d_name, ".") == 0) || (strcmp(entry->d_name, "..") == 0)) continue;
+        return std::make_shared<HostFileImpl>(_root, (_path == "/") ? ("/" + std::string(entry->d_name)) : (_path + "/" + entry->d_name), mode);
+      }
+      return FileImplPtr();
+    }
+
+    void rewindDirectory() override { if(_dir != NULL) rewinddir(_dir); }
+    operator bool() override { return (_file != NULL) || (_dir != NULL); }
+};
+
+
+/**
+ * FS
+ */
+File FS::open(const char* path, const char* mode, const bool create) {
+  FileImplPtr file = std::make_shared<HostFileImpl>(_root, path, mode);
+  return *file ? File(file) : File();
+}
+
+bool FS::exists(const char* path) {
+  struct stat st;
+  return stat((_root + path).c_str(), &st) == 0;
+}
+
+bool FS::remove(const char* path) {
+  return unlink((_root + path).c_str()) == 0;
+}
+
+bool FS::mkdir(const char* path) {
+  return (::mkdir((_root + path).c_str(), 0755) == 0) || exists(path);
+}
+
+bool FS::rmdir(const char* path) {
+  return ::rmdir((_root + path).c_str()) == 0;
+}
+
+bool FS::rename(const char* pathFrom, const char* pathTo) {
+  return ::rename((_root + pathFrom).c_str(), (_root + pathTo).c_str()) == 0;
+}
+
+
+/**
+ * File
+ */
+int File::read() {
+  uint8_t c;
+  return (read(&c, 1) == 1) ? c : -1;
+}
+
+int File::peek() {
+  if(!_p) return -1;
+  size_t position = _p->position();
+  int c = read();
+  _p->seek(position, SeekSet);
+  return c;
+}
@@ -0,0 +1,129 @@
+/**
+ * @package Wildlife Camera
+ * Host build of the Arduino file system API header
+ * Files are backed by a host directory, the root of the file system
+ * @author WizLab.it
+ * @version 20261018.001
+ */
+
+#ifndef FS_H
+#define FS_H
+
+
+/**
+ * Includes
+ */
+#include <Arduino.h>
+#include <memory>
+
+
+/**
+ * Defines
+ */
+#define FILE_READ   "r"
+#define FILE_WRITE  "w"
+#define FILE_APPEND "a"
+
+
+namespace fs {
+
+enum SeekMode {
+  SeekSet = 0,
+  SeekCur = 1,
+  SeekEnd = 2
+};
+
+
+/**
+ * FileImpl
+ * File or directory implementation, as in the Arduino core (tests can provide their own)
+ */
+class FileImpl;
+typedef std::shared_ptr<FileImpl> FileImplPtr;
+
+class FileImpl {
+  public:
+    virtual ~FileImpl() {}
+    virtual size_t write(const uint8_t *buffer, size_t size) = 0;
+    virtual size_t read(uint8_t *buffer, size_t size) = 0;
+    virtual void flush() {}
+    virtual bool seek(uint32_t position, SeekMode mode) = 0;
+    virtual size_t position() const = 0;
+    virtual size_t size() const = 0;
+    virtual void close() = 0;
+    virtual time_t getLastWrite() { return 0; }
+    virtual const char* path() const = 0;
+    virtual const char* name() const = 0;
+    virtual bool isDirectory() { return false; }
+    virtual FileImplPtr openNextFile(const char* mode) { return FileImplPtr(); }
+    virtual void rewindDirectory() {}
+    virtual operator bool() = 0;
+};
+
+
+/**
+ * File
+ */
+class File : public Stream {
+  private:
+    FileImplPtr _p;
+
+  public:
+    File(FileImplPtr p = FileImplPtr()) : _p(p) {}
+    size_t write(uint8_t c) override { return write(&c, 1); }
+    size_t write(const uint8_t *buffer, size_t size) override { return _p ? _p->write(buffer, size) : 0; }
+    using Print::write;
+    int available() override { return _p ? (int)(_p->size() - _p->position()) : 0; }
+    int read() override;
+    int peek() override;
+    size_t read(uint8_t *buffer, size_t size) { return _p ? _p->read(buffer, size) : 0; }
+    void flush() override { if(_p) _p->flush(); }
+    bool seek(uint32_t position, SeekMode mode = SeekSet) { return _p ? _p->seek(position, mode) : false; }
+    size_t position() const { return _p ? _p->position() : 0; }
+    size_t size() const { return _p ? _p->size() : 0; }
+    void close() { if(_p) _p->close(); _p.reset(); }
+    operator bool() const { return _p && (bool)*_p; }
+    time_t getLastWrite() { return _p ? _p->getLastWrite() : 0; }
+    const char* path() const { return _p ? _p->path() : ""; }
+    const char* name() const { return _p ? _p->name() : ""; }
+    bool isDirectory() { return _p && _p->isDirectory(); }
+    File openNextFile(const char* mode = FILE_READ) { return _p ? File(_p->openNextFile(mode)) : File(); }
+    void rewindDirectory() { if(_p) _p->rewindDirectory(); }
+};
+
+
+/**
+ * FS
+ * File system whose root is a host directory
+ */
+class FS {
+  protected:
+    std::string _root;
+
+  public:
+    FS(const char* root = ".") : _root(root) {}
+    void setRoot(const char* root) { _root = root; }
+    const char* getRoot() { return _root.c_str(); }
+    File open(const char* path, const char* mode = FILE_READ, const bool create = false);
+    File open(const String &path, const char* mode = FILE_READ, const bool create = false) { return open(path.c_str(), mode, create); }
+    bool exists(const char* path);
+    bool exists(const String &path) { return exists(path.c_str()); }
+    bool remove(const char* path);
+    bool remove(const String &path) { return remove(path.c_str()); }
+    bool mkdir(const char* path);
+    bool mkdir(const String &path) { return mkdir(path.c_str()); }
+    bool rmdir(const char* path);
+    bool rename(const char* pathFrom, const char* pathTo);
+};
+
+}
+
+using fs::FS;
+using fs::File;
+using fs::SeekMode;
+using fs::SeekSet;
+using fs::SeekCur;
+using fs::SeekEnd;
+
+
+#endif
@@ -0,0 +1,48 @@
+/**
+ * @package Wildlife Camera
+ * Host build of the SD_MMC file system
+ * @author WizLab.it
+ * @version 20261018.001
+ */
+
+#include "SD_MMC.h"
+#include <sys/stat.h>
+#include <sys/statvfs.h>
+
+
+/**
+ * Variables
+ */
+SDMMCFS SD_MMC;
+
+
+/**
+ * SDMMCFS
+ */
+SDMMCFS::SDMMCFS() : fs::FS((getenv("SD_MMC_ROOT") != NULL) ? getenv("SD_MMC_ROOT") : "/tmp/wildlife-sdcard") {}
+
+bool SDMMCFS::begin(const char* mountpoint, bool mode1bit, bool formatIfMountFailed) {
+  struct stat st;
+  if((stat(_root.c_str(), &st) != 0) || !S_ISDIR(st.st_mode)) return false;
+  if(!_mounted) _mounts++;
+  _mounted = true;
+  return true;
+}
+
+void SDMMCFS::end() {
+  _mounted = false;
+}
+
+sdcard_type_t SDMMCFS::cardType() {
+  return _mounted ? CARD_SDHC : CARD_NONE;
+}
+
+uint64_t SDMMCFS::totalBytes() {
+  struct statvfs st;
+  return (statvfs(_root.c_str(), &st) == 0) ? ((uint64_t)st.f_blocks * st.f_frsize) : 0;
+}
+
+uint64_t SDMMCFS::usedBytes() {
+  struct statvfs st;
+  return (statvfs(_root.c_str(), &st) == 0) ? ((uint64_t)(st.f_blocks - st.f_bfree) * st.f_frsize) : 0;
+}
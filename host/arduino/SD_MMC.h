@@ -0,0 +1,54 @@
+/**
+ * @package Wildlife Camera
+ * Host build of the SD_MMC file system header
+ * The card is a host directory, set with setRoot() or with the SD_MMC_ROOT environment variable
+ * @author WizLab.it
+ * @version 20261018.001
+ */
+
+#ifndef SD_MMC_H
+#define SD_MMC_H
+
+
+/**
+ * Includes
+ */
+#include "FS.h"
+
+
+/**
+ * Defines
+ */
+typedef enum {
+  CARD_NONE,
+  CARD_MMC,
+  CARD_SD,
+  CARD_SDHC,
+  CARD_UNKNOWN
+} sdcard_type_t;
+
+
+/**
+ * SDMMCFS
+ * Mounts are counted, so tests can check when the card is held
+ */
+class SDMMCFS : public fs::FS {
+  private:
+    bool _mounted = false;
+    uint32_t _mounts = 0;
+
+  public:
+    SDMMCFS();
+    bool begin(const char* mountpoint = "/sdcard", bool mode1bit = false, bool formatIfMountFailed = false);
+    void end();
+    sdcard_type_t cardType();
+    uint64_t totalBytes();
+    uint64_t usedBytes();
+    bool hostIsMounted() { return _mounted; }
+    uint32_t hostGetMounts() { return _mounts; }
+};
+
+extern SDMMCFS SD_MMC;
+
+
+#endif
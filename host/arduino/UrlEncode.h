@@ -0,0 +1,43 @@
+/**
+ * @package Wildlife Camera
+ * Host build of the UrlEncode library header
+ * @author WizLab.it
+ * @version 20261018.001
+ */
+
+#ifndef URLENCODE_H
+#define URLENCODE_H
+
+
+/**
+ * Includes
+ */
+#include <Arduino.h>
+
+
+/**
+ * urlEncode
+ * Percent-encode everything but unreserved characters
+ */
+static inline String urlEncode(const char* message) {
+  static const char hex[] = "0123456789ABCDEF";
+  String encoded;
+  encoded.reserve(strlen(message) * 3);
+  for(const char* c=message; *c != '\0'; c++) {
+    if(isalnum((unsigned char)*c) || (*c == '-') || (*c == '_') || (*c == '.') || (*c == '~')) {
+      encoded += *c;
+    } else {
+      encoded += '%';
+      encoded += hex[((unsigned char)*c) >> 4];
+      encoded += hex[((unsigned char)*c) & 0x0F];
+    }
+  }
+  return encoded;
+}
+
+static inline String urlEncode(String message) {
+  return urlEncode(message.c_str());
+}
+
+
+#endif
@@ -0,0 +1,168 @@
+/**
+ * @package Wildlife Camera
+ * Host build of the WiFi library
+ * @author WizLab.it
+ * @version 20261018.001
+ */
+
+#include "WiFi.h"
+#include "WiFiClientSecure.h"
+#include <arpa/inet.h>
+#include <netdb.h>
+#include <netinet/in.h>
+#include <netinet/tcp.h>
+#include <sys/ioctl.h>
+#include <sys/socket.h>
+#include <errno.h>
+#include <fcntl.h>
+#include <unistd.h>
+
+
+/**
+ * Variables
+ */
+WiFiClass WiFi;
+uint32_t WiFiClientSecure::_instances = 0;
+static uint16_t __hostWiFiServerPort = 0;
+
+
+/**
+ * IPAddress
+ */
+String IPAddress::toString() const {
+  char buffer[16];
+  snprintf(buffer, sizeof(buffer), "%u.%u.%u.%u", _address[0], _address[1], _address[2], _address[3]);
+  return String(buffer);
+}
+
+
+/**
+ * WiFiClient
+ */
+static void __hostCloseSocket(int *socket) {
+  if(*socket >= 0) close(*socket);
+  delete socket;
+}
+
+WiFiClient::WiFiClient(int socket) : _socket(new int(socket), __hostCloseSocket) {}
+
+int WiFiClient::connect(const char* host, uint16_t port) {
+  stop();
+  struct addrinfo hints = {}, *result;
+  hints.ai_family = AF_INET;
+  hints.ai_socktype = SOCK_STREAM;
+  if(getaddrinfo(host, String(port).c_str(), &hints, &result) != 0) return 0;
+  int s = socket(AF_INET, SOCK_STREAM, 0);
+  if((s >= 0) && (::connect(s, result->ai_addr, result->ai_addrlen) != 0)) {
+    close(s);
+    s = -1;
+  }
+  freeaddrinfo(result);
+  if(s < 0) return 0;
+  _socket = std::shared_ptr<int>(new int(s), __hostCloseSocket);
+  return 1;
+}
+
+size_t WiFiClient::write(const uint8_t *buffer, size_t size) {
+  if(!_socket || (*_socket < 0)) return 0;
+  size_t n = 0;
+  while(n < size) {
+    ssize_t wb = send(*_socket, buffer + n, size - n, MSG_NOSIGNAL);
+    if(wb <= 0) break;
+    n += wb;
+  }
+  return n;
+}
+
+int WiFiClient::available() {
+  if(!_socket || (*_socket < 0)) return 0;
+  int pending = 0;
+  if(ioctl(*_socket, FIONREAD, &pending) != 0) pending = 0;
+  return pending + ((_peeked >= 0) ? 1 : 0);
+}
+
+int WiFiClient::read() {
+  uint8_t c;
+  return (read(&c, 1) == 1) ? c : -1;
+}
+
+int WiFiClient::read(uint8_t *buffer, size_t size) {
+  if((size == 0) || !_socket || (*_socket < 0)) return -1;
+  size_t n = 0;
+  if(_peeked >= 0) {
+    buffer[n++] = (uint8_t)_peeked;
+    _peeked = -1;
+  }
+  ssize_t rb = recv(*_socket, buffer + n, size - n, MSG_DONTWAIT);
+  if(rb > 0) n += rb;
+  return (n > 0) ? (int)n : -1;
+}
+
+int WiFiClient::peek() {
+  if(_peeked < 0) {
+    uint8_t c;
+    if(_socket && (*_socket >= 0) && (recv(*_socket, &c, 1, MSG_DONTWAIT) == 1)) _peeked = c;
+  }
+  return _peeked;
+}
+
+uint8_t WiFiClient::connected() {
+  if(!_socket || (*_socket < 0)) return 0;
+  if(_peeked >= 0) return 1;
+  uint8_t c;
+  ssize_t rb = recv(*_socket, &c, 1, MSG_PEEK | MSG_DONTWAIT);
+  return (rb > 0) || ((rb < 0) && ((errno == EAGAIN) || (errno == EWOULDBLOCK)));
+}
+
+void WiFiClient::stop() {
+  if(_socket && (*_socket >= 0)) {
+    shutdown(*_socket, SHUT_RDWR);
+    close(*_socket);
+    *_socket = -1;
+  }
+  _socket.reset();
+  _peeked = -1;
+}
+
+void WiFiClient::setNoDelay(bool noDelay) {
+  int value = noDelay ? 1 : 0;
+  if(_socket && (*_socket >= 0)) setsockopt(*_socket, IPPROTO_TCP, TCP_NODELAY, &value, sizeof(value));
+}
+
+
+/**
+ * WiFiServer
+ */
+void WiFiServer::begin() {
+  if(_socket >= 0) return;
+  uint16_t port = (getenv("HOST_WIFISERVER_PORT") != NULL) ? atoi(getenv("HOST_WIFISERVER_PORT")) : _port;
+  _socket = socket(AF_INET, SOCK_STREAM, 0);
+  int value = 1;
+  setsockopt(_socket, SOL_SOCKET, SO_REUSEADDR, &value, sizeof(value));
+  struct sockaddr_in address = {};
+  address.sin_family = AF_INET;
+  address.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+  address.sin_port = htons(port);
+  socklen_t length = sizeof(address);
+  if((bind(_socket, (struct sockaddr *)&address, sizeof(address)) != 0) || (listen(_socket, 8) != 0) || (getsockname(_socket, (struct sockaddr *)&address, &length) != 0)) {
+    end();
+    return;
+  }
+  fcntl(_socket, F_SETFL, O_NONBLOCK);
+  __hostWiFiServerPort = ntohs(address.sin_port);
+}
+
+void WiFiServer::end() {
+  if(_socket >= 0) close(_socket);
+  _socket = -1;
+}
+
+WiFiClient WiFiServer::available() {
+  if(_socket < 0) return WiFiClient();
+  int client = accept4(_socket, NULL, NULL, 0);
+  return (client >= 0) ? WiFiClient(client) : WiFiClient();
+}
+
+uint16_t hostWiFiServerPort() {
+  return __hostWiFiServerPort;
+}
@@ -0,0 +1,118 @@
+/**
+ * @package Wildlife Camera
+ * Host build of the WiFi library header
+ * Clients and servers are TCP sockets of the host; the station is always connected to the loopback network
+ * @author WizLab.it
+ * @version 20261018.001
+ */
+
+#ifndef WIFI_H
+#define WIFI_H
+
+
+/**
+ * Includes
+ */
+#include <Arduino.h>
+#include <memory>
+
+
+/**
+ * Defines
+ */
+typedef enum {
+  WL_IDLE_STATUS = 0,
+  WL_CONNECTED = 3,
+  WL_CONNECT_FAILED = 4,
+  WL_DISCONNECTED = 6
+} wl_status_t;
+
+#define WIFI_OFF  0
+#define WIFI_STA  1
+
+
+/**
+ * IPAddress
+ */
+class IPAddress {
+  private:
+    uint8_t _address[4];
+
+  public:
+    IPAddress(uint8_t a = 0, uint8_t b = 0, uint8_t c = 0, uint8_t d = 0) : _address{a, b, c, d} {}
+    String toString() const;
+};
+
+
+/**
+ * WiFiClient
+ * Copies share the socket, as on the board; reads don't block, writes do
+ */
+class WiFiClient : public Stream {
+  protected:
+    std::shared_ptr<int> _socket;
+    int _peeked = -1;
+
+  public:
+    WiFiClient() {}
+    WiFiClient(int socket);
+    virtual ~WiFiClient() {}
+    virtual int connect(const char* host, uint16_t port);
+    size_t write(uint8_t c) override { return write(&c, 1); }
+    size_t write(const uint8_t *buffer, size_t size) override;
+    using Print::write;
+    int available() override;
+    int read() override;
+    int read(uint8_t *buffer, size_t size);
+    int peek() override;
+    uint8_t connected();
+    void stop();
+    void setNoDelay(bool noDelay);
+    operator bool() { return connected(); }
+};
+
+
+/**
+ * WiFiServer
+ * Listens on the loopback interface; the HOST_WIFISERVER_PORT environment variable replaces the port (0: any free
+ * port, then read with hostWiFiServerPort())
+ */
+class WiFiServer {
+  private:
+    uint16_t _port;
+    int _socket = -1;
+
+  public:
+    WiFiServer(uint16_t port = 80) : _port(port) {}
+    ~WiFiServer() { end(); }
+    void begin();
+    void end();
+    WiFiClient available();
+    WiFiClient accept() { return available(); }
+};
+
+uint16_t hostWiFiServerPort();
+
+
+/**
+ * WiFi
+ */
+class WiFiClass {
+  private:
+    wl_status_t _status = WL_CONNECTED;
+
+  public:
+    wl_status_t begin(const char* ssid, const char* password) { _status = WL_CONNECTED; return _status; }
+    bool disconnect(bool wifiOff = false) { _status = WL_DISCONNECTED; return true; }
+    bool mode(uint8_t mode) { return true; }
+    bool setSleep(bool enabled) { return true; }
+    wl_status_t status() { return _status; }
+    String SSID() { return "host"; }
+    int8_t RSSI() { return -60; }
+    IPAddress localIP() { return IPAddress(127, 0, 0, 1); }
+};
+
+extern WiFiClass WiFi;
+
+
+#endif
@@ -0,0 +1,45 @@
+/**
+ * @package Wildlife Camera
+ * Host build of the WiFiClientSecure library header
+ * There's no TLS on the host: connections go in plain TCP to the address set in the HOST_TLS_REDIRECT environment
+ * variable ("host:port", i.e. a local Bot API stand-in), and fail if it's not set
+ * @author WizLab.it
+ * @version 20261018.001
+ */
+
+#ifndef WIFICLIENTSECURE_H
+#define WIFICLIENTSECURE_H
+
+
+/**
+ * Includes
+ */
+#include "WiFi.h"
+
+
+/**
+ * WiFiClientSecure
+ * Instances are counted, so tests can check when a TLS client is created
+ */
+class WiFiClientSecure : public WiFiClient {
+  private:
+    static uint32_t _instances;
+
+  public:
+    WiFiClientSecure() { _instances++; }
+    void setInsecure() {}
+    void setCACert(const char* rootCA) {}
+
+    int connect(const char* host, uint16_t port) override {
+      const char* redirect = getenv("HOST_TLS_REDIRECT");
+      if((redirect == NULL) || (strchr(redirect, ':') == NULL)) return 0;
+      String address(redirect);
+      int colon = address.lastIndexOf(':');
+      return WiFiClient::connect(address.substring(0, colon).c_str(), address.substring(colon + 1).toInt());
+    }
+
+    static uint32_t hostGetInstances() { return _instances; }
+};
+
+
+#endif
@@ -0,0 +1,96 @@
+/**
+ * @package Wildlife Camera
+ * Host build of the ESP32 camera driver
+ * @author WizLab.it
+ * @version 20261018.001
+ */
+
+#include "esp_camera.h"
+#include <map>
+
+
+/**
+ * Variables
+ */
+static std::function<std::vector<uint8_t>(framesize_t)> __hostCameraSource;
+static uint32_t __hostCameraGrabs = 0;
+static std::map<int, int> __hostSensorRegisters;
+
+
+/**
+ * Sensor
+ */
+static int __hostSensorSetFramesize(sensor_t *sensor, framesize_t framesize) {
+  sensor->framesize = framesize;
+  return 0;
+}
+
+static int __hostSensorSetControl(sensor_t *sensor, int enable) {
+  return 0;
+}
+
+static int __hostSensorGetReg(sensor_t *sensor, int reg, int mask) {
+  return __hostSensorRegisters[reg] & mask;
+}
+
+static int __hostSensorSetReg(sensor_t *sensor, int reg, int mask, int value) {
+  __hostSensorRegisters[reg] = (__hostSensorRegisters[reg] & ~mask) | (value & mask);
+  return 0;
+}
+
+static sensor_t __hostSensor = {{0x7F, 0xA2, OV2640_PID, 0x42}, FRAMESIZE_UXGA, &__hostSensorSetFramesize, &__hostSensorSetControl, &__hostSensorSetControl, &__hostSensorGetReg, &__hostSensorSetReg};
+
+
+/**
+ * Driver
+ */
+esp_err_t esp_camera_init(const camera_config_t *config) {
+  __hostSensor.framesize = config->frame_size;
+  return ESP_OK;
+}
+
+esp_err_t esp_camera_deinit() {
+  return ESP_OK;
+}
+
+camera_fb_t *esp_camera_fb_get() {
+  __hostCameraGrabs++;
+  if(!__hostCameraSource) return NULL;
+  std::vector<uint8_t> frame = __hostCameraSource(__hostSensor.framesize);
+  if(frame.empty()) return NULL;
+
+  camera_fb_t *fb = new camera_fb_t();
+  fb->len = frame.size();
+  fb->buf = (uint8_t *)malloc(fb->len);
+  memcpy(fb->buf, frame.data(), fb->len);
+  uint16_t width, height;
+  hostFrameSizeGetDimensions(__hostSensor.framesize, &width, &height);
+  fb->width = width;
+  fb->height = height;
+  fb->format = PIXFORMAT_JPEG;
+  return fb;
+}
+
+void esp_camera_fb_return(camera_fb_t *fb) {
+  if(fb == NULL) return;
+  free(fb->buf);
+  delete fb;
+}
+
+sensor_t *esp_camera_sensor_get() {
+  return &__hostSensor;
+}
+
+void hostCameraSetFrameSource(std::function<std::vector<uint8_t>(framesize_t)> source) {
+  __hostCameraSource = source;
+}
+
+uint32_t hostCameraGetGrabs() {
+  return __hostCameraGrabs;
+}
+
+void hostFrameSizeGetDimensions(framesize_t framesize, uint16_t *width, uint16_t *height) {
+  static const uint16_t dimensions[][2] = {{320, 240}, {400, 296}, {640, 480}, {800, 600}, {1024, 768}, {1280, 1024}, {1600, 1200}};
+  *width = dimensions[framesize][0];
+  *height = dimensions[framesize][1];
+}
@@ -0,0 +1,102 @@
+/**
+ * @package Wildlife Camera
+ * Host build of the ESP32 camera driver header
+ * Frames come from a source set by the test (no frames if not set); the sensor keeps its registers in memory
+ * @author WizLab.it
+ * @version 20261018.001
+ */
+
+#ifndef ESP_CAMERA_H
+#define ESP_CAMERA_H
+
+
+/**
+ * Includes
+ */
+#include <Arduino.h>
+#include <functional>
+#include <vector>
+
+
+/**
+ * Defines
+ */
+#define LEDC_CHANNEL_0  0
+#define LEDC_TIMER_0    0
+#define OV2640_PID      0x26
+
+typedef enum {
+  FRAMESIZE_QVGA,
+  FRAMESIZE_CIF,
+  FRAMESIZE_VGA,
+  FRAMESIZE_SVGA,
+  FRAMESIZE_XGA,
+  FRAMESIZE_SXGA,
+  FRAMESIZE_UXGA
+} framesize_t;
+
+typedef enum {
+  PIXFORMAT_JPEG
+} pixformat_t;
+
+typedef enum {
+  CAMERA_GRAB_WHEN_EMPTY,
+  CAMERA_GRAB_LATEST
+} camera_grab_mode_t;
+
+typedef struct {
+  int pin_pwdn, pin_reset, pin_xclk, pin_sscb_sda, pin_sscb_scl;
+  int pin_d7, pin_d6, pin_d5, pin_d4, pin_d3, pin_d2, pin_d1, pin_d0;
+  int pin_vsync, pin_href, pin_pclk;
+  int xclk_freq_hz;
+  int ledc_timer, ledc_channel;
+  pixformat_t pixel_format;
+  framesize_t frame_size;
+  int jpeg_quality;
+  size_t fb_count;
+  camera_grab_mode_t grab_mode;
+} camera_config_t;
+
+typedef struct {
+  uint8_t *buf;
+  size_t len;
+  size_t width;
+  size_t height;
+  pixformat_t format;
+} camera_fb_t;
+
+typedef struct {
+  uint8_t MIDH;
+  uint8_t MIDL;
+  uint16_t PID;
+  uint8_t VER;
+} sensor_id_t;
+
+typedef struct _sensor sensor_t;
+struct _sensor {
+  sensor_id_t id;
+  framesize_t framesize;
+  int (*set_framesize)(sensor_t *sensor, framesize_t framesize);
+  int (*set_exposure_ctrl)(sensor_t *sensor, int enable);
+  int (*set_gain_ctrl)(sensor_t *sensor, int enable);
+  int (*get_reg)(sensor_t *sensor, int reg, int mask);
+  int (*set_reg)(sensor_t *sensor, int reg, int mask, int value);
+};
+
+
+/**
+ * Functions
+ */
+esp_err_t esp_camera_init(const camera_config_t *config);
+esp_err_t esp_camera_deinit();
+camera_fb_t *esp_camera_fb_get();
+void esp_camera_fb_return(camera_fb_t *fb);
+sensor_t *esp_camera_sensor_get();
+
+//Frame source: returns the JPEG data of the next frame (empty: capture failure), at the current frame size
+void hostCameraSetFrameSource(std::function<std::vector<uint8_t>(framesize_t)> source);
+uint32_t hostCameraGetGrabs();
+void hostFrameSizeGetDimensions(framesize_t framesize, uint16_t *width, uint16_t *height);
+
+
+#endif
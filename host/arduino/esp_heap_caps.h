@@ -0,0 +1,26 @@
+/**
+ * @package Wildlife Camera
+ * Host build of the ESP-IDF heap capabilities header (minimum free heap monitoring only)
+ * @author WizLab.it
+ * @version 20261018.001
+ */
+
+#ifndef ESP_HEAP_CAPS_H
+#define ESP_HEAP_CAPS_H
+
+
+/**
+ * Includes
+ */
+#include <Arduino.h>
+
+
+/**
+ * Functions
+ * While monitoring, ESP.getMinFreeHeap() is the minimum since the start of the monitoring instead of since boot
+ */
+esp_err_t heap_caps_monitor_local_minimum_free_size_start();
+esp_err_t heap_caps_monitor_local_minimum_free_size_stop();
+
+
+#endif
@@ -0,0 +1,22 @@
+/**
+ * @package Wildlife Camera
+ * Host build of the ESP-IDF version header (the host heap supports the local minimum free heap monitoring of 5.1)
+ * @author WizLab.it
+ * @version 20261018.001
+ */
+
+#ifndef ESP_IDF_VERSION_H
+#define ESP_IDF_VERSION_H
+
+
+/**
+ * Defines
+ */
+#define ESP_IDF_VERSION_VAL(major, minor, patch)  ((major << 16) | (minor << 8) | (patch))
+#define ESP_IDF_VERSION_MAJOR                     5
+#define ESP_IDF_VERSION_MINOR                     1
+#define ESP_IDF_VERSION_PATCH                     0
+#define ESP_IDF_VERSION                           ESP_IDF_VERSION_VAL(ESP_IDF_VERSION_MAJOR, ESP_IDF_VERSION_MINOR, ESP_IDF_VERSION_PATCH)
+
+
+#endif
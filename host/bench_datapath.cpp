@@ -0,0 +1,217 @@
+/**
+ * @package Wildlife Camera
+ * Data-path benchmark: the measurements compiled in the modules (see benchmark.h) on synthetic inputs
+ * - telegram.photoPayload and telegram.httpResponse: photo uploads, synthetic JPEGs from VGA to UXGA
+ * - telegram.getUpdatesJson and telegram.httpResponse: recorded getUpdates responses (fixtures/getupdates_*.json)
+ * - camera.photoDbLoad, camera.photoDbSave and camera.pathFilename: photos saved on a directory-backed SD Card
+ * Requests are answered over loopback by a responder that doesn't allocate memory, so the heap measurements only
+ * include the firmware. One JSON line per operation on standard output.
+ * @author WizLab.it
+ * @version 20261018.001
+ */
+
+#include <Arduino.h>
+#include "SD_MMC.h"
+#include "WiFi.h"
+#include "camera.h"
+#include "telegram.h"
+#include "hosttest.h"
+#include "jpeg.h"
+#include "sketch.h"
+#include <arpa/inet.h>
+#include <atomic>
+#include <sys/socket.h>
+#include <sys/stat.h>
+#include <sys/wait.h>
+#include <thread>
+#include <unistd.h>
+
+
+/**
+ * Defines
+ */
+#define BENCH_ITERATIONS  3
+
+
+/**
+ * Responder: answers each request with a fixture, chosen by the Bot API method
+ */
+static std::vector<uint8_t> __getUpdatesResponse;
+static std::vector<uint8_t> __sendPhotoResponse;
+static const char __okResponse[] = "{\"ok\":true,\"result\":true}";
+static std::atomic<bool> __responderExit(false);
+static int __responderSocket = -1;
+
+static void respond(int client) {
+  char buffer[4096];
+  size_t used = 0;
+  char *end = NULL;
+  while(end == NULL) {
+    ssize_t rb = recv(client, buffer + used, sizeof(buffer) - used - 1, 0);
+    if(rb <= 0) return;
+    used += rb;
+    buffer[used] = '\0';
+    end = strstr(buffer, "\r\n\r\n");
+    if((end == NULL) && (used == (sizeof(buffer) - 1))) return;
+  }
+
+  //Discard the body
+  char *contentLength = strcasestr(buffer, "\r\nContent-Length: ");
+  long remaining = ((contentLength != NULL) ? atol(contentLength + 18) : 0) - (long)(used - (end + 4 - buffer));
+  bool getUpdates = (strstr(buffer, "/getUpdates ") != NULL);
+  bool sendPhoto = (strstr(buffer, "/sendPhoto ") != NULL) && (strcasestr(buffer, "multipart/form-data") != NULL);
+  while(remaining > 0) {
+    ssize_t rb = recv(client, buffer, sizeof(buffer), 0);
+    if(rb <= 0) return;
+    remaining -= rb;
+  }
+
+  const uint8_t *body = (const uint8_t *)__okResponse;
+  size_t bodyLength = strlen(__okResponse);
+  if(getUpdates) {
+    body = __getUpdatesResponse.data();
+    bodyLength = __getUpdatesResponse.size();
+  } else if(sendPhoto) {
+    body = __sendPhotoResponse.data();
+    bodyLength = __sendPhotoResponse.size();
+  }
+  int length = snprintf(buffer, sizeof(buffer), "HTTP/1.1 200 OK\r\nServer: nginx/1.18.0\r\nContent-Type: application/json\r\nContent-Length: %zu\r\nConnection: close\r\n\r\n", bodyLength);
+  send(client, buffer, length, MSG_NOSIGNAL);
+  send(client, body, bodyLength, MSG_NOSIGNAL);
+}
+
+static void responderThread() {
+  while(!__responderExit) {
+    int client = accept(__responderSocket, NULL, NULL);
+    if(client < 0) continue;
+    respond(client);
+    shutdown(client, SHUT_WR);
+    close(client);
+  }
+}
+
+static uint16_t responderStart() {
+  __responderSocket = socket(AF_INET, SOCK_STREAM, 0);
+  struct sockaddr_in address = {};
+  address.sin_family = AF_INET;
+  address.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+  socklen_t length = sizeof(address);
+  bind(__responderSocket, (struct sockaddr *)&address, sizeof(address));
+  listen(__responderSocket, 8);
+  getsockname(__responderSocket, (struct sockaddr *)&address, &length);
+  return ntohs(address.sin_port);
+}
+
+
+/**
+ * Command processor
+ */
+static uint16_t __commands = 0;
+
+static void commandProcessor(const char* command) {
+  __commands++;
+}
+
+
+/**
+ * Frame sizes of the synthetic photos
+ */
+static const framesize_t __frameSizes[] = {FRAMESIZE_VGA, FRAMESIZE_SVGA, FRAMESIZE_XGA, FRAMESIZE_SXGA, FRAMESIZE_UXGA};
+
+static std::vector<uint8_t> photo(framesize_t frameSize) {
+  uint16_t width, height;
+  hostFrameSizeGetDimensions(frameSize, &width, &height);
+  HostScene scene;
+  scene.animal = true;
+  scene.noiseSeed = 1 + frameSize;
+  return hostScenePhoto(scene, width, height);
+}
+
+
+/**
+ * getUpdates on the recorded corpora: all the updates are parsed, up to 10 are processed
+ */
+static void benchGetUpdates(Telegram &telegram) {
+  const char* corpora[] = {"getupdates_1.json", "getupdates_10.json", "getupdates_100.json"};
+  const int8_t expected[] = {1, 10, 10};
+  for(uint8_t i=0; i<3; i++) {
+    __getUpdatesResponse = hostReadFile(std::string(HOST_FIXTURES_DIR) + "/" + corpora[i]);
+    CHECK(__getUpdatesResponse.size() > 0);
+    for(uint8_t n=0; n<BENCH_ITERATIONS; n++) {
+      __commands = 0;
+      CHECK(telegram.getUpdates() == expected[i]);
+      CHECK(__commands > 0);
+    }
+  }
+}
+
+
+/**
+ * Photo uploads: multipart payload, then the sendPhoto response with its file_id
+ */
+static void benchSendPhoto(Telegram &telegram) {
+  __sendPhotoResponse = hostReadFile(std::string(HOST_FIXTURES_DIR) + "/sendphoto.json");
+  CHECK(__sendPhotoResponse.size() > 0);
+  for(framesize_t frameSize : __frameSizes) {
+    std::vector<uint8_t> jpeg = photo(frameSize);
+    for(uint8_t n=0; n<BENCH_ITERATIONS; n++) {
+      char fileId[_TELEGRAM_FILEID_MAX_LENGTH];
+      CHECK(telegram.sendPhoto(jpeg.data(), jpeg.size(), fileId) == 0);
+      CHECK(strlen(fileId) > 0);
+    }
+  }
+}
+
+
+/**
+ * Photo DB: each photo is taken by a new process, as after a power on, so the Photo DB is loaded from the SD Card
+ * before the photo is saved
+ */
+static void benchPhotoDb() {
+  std::string root = hostTempDir("datapath");
+  SD_MMC.setRoot(root.c_str());
+
+  for(int8_t i=-1; i<(int8_t)(sizeof(__frameSizes) / sizeof(framesize_t)); i++) {
+    framesize_t frameSize = __frameSizes[(i < 0) ? 0 : i];
+    std::vector<uint8_t> jpeg = photo(frameSize);
+    fflush(stdout);
+    pid_t pid = fork();
+    if(pid == 0) {
+      hostCameraSetFrameSource([&jpeg](framesize_t size) { return jpeg; });
+      Camera camera(frameSize, 8, true);
+      uint8_t *image = NULL;
+      bool ok = camera.init() && (camera.takePhoto(&image, false) == (long)jpeg.size()) && (camera.sdGetPhotoCounter() == (uint16_t)(i + 2));
+      free(image);
+      fflush(stdout);
+      _exit(ok ? 0 : 1);
+    }
+    int status = -1;
+    waitpid(pid, &status, 0);
+    CHECK(WIFEXITED(status) && (WEXITSTATUS(status) == 0));
+  }
+
+  std::string command = "rm -rf '" + root + "'";
+  CHECK(system(command.c_str()) == 0);
+}
+
+
+int main() {
+  hostSetTimestamp(1792300000);
+  uint16_t port = responderStart();
+  char redirect[32];
+  snprintf(redirect, sizeof(redirect), "127.0.0.1:%u", port);
+  setenv("HOST_TLS_REDIRECT", redirect, 1);
+  std::thread responder(responderThread);
+
+  Telegram telegram("123456789:BenchmarkToken", -1001987654321LL, &commandProcessor);
+  telegram.addChatIds("123456789,234567891");   //Commands of the other chat in the corpora are ignored
+  benchGetUpdates(telegram);
+  benchSendPhoto(telegram);
+  benchPhotoDb();
+
+  __responderExit = true;
+  shutdown(__responderSocket, SHUT_RDWR);
+  close(__responderSocket);
+  responder.join();
+  return TEST_RESULT();
+}
@@ -0,0 +1,98 @@
+/**
+ * @package Wildlife Camera
+ * Near-duplicate detection benchmark: fingerprint time and memory, then fingerprint distances on recorded photos
+ * - dedup.fingerprint: synthetic JPEGs from VGA to UXGA (YCbCr 4:2:2, as produced by the camera)
+ * - dedup.distance: fixtures/dedup_*.jpg, VGA photos of the same scene encoded by libjpeg (YCbCr 4:2:0, one with
+ *   restart markers): empty, with sensor noise, darker (cloud), with an animal, with the animal still and moved
+ * @author WizLab.it
+ * @version 20261018.001
+ */
+
+#include <Arduino.h>
+#include <esp_camera.h>
+#include "dedup.h"
+#include "hosttest.h"
+#include "jpeg.h"
+#include "sketch.h"
+
+
+/**
+ * Defines
+ */
+#define BENCH_ITERATIONS  3
+
+
+/**
+ * Fingerprint time and memory for each frame size
+ * Photos of different scenes, so that none is a duplicate of the previous ones
+ */
+static void benchFingerprint() {
+  const framesize_t frameSizes[] = {FRAMESIZE_VGA, FRAMESIZE_SVGA, FRAMESIZE_XGA, FRAMESIZE_SXGA, FRAMESIZE_UXGA};
+  Dedup dedup(DEDUP_THRESHOLD, DEDUP_RESEND_INTERVAL);
+  for(framesize_t frameSize : frameSizes) {
+    uint16_t width, height;
+    hostFrameSizeGetDimensions(frameSize, &width, &height);
+    for(uint8_t n=0; n<BENCH_ITERATIONS; n++) {
+      HostScene scene;
+      scene.seed = 1 + (frameSize * BENCH_ITERATIONS) + n;
+      scene.noiseSeed = scene.seed;
+      std::vector<uint8_t> jpeg = hostScenePhoto(scene, width, height);
+      DedupFingerprint fingerprint;
+      CHECK(!dedup.isDuplicate(jpeg.data(), jpeg.size()));
+      CHECK(Dedup::fingerprint(jpeg.data(), jpeg.size(), &fingerprint));
+    }
+  }
+}
+
+
+/**
+ * Distances between the recorded photos
+ * Photos of the same scene (empty: with noise and with a cloud; the animal still) must be within the threshold; any
+ * photo with the animal must not be similar to the empty scene, nor the animal moving across the frame to the still one
+ */
+static void benchDistance() {
+  const char* names[] = {"empty", "empty_noise", "empty_cloud", "animal", "animal_still", "animal_moved"};
+  const uint8_t count = sizeof(names) / sizeof(names[0]);
+  const uint8_t empties = 3;
+  DedupFingerprint fingerprints[count];
+  for(uint8_t i=0; i<count; i++) {
+    std::vector<uint8_t> jpeg = hostReadFile(std::string(HOST_FIXTURES_DIR) + "/dedup_" + names[i] + ".jpg");
+    CHECK(jpeg.size() > 0);
+    CHECK(Dedup::fingerprint(jpeg.data(), jpeg.size(), &fingerprints[i]));
+
+    //Truncated photo: decoded up to the end of the data, or rejected
+    DedupFingerprint truncated;
+    Dedup::fingerprint(jpeg.data(), jpeg.size() / 2, &truncated);
+  }
+
+  for(uint8_t i=0; i<count; i++) {
+    for(uint8_t j=(i + 1); j<count; j++) {
+      printf("{\"bench\":\"dedup.distance\",\"a\":\"%s\",\"b\":\"%s\",\"distance\":%u,\"threshold\":%u}\n", names[i], names[j], Dedup::distance(fingerprints[i], fingerprints[j]), DEDUP_THRESHOLD);
+    }
+  }
+  for(uint8_t i=0; i<empties; i++) {
+    for(uint8_t j=(i + 1); j<empties; j++) CHECK(Dedup::distance(fingerprints[i], fingerprints[j]) <= DEDUP_THRESHOLD);
+    for(uint8_t j=empties; j<count; j++) CHECK(Dedup::distance(fingerprints[i], fingerprints[j]) > DEDUP_THRESHOLD);
+  }
+  CHECK(Dedup::distance(fingerprints[3], fingerprints[4]) <= DEDUP_THRESHOLD);
+  CHECK(Dedup::distance(fingerprints[3], fingerprints[5]) > DEDUP_THRESHOLD);
+  CHECK(Dedup::distance(fingerprints[4], fingerprints[5]) > DEDUP_THRESHOLD);
+
+  //Sequence of the camera: a false trigger on the empty scene, then the animal comes in and moves
+  Dedup dedup(DEDUP_THRESHOLD, DEDUP_RESEND_INTERVAL);
+  hostSetTimestamp(1792310000);
+  for(uint8_t i=0; i<count; i++) {
+    std::vector<uint8_t> jpeg = hostReadFile(std::string(HOST_FIXTURES_DIR) + "/dedup_" + names[i] + ".jpg");
+    bool duplicate = dedup.isDuplicate(jpeg.data(), jpeg.size());
+    if(!duplicate) dedup.markSent();
+    CHECK(duplicate == ((i == 1) || (i == 2) || (i == 4)));
+  }
+}
+
+
+int main() {
+  hostSetTimestamp(1792300000);
+  benchFingerprint();
+  benchDistance();
+  return TEST_RESULT();
+}
@@ -0,0 +1,245 @@
+/**
+ * @package Wildlife Camera
+ * Photo server benchmark: listings, files, ranges and tar bundles served from a directory-backed SD Card
+ * Prints one JSON line per request: throughput, peak heap while serving, allocations and SD Card mounts
+ * @author WizLab.it
+ * @version 20261018.001
+ */
+
+#include <Arduino.h>
+#include "SD_MMC.h"
+#include "WiFi.h"
+#include "photoserver.h"
+#include "hosttest.h"
+#include "sketch.h"
+#include <arpa/inet.h>
+#include <atomic>
+#include <fcntl.h>
+#include <sys/socket.h>
+#include <sys/stat.h>
+#include <thread>
+#include <unistd.h>
+
+
+/**
+ * Defines
+ */
+#define BENCH_DAY         "/20261018"
+#define BENCH_CLIP_SIZE   (3 * 1024 * 1024)
+
+
+/**
+ * Request, run by the client thread without heap allocations (only the server is measured)
+ */
+struct Request {
+  const char* path;
+  const char* range;
+  int verifyFd;       //File whose content is compared with the body (-1: none)
+  long verifyOffset;
+  int status;
+  long contentLength;
+  long bodyBytes;
+  bool bodyMatches;
+  size_t heapPeak;    //Peak of memory allocated while serving
+};
+
+static std::atomic<Request *> __request(NULL);
+static std::atomic<bool> __requestDone(false);
+static std::atomic<bool> __clientExit(false);
+
+
+static void runRequest(Request &request) {
+  request.status = 0;
+  request.contentLength = -1;
+  request.bodyBytes = 0;
+  request.bodyMatches = true;
+
+  int s = socket(AF_INET, SOCK_STREAM, 0);
+  struct sockaddr_in address = {};
+  address.sin_family = AF_INET;
+  address.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+  address.sin_port = htons(hostWiFiServerPort());
+  if(connect(s, (struct sockaddr *)&address, sizeof(address)) != 0) {
+    close(s);
+    return;
+  }
+
+  char buffer[16384];
+  int length = snprintf(buffer, sizeof(buffer), "GET %s HTTP/1.1\r\nHost: camera\r\n%s%s%s\r\n", request.path, (request.range[0] != '\0') ? "Range: " : "", request.range, (request.range[0] != '\0') ? "\r\n" : "");
+  send(s, buffer, length, MSG_NOSIGNAL);
+
+  //Header (status line and Content-Length), then body until the server closes the connection
+  size_t used = 0;
+  bool header = true;
+  ssize_t rb;
+  uint8_t expected[sizeof(buffer)];
+  while((rb = recv(s, buffer + used, sizeof(buffer) - used - 1, 0)) > 0) {
+    used += rb;
+    size_t bodyStart = 0;
+    if(header) {
+      buffer[used] = '\0';
+      char *end = strstr(buffer, "\r\n\r\n");
+      if(end == NULL) continue;
+      request.status = atoi(buffer + 9);
+      char *contentLength = strcasestr(buffer, "\r\nContent-Length: ");
+      if((contentLength != NULL) && (contentLength < end)) request.contentLength = atol(contentLength + 18);
+      bodyStart = end + 4 - buffer;
+      header = false;
+    }
+    size_t bodyLength = used - bodyStart;
+    if((request.verifyFd >= 0) && (bodyLength > 0)) {
+      ssize_t eb = pread(request.verifyFd, expected, bodyLength, request.verifyOffset + request.bodyBytes);
+      if((eb != (ssize_t)bodyLength) || (memcmp(expected, buffer + bodyStart, bodyLength) != 0)) request.bodyMatches = false;
+    }
+    request.bodyBytes += bodyLength;
+    used = 0;
+  }
+  close(s);
+}
+
+static void clientThread() {
+  while(!__clientExit) {
+    Request *request = __request.exchange(NULL);
+    if(request == NULL) {
+      usleep(50);
+      continue;
+    }
+    runRequest(*request);
+    __requestDone = true;
+  }
+}
+
+
+/**
+ * serve
+ * Serve one request from the server loop, print its measurements
+ * @return    true if the SD Card was mounted for the request and released after it
+ */
+static bool serve(PhotoServer &server, Request &request, const char* operation, uint16_t files) {
+  size_t heapBefore = hostHeapGetUsed();
+  uint64_t allocationsBefore = hostHeapGetAllocations();
+  uint32_t mountsBefore = SD_MMC.hostGetMounts();
+  hostHeapResetPeak();
+
+  unsigned long start = micros();
+  __requestDone = false;
+  __request = &request;
+  while(!__requestDone) {
+    server.handleClient();
+    if(!__requestDone) usleep(20);
+  }
+  unsigned long duration = micros() - start;
+  request.heapPeak = hostHeapGetPeak() - heapBefore;
+
+  printf("{\"bench\":\"%s\",\"files\":%u,\"bytes\":%ld,\"us\":%lu,\"kbps\":%0.1f,\"heap_peak\":%zu,\"allocations\":%llu,\"sd_mounts\":%u}\n",
+    operation, files, request.bodyBytes, duration, ((request.bodyBytes * 1000.0) / max(duration, 1UL)), request.heapPeak,
+    (unsigned long long)(hostHeapGetAllocations() - allocationsBefore), (SD_MMC.hostGetMounts() - mountsBefore));
+  return (SD_MMC.hostGetMounts() == (mountsBefore + 1)) && !SD_MMC.hostIsMounted();
+}
+
+
+/**
+ * Files of a day directory, sized as UXGA photos
+ */
+static long createFiles(const std::string &dir, uint16_t files) {
+  std::vector<uint8_t> data(260 * 1024);
+  long total = 2 * _PHOTOSERVER_TAR_BLOCK;
+  mkdir(dir.c_str(), 0755);
+  for(uint16_t i=0; i<files; i++) {
+    size_t size = 120 * 1024 + ((i * 7919) % (140 * 1024));
+    for(size_t j=0; j<size; j++) data[j] = (uint8_t)((j * 31) + i);
+    char path[256];
+    snprintf(path, sizeof(path), "%s/%03u-%02u%02u%02u.jpg", dir.c_str(), i, (i / 3600) % 24, (i / 60) % 60, i % 60);
+    FILE *file = fopen(path, "wb");
+    fwrite(data.data(), 1, size, file);
+    fclose(file);
+    total += _PHOTOSERVER_TAR_BLOCK + (((size + _PHOTOSERVER_TAR_BLOCK - 1) / _PHOTOSERVER_TAR_BLOCK) * _PHOTOSERVER_TAR_BLOCK);
+  }
+  return total;
+}
+
+static void removeTree(const std::string &path) {
+  std::string command = "rm -rf '" + path + "'";
+  if(system(command.c_str()) != 0) fprintf(stderr, "Can't remove %s\n", path.c_str());
+}
+
+
+int main() {
+  std::string root = hostTempDir("photoserver");
+  std::string base = root + _CAMERA_SD_BASE_PATH;
+  SD_MMC.setRoot(root.c_str());
+  mkdir(base.c_str(), 0755);
+  hostSetTimestamp(1792300000);
+  setenv("HOST_WIFISERVER_PORT", "0", 1);
+
+  Camera camera(FRAMESIZE_UXGA, 8, true);
+  PhotoServer server(&camera);
+  CHECK(server.start(3600));
+  CHECK(!SD_MMC.hostIsMounted());
+  std::thread client(clientThread);
+
+  //Listing and tar bundle, for a growing number of files: memory used while serving must not grow with them
+  size_t listingPeak[3], tarPeak[3];
+  uint16_t fileCounts[] = {10, 100, 400};
+  for(uint8_t i=0; i<3; i++) {
+    std::string dir = base + BENCH_DAY + "-" + String(fileCounts[i]).str();
+    long tarLength = createFiles(dir, fileCounts[i]);
+    char listingPath[64], tarPath[64];
+    snprintf(listingPath, sizeof(listingPath), "%s-%u/", BENCH_DAY, fileCounts[i]);
+    snprintf(tarPath, sizeof(tarPath), "%s-%u.tar", BENCH_DAY, fileCounts[i]);
+
+    Request listing = {listingPath, "", -1, 0};
+    CHECK(serve(server, listing, "photoserver.listing", fileCounts[i]));
+    CHECK((listing.status == 200) && (listing.bodyBytes > (fileCounts[i] * 40)));
+
+    Request tar = {tarPath, "", -1, 0};
+    CHECK(serve(server, tar, "photoserver.tar", fileCounts[i]));
+    CHECK((tar.status == 200) && (tar.contentLength == tarLength) && (tar.bodyBytes == tarLength));
+    listingPeak[i] = listing.heapPeak;
+    tarPeak[i] = tar.heapPeak;
+    removeTree(dir);
+  }
+  CHECK(listingPeak[2] < (listingPeak[0] + 4096));
+  CHECK(tarPeak[2] < (tarPeak[0] + 4096));
+
+  //Clip: whole file, then ranges as used by players to seek and by downloads to resume
+  std::string clipPath = base + BENCH_DAY + "/clip.avi";
+  mkdir((base + BENCH_DAY).c_str(), 0755);
+  std::vector<uint8_t> clip(BENCH_CLIP_SIZE);
+  for(size_t i=0; i<clip.size(); i++) clip[i] = (uint8_t)((i * 131) >> 3);
+  FILE *file = fopen(clipPath.c_str(), "wb");
+  fwrite(clip.data(), 1, clip.size(), file);
+  fclose(file);
+  int clipFd = open(clipPath.c_str(), O_RDONLY);
+
+  Request whole = {BENCH_DAY "/clip.avi", "", clipFd, 0};
+  CHECK(serve(server, whole, "photoserver.file", 1));
+  CHECK((whole.status == 200) && (whole.bodyBytes == BENCH_CLIP_SIZE) && whole.bodyMatches);
+
+  Request range = {BENCH_DAY "/clip.avi", "bytes=1000000-1999999", clipFd, 1000000};
+  CHECK(serve(server, range, "photoserver.range", 1));
+  CHECK((range.status == 206) && (range.bodyBytes == 1000000) && range.bodyMatches);
+
+  Request resume = {BENCH_DAY "/clip.avi", "bytes=3000000-", clipFd, 3000000};
+  CHECK(serve(server, resume, "photoserver.range", 1));
+  CHECK((resume.status == 206) && (resume.bodyBytes == (BENCH_CLIP_SIZE - 3000000)) && resume.bodyMatches);
+
+  Request suffix = {BENCH_DAY "/clip.avi", "bytes=-500", clipFd, BENCH_CLIP_SIZE - 500};
+  CHECK(serve(server, suffix, "photoserver.range", 1));
+  CHECK((suffix.status == 206) && (suffix.bodyBytes == 500) && suffix.bodyMatches);
+
+  Request unsatisfiable = {BENCH_DAY "/clip.avi", "bytes=4000000-", -1, 0};
+  CHECK(serve(server, unsatisfiable, "photoserver.range", 1));
+  CHECK(unsatisfiable.status == 416);
+
+  Request missing = {BENCH_DAY "/missing.jpg", "", -1, 0};
+  CHECK(serve(server, missing, "photoserver.file", 0));
+  CHECK(missing.status == 404);
+  close(clipFd);
+
+  __clientExit = true;
+  client.join();
+  server.stop();
+  removeTree(root);
+  return TEST_RESULT();
+}
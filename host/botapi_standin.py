@@ -0,0 +1,274 @@
+#!/usr/bin/env python3
+#
+# @package Wildlife Camera
+# Local stand-in of the Telegram Bot API, over plain HTTP, for load tests of the camera and of the LAN gateway
+# Network conditions: latency, bandwidth cap (requests and responses), rate limiting (429 with retry_after) and
+# responses truncated after the request was processed (the photo is delivered, the sender doesn't know it).
+# Photos are uploaded with sendPhoto or sendMediaGroup; getUpdates returns the updates from the offset on.
+# Delivered photos are identified by their content: GET /stats reports deliveries, duplicates and injected faults.
+# @author WizLab.it
+# @version 20261018.001
+#
+# python3 botapi_standin.py --port 0 --latency 100 --bandwidth 1024 --rate-limit 0.1 --truncate 0.05
+# prints "port <n>" on the first line, then serves until terminated
+#
+
+import argparse
+import hashlib
+import http.server
+import json
+import os
+import random
+import sys
+import threading
+import time
+import urllib.parse
+
+
+FIXTURES_DIR = os.path.join(os.path.dirname(os.path.abspath(__file__)), "fixtures")
+
+
+class Conditions:
+  """Network conditions and fault rates, applied to every request"""
+  def __init__(self, latency=0, bandwidth=0, rateLimit=0.0, retryAfter=1, truncate=0.0, seed=1):
+    self.latency = latency          #Milliseconds before each response
+    self.bandwidth = bandwidth      #KB/s for request and response bodies (0: no cap)
+    self.rateLimit = rateLimit      #Fraction of requests answered with 429
+    self.retryAfter = retryAfter    #retry_after of the 429 responses, in seconds
+    self.truncate = truncate        #Fraction of requests processed, whose response is cut halfway
+    self.random = random.Random(seed)
+    self.lock = threading.Lock()
+
+  def draw(self):
+    with self.lock:
+      n = self.random.random()
+    if n < self.rateLimit:
+      return "ratelimit"
+    if n < (self.rateLimit + self.truncate):
+      return "truncate"
+    return None
+
+
+class Stats:
+  """Counters of requests, deliveries and injected faults"""
+  def __init__(self):
+    self.lock = threading.Lock()
+    self.requests = {}
+    self.rateLimited = 0
+    self.truncated = 0
+    self.photos = {}                #Hash of the photo content: number of deliveries
+    self.photoBytes = 0
+    self.photosByFileId = 0
+    self.messages = 0
+
+  def add(self, name, value=1):
+    with self.lock:
+      setattr(self, name, getattr(self, name) + value)
+
+  def request(self, method):
+    with self.lock:
+      self.requests[method] = self.requests.get(method, 0) + 1
+
+  def photo(self, digest, length):
+    with self.lock:
+      self.photos[digest] = self.photos.get(digest, 0) + 1
+      self.photoBytes += length
+
+  def report(self):
+    with self.lock:
+      return {
+        "requests": dict(self.requests),
+        "rate_limited": self.rateLimited,
+        "truncated": self.truncated,
+        "photos_delivered": sum(self.photos.values()),
+        "photos_unique": len(self.photos),
+        "photos_duplicated": sum(n - 1 for n in self.photos.values()),
+        "photo_bytes": self.photoBytes,
+        "photos_by_file_id": self.photosByFileId,
+        "messages": self.messages,
+      }
+
+
+def multipartField(body, contentType, name):
+  """Content of a multipart/form-data field (None if missing)"""
+  boundary = None
+  for param in contentType.split(";"):
+    param = param.strip()
+    if param.startswith("boundary="):
+      boundary = param[9:].strip('"').encode()
+  if boundary is None:
+    return None
+  for part in body.split(b"--" + boundary):
+    head, separator, content = part.partition(b"\r\n\r\n")
+    if separator and (('name="' + name + '"').encode() in head):
+      return content[:-2] if content.endswith(b"\r\n") else content
+  return None
+
+
+class Handler(http.server.BaseHTTPRequestHandler):
+  protocol_version = "HTTP/1.1"
+  server_version = "nginx/1.18.0"
+  sys_version = ""
+
+  def log_message(self, format, *args):
+    pass
+
+  def _throttle(self, length, start):
+    bandwidth = self.server.conditions.bandwidth
+    if bandwidth > 0:
+      wait = start + (length / (bandwidth * 1024.0)) - time.monotonic()
+      if wait > 0:
+        time.sleep(wait)
+
+  def _readBody(self):
+    remaining = int(self.headers.get("Content-Length", 0))
+    chunks = []
+    received = 0
+    start = time.monotonic()
+    while remaining > 0:
+      chunk = self.rfile.read(min(remaining, 4096))
+      if not chunk:
+        break
+      chunks.append(chunk)
+      received += len(chunk)
+      remaining -= len(chunk)
+      self._throttle(received, start)
+    return b"".join(chunks)
+
+  def _respond(self, status, result, fault=None):
+    body = json.dumps(result, separators=(",", ":")).encode()
+    if self.server.conditions.latency > 0:
+      time.sleep(self.server.conditions.latency / 1000.0)
+    self.send_response(status)
+    self.send_header("Content-Type", "application/json")
+    self.send_header("Content-Length", str(len(body)))
+    self.send_header("Connection", "close")
+    self.end_headers()
+    if fault == "truncate":
+      body = body[:len(body) // 2]
+    start = time.monotonic()
+    for n in range(0, len(body), 4096):
+      self.wfile.write(body[n:n + 4096])
+      self._throttle(n + 4096, start)
+    self.close_connection = True
+
+  def _photoMessage(self, photo):
+    """Message of an uploaded photo, counted as delivered; file_id of its sizes from the photo content"""
+    digest = hashlib.sha1(photo).hexdigest()
+    self.server.stats.photo(digest, len(photo))
+    message = json.loads(json.dumps(self.server.sendPhoto["result"]))
+    for size in message["photo"]:
+      size["file_id"] = "AgAC" + digest + str(size["width"])
+    return message
+
+  def do_GET(self):
+    if self.path == "/stats":
+      self._respond(200, self.server.stats.report())
+    else:
+      self._respond(404, {"ok": False, "error_code": 404, "description": "Not Found"})
+
+  def do_POST(self):
+    body = self._readBody()
+    parts = self.path.split("?")[0].split("/")
+    if (len(parts) != 3) or not parts[1].startswith("bot"):
+      self._respond(404, {"ok": False, "error_code": 404, "description": "Not Found"})
+      return
+    method = parts[2]
+    stats = self.server.stats
+    stats.request(method)
+
+    #Rate limited: the request is not processed
+    fault = self.server.conditions.draw()
+    if fault == "ratelimit":
+      stats.add("rateLimited")
+      retryAfter = self.server.conditions.retryAfter
+      self._respond(429, {"ok": False, "error_code": 429, "description": "Too Many Requests: retry after %d" % retryAfter, "parameters": {"retry_after": retryAfter}})
+      return
+
+    #Processed, then answered (truncated responses are counted, the request has been processed anyway)
+    if fault == "truncate":
+      stats.add("truncated")
+    contentType = self.headers.get("Content-Type", "")
+    isMultipart = contentType.startswith("multipart/form-data")
+    form = {} if isMultipart else urllib.parse.parse_qs(body.decode(errors="replace"))
+    if method == "getUpdates":
+      offset = int(form.get("offset", ["0"])[0])
+      result = [update for update in self.server.updates["result"] if update["update_id"] >= offset]
+      self._respond(200, {"ok": True, "result": result}, fault)
+    elif method == "sendPhoto":
+      photo = multipartField(body, contentType, "photo") if isMultipart else None
+      if photo is not None:
+        self._respond(200, {"ok": True, "result": self._photoMessage(photo)}, fault)
+      elif "photo" in form:
+        stats.add("photosByFileId")
+        self._respond(200, self.server.sendPhoto, fault)
+      else:
+        self._respond(400, {"ok": False, "error_code": 400, "description": "Bad Request: there is no photo in the request"})
+    elif method == "sendMediaGroup":
+      #Uploaded photos (attach://<field>) or file_id of photos already uploaded
+      media = multipartField(body, contentType, "media") if isMultipart else form.get("media", [None])[0]
+      try:
+        media = json.loads(media)
+      except (TypeError, ValueError):
+        media = []
+      if not (2 <= len(media) <= 10):
+        self._respond(400, {"ok": False, "error_code": 400, "description": "Bad Request: wrong number of media"})
+        return
+      messages = []
+      for item in media:
+        reference = item.get("media", "")
+        if reference.startswith("attach://"):
+          photo = multipartField(body, contentType, reference[9:]) if isMultipart else None
+          if photo is None:
+            self._respond(400, {"ok": False, "error_code": 400, "description": "Bad Request: file " + reference + " not found"})
+            return
+          messages.append(self._photoMessage(photo))
+        else:
+          stats.add("photosByFileId")
+          messages.append(self.server.sendPhoto["result"])
+      self._respond(200, {"ok": True, "result": messages}, fault)
+    elif method == "sendMessage":
+      stats.add("messages")
+      self._respond(200, {"ok": True, "result": {"message_id": 1, "date": int(time.time()), "text": ""}}, fault)
+    else:
+      self._respond(200, {"ok": True, "result": True}, fault)
+
+
+class BotApiStandIn(http.server.ThreadingHTTPServer):
+  """Stand-in server, on loopback; port 0 picks a free port (see server_address)"""
+  daemon_threads = True
+
+  def __init__(self, port, conditions, updates="getupdates_10.json"):
+    super().__init__(("127.0.0.1", port), Handler)
+    self.conditions = conditions
+    self.stats = Stats()
+    with open(os.path.join(FIXTURES_DIR, updates)) as f:
+      self.updates = json.load(f)
+    with open(os.path.join(FIXTURES_DIR, "sendphoto.json")) as f:
+      self.sendPhoto = json.load(f)
+
+
+def main():
+  parser = argparse.ArgumentParser(description="Telegram Bot API stand-in")
+  parser.add_argument("--port", type=int, default=8081)
+  parser.add_argument("--latency", type=int, default=0, help="milliseconds before each response")
+  parser.add_argument("--bandwidth", type=int, default=0, help="KB/s cap of request and response bodies (0: none)")
+  parser.add_argument("--rate-limit", type=float, default=0.0, help="fraction of requests answered with 429")
+  parser.add_argument("--retry-after", type=int, default=1, help="retry_after of the 429 responses, in seconds")
+  parser.add_argument("--truncate", type=float, default=0.0, help="fraction of processed requests whose response is cut")
+  parser.add_argument("--updates", default="getupdates_10.json", help="getUpdates response, in the fixtures directory")
+  parser.add_argument("--seed", type=int, default=1)
+  args = parser.parse_args()
+
+  conditions = Conditions(args.latency, args.bandwidth, args.rate_limit, args.retry_after, args.truncate, args.seed)
+  server = BotApiStandIn(args.port, conditions, args.updates)
+  sys.stdout.write("port %d\n" % server.server_address[1])
+  sys.stdout.flush()
+  try:
+    server.serve_forever()
+  except KeyboardInterrupt:
+    pass
+
+
+if __name__ == "__main__":
+  main()
@@ -0,0 +1,16 @@
+/**
+ * @package Wildlife Camera
+ * Configuration of the host builds: the sample configuration
+ * @author WizLab.it
+ * @version 20261018.001
+ */
+
+#include "../config-sample.h"
+
+//Benchmarks: measurements compiled in, logs limited to errors so that standard output is JSON lines
+#ifdef HOST_BENCHMARK
+  #undef BENCHMARK_ENABLED
+  #define BENCHMARK_ENABLED true
+  #undef LOG_LEVEL
+  #define LOG_LEVEL 1
+#endif
@@ -0,0 +1,70 @@
+/**
+ * @package Wildlife Camera
+ * Host tests support
+ * @author WizLab.it
+ * @version 20261018.001
+ */
+
+#ifndef HOSTTEST_H
+#define HOSTTEST_H
+
+
+/**
+ * Includes
+ */
+#include <stdio.h>
+#include <stdlib.h>
+#include <string>
+#include <vector>
+
+
+/**
+ * Defines
+ * CHECK() reports the failed condition and goes on, so a run lists all the failures; TEST_RESULT() is the exit code
+ */
+#define CHECK(condition) hostCheck((condition), #condition, __FILE__, __LINE__)
+#define TEST_RESULT() hostTestResult(__FILE__)
+
+
+/**
+ * Functions
+ */
+static unsigned int __hostChecks = 0;
+static unsigned int __hostFailures = 0;
+
+static inline bool hostCheck(bool result, const char* condition, const char* file, int line) {
+  __hostChecks++;
+  if(!result) {
+    __hostFailures++;
+    fprintf(stderr, "%s:%d: check failed: %s\n", file, line, condition);
+  }
+  return result;
+}
+
+static inline int hostTestResult(const char* file) {
+  printf("%s: %u checks, %u failed\n", file, __hostChecks, __hostFailures);
+  return (__hostFailures == 0) ? 0 : 1;
+}
+
+//Temporary directory, removed by the caller
+static inline std::string hostTempDir(const char* name) {
+  std::string path = "/tmp/wildlife-" + std::string(name) + "-XXXXXX";
+  std::vector<char> buffer(path.begin(), path.end());
+  buffer.push_back('\0');
+  if(mkdtemp(buffer.data()) == NULL) return "";
+  return std::string(buffer.data());
+}
+
+static inline std::vector<uint8_t> hostReadFile(const std::string &path) {
+  std::vector<uint8_t> data;
+  FILE *file = fopen(path.c_str(), "rb");
+  if(file == NULL) return data;
+  uint8_t buffer[4096];
+  size_t rb;
+  while((rb = fread(buffer, 1, sizeof(buffer), file)) > 0) data.insert(data.end(), buffer, buffer + rb);
+  fclose(file);
+  return data;
+}
+
+
+#endif
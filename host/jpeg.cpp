@@ -0,0 +1,382 @@
+/**
+ * @package Wildlife Camera
+ * Synthetic photos for host tests and benchmarks
+ * @author WizLab.it
+ * @version 20261018.001
+ */
+
+#include "jpeg.h"
+#include <math.h>
+#include <string.h>
+
+
+/**
+ * Tables (ITU T.81 Annex K)
+ */
+static const uint8_t __zigzag[64] = {
+  0, 1, 8, 16, 9, 2, 3, 10, 17, 24, 32, 25, 18, 11, 4, 5, 12, 19, 26, 33, 40, 48, 41, 34, 27, 20, 13, 6, 7, 14, 21, 28,
+  35, 42, 49, 56, 57, 50, 43, 36, 29, 22, 15, 23, 30, 37, 44, 51, 58, 59, 52, 45, 38, 31, 39, 46, 53, 60, 61, 54, 47, 55, 62, 63
+};
+
+static const uint8_t __quantLuminance[64] = {
+  16, 11, 10, 16, 24, 40, 51, 61, 12, 12, 14, 19, 26, 58, 60, 55, 14, 13, 16, 24, 40, 57, 69, 56, 14, 17, 22, 29, 51, 87, 80, 62,
+  18, 22, 37, 56, 68, 109, 103, 77, 24, 35, 55, 64, 81, 104, 113, 92, 49, 64, 78, 87, 103, 121, 120, 101, 72, 92, 95, 98, 112, 100, 103, 99
+};
+
+static const uint8_t __quantChrominance[64] = {
+  17, 18, 24, 47, 99, 99, 99, 99, 18, 21, 26, 66, 99, 99, 99, 99, 24, 26, 56, 99, 99, 99, 99, 99, 47, 66, 99, 99, 99, 99, 99, 99,
+  99, 99, 99, 99, 99, 99, 99, 99, 99, 99, 99, 99, 99, 99, 99, 99, 99, 99, 99, 99, 99, 99, 99, 99, 99, 99, 99, 99, 99, 99, 99, 99
+};
+
+static const uint8_t __dcLuminanceCounts[16] = {0, 1, 5, 1, 1, 1, 1, 1, 1, 0, 0, 0, 0, 0, 0, 0};
+static const uint8_t __dcChrominanceCounts[16] = {0, 3, 1, 1, 1, 1, 1, 1, 1, 1, 1, 0, 0, 0, 0, 0};
+static const uint8_t __dcSymbols[12] = {0, 1, 2, 3, 4, 5, 6, 7, 8, 9, 10, 11};
+
+static const uint8_t __acLuminanceCounts[16] = {0, 2, 1, 3, 3, 2, 4, 3, 5, 5, 4, 4, 0, 0, 1, 0x7D};
+static const uint8_t __acLuminanceSymbols[162] = {
+  0x01, 0x02, 0x03, 0x00, 0x04, 0x11, 0x05, 0x12, 0x21, 0x31, 0x41, 0x06, 0x13, 0x51, 0x61, 0x07, 0x22, 0x71, 0x14, 0x32, 0x81, 0x91, 0xA1, 0x08,
+  0x23, 0x42, 0xB1, 0xC1, 0x15, 0x52, 0xD1, 0xF0, 0x24, 0x33, 0x62, 0x72, 0x82, 0x09, 0x0A, 0x16, 0x17, 0x18, 0x19, 0x1A, 0x25, 0x26, 0x27, 0x28,
+  0x29, 0x2A, 0x34, 0x35, 0x36, 0x37, 0x38, 0x39, 0x3A, 0x43, 0x44, 0x45, 0x46, 0x47, 0x48, 0x49, 0x4A, 0x53, 0x54, 0x55, 0x56, 0x57, 0x58, 0x59,
+  0x5A, 0x63, 0x64, 0x65, 0x66, 0x67, 0x68, 0x69, 0x6A, 0x73, 0x74, 0x75, 0x76, 0x77, 0x78, 0x79, 0x7A, 0x83, 0x84, 0x85, 0x86, 0x87, 0x88, 0x89,
+  0x8A, 0x92, 0x93, 0x94, 0x95, 0x96, 0x97, 0x98, 0x99, 0x9A, 0xA2, 0xA3, 0xA4, 0xA5, 0xA6, 0xA7, 0xA8, 0xA9, 0xAA, 0xB2, 0xB3, 0xB4, 0xB5, 0xB6,
+  0xB7, 0xB8, 0xB9, 0xBA, 0xC2, 0xC3, 0xC4, 0xC5, 0xC6, 0xC7, 0xC8, 0xC9, 0xCA, 0xD2, 0xD3, 0xD4, 0xD5, 0xD6, 0xD7, 0xD8, 0xD9, 0xDA, 0xE1, 0xE2,
+  0xE3, 0xE4, 0xE5, 0xE6, 0xE7, 0xE8, 0xE9, 0xEA, 0xF1, 0xF2, 0xF3, 0xF4, 0xF5, 0xF6, 0xF7, 0xF8, 0xF9, 0xFA
+};
+
+static const uint8_t __acChrominanceCounts[16] = {0, 2, 1, 2, 4, 4, 3, 4, 7, 5, 4, 4, 0, 1, 2, 0x77};
+static const uint8_t __acChrominanceSymbols[162] = {
+  0x00, 0x01, 0x02, 0x03, 0x11, 0x04, 0x05, 0x21, 0x31, 0x06, 0x12, 0x41, 0x51, 0x07, 0x61, 0x71, 0x13, 0x22, 0x32, 0x81, 0x08, 0x14, 0x42, 0x91,
+  0xA1, 0xB1, 0xC1, 0x09, 0x23, 0x33, 0x52, 0xF0, 0x15, 0x62, 0x72, 0xD1, 0x0A, 0x16, 0x24, 0x34, 0xE1, 0x25, 0xF1, 0x17, 0x18, 0x19, 0x1A, 0x26,
+  0x27, 0x28, 0x29, 0x2A, 0x35, 0x36, 0x37, 0x38, 0x39, 0x3A, 0x43, 0x44, 0x45, 0x46, 0x47, 0x48, 0x49, 0x4A, 0x53, 0x54, 0x55, 0x56, 0x57, 0x58,
+  0x59, 0x5A, 0x63, 0x64, 0x65, 0x66, 0x67, 0x68, 0x69, 0x6A, 0x73, 0x74, 0x75, 0x76, 0x77, 0x78, 0x79, 0x7A, 0x82, 0x83, 0x84, 0x85, 0x86, 0x87,
+  0x88, 0x89, 0x8A, 0x92, 0x93, 0x94, 0x95, 0x96, 0x97, 0x98, 0x99, 0x9A, 0xA2, 0xA3, 0xA4, 0xA5, 0xA6, 0xA7, 0xA8, 0xA9, 0xAA, 0xB2, 0xB3, 0xB4,
+  0xB5, 0xB6, 0xB7, 0xB8, 0xB9, 0xBA, 0xC2, 0xC3, 0xC4, 0xC5, 0xC6, 0xC7, 0xC8, 0xC9, 0xCA, 0xD2, 0xD3, 0xD4, 0xD5, 0xD6, 0xD7, 0xD8, 0xD9, 0xDA,
+  0xE2, 0xE3, 0xE4, 0xE5, 0xE6, 0xE7, 0xE8, 0xE9, 0xEA, 0xF2, 0xF3, 0xF4, 0xF5, 0xF6, 0xF7, 0xF8, 0xF9, 0xFA
+};
+
+
+/**
+ * Encoder
+ */
+struct HuffmanCode {
+  uint16_t code[256];
+  uint8_t length[256];
+};
+
+class JpegWriter {
+  private:
+    std::vector<uint8_t> &_out;
+    uint32_t _bitBuffer = 0;
+    uint8_t _bitCount = 0;
+
+  public:
+    JpegWriter(std::vector<uint8_t> &out) : _out(out) {}
+
+    void byte(uint8_t b) { _out.push_back(b); }
+    void word(uint16_t w) { byte(w >> 8); byte(w & 0xFF); }
+
+    //Entropy coded data: bytes 0xFF are followed by a stuffed 0x00
+    void bits(uint16_t code, uint8_t length) {
+      _bitBuffer = (_bitBuffer << length) | (code & ((1 << length) - 1));
+      _bitCount += length;
+      while(_bitCount >= 8) {
+        uint8_t b = (_bitBuffer >> (_bitCount - 8)) & 0xFF;
+        byte(b);
+        if(b == 0xFF) byte(0x00);
+        _bitCount -= 8;
+      }
+    }
+
+    void flush() {
+      if(_bitCount > 0) bits(0x7F, 8 - _bitCount);  //Padding with 1 bits
+    }
+};
+
+static void buildCodes(HuffmanCode &table, const uint8_t *counts, const uint8_t *symbols) {
+  uint16_t code = 0;
+  uint16_t k = 0;
+  memset(&table, 0, sizeof(table));
+  for(uint8_t length=1; length<=16; length++) {
+    for(uint8_t i=0; i<counts[length - 1]; i++) {
+      table.code[symbols[k]] = code++;
+      table.length[symbols[k]] = length;
+      k++;
+    }
+    code <<= 1;
+  }
+}
+
+static void writeHuffmanTable(JpegWriter &writer, uint8_t classAndId, const uint8_t *counts, const uint8_t *symbols) {
+  uint16_t total = 0;
+  for(uint8_t i=0; i<16; i++) total += counts[i];
+  writer.word(0xFFC4);
+  writer.word(2 + 1 + 16 + total);
+  writer.byte(classAndId);
+  for(uint8_t i=0; i<16; i++) writer.byte(counts[i]);
+  for(uint16_t i=0; i<total; i++) writer.byte(symbols[i]);
+}
+
+//Number of bits of a coefficient, and its representation (negative values are one's complement)
+static uint8_t magnitude(int value, uint16_t &bits) {
+  int absolute = (value < 0) ? -value : value;
+  uint8_t size = 0;
+  while(absolute > 0) {
+    size++;
+    absolute >>= 1;
+  }
+  bits = (value < 0) ? (value + (1 << size) - 1) : value;
+  return size;
+}
+
+static void encodeBlock(JpegWriter &writer, const float *samples, const float *quant, int &previousDc, const HuffmanCode &dc, const HuffmanCode &ac) {
+  static float cosines[8][8];
+  static bool cosinesReady = false;
+  if(!cosinesReady) {
+    for(uint8_t u=0; u<8; u++) {
+      for(uint8_t x=0; x<8; x++) cosines[u][x] = cosf(((2 * x + 1) * u * M_PI) / 16) * ((u == 0) ? sqrtf(0.125) : 0.5);
+    }
+    cosinesReady = true;
+  }
+
+  //Separable DCT: rows, then columns
+  float rows[64], coefficients[64];
+  for(uint8_t y=0; y<8; y++) {
+    for(uint8_t u=0; u<8; u++) {
+      float sum = 0;
+      for(uint8_t x=0; x<8; x++) sum += samples[(y * 8) + x] * cosines[u][x];
+      rows[(y * 8) + u] = sum;
+    }
+  }
+  for(uint8_t u=0; u<8; u++) {
+    for(uint8_t v=0; v<8; v++) {
+      float sum = 0;
+      for(uint8_t y=0; y<8; y++) sum += rows[(y * 8) + u] * cosines[v][y];
+      coefficients[(v * 8) + u] = sum;
+    }
+  }
+
+  int quantized[64];
+  for(uint8_t i=0; i<64; i++) quantized[i] = (int)lroundf(coefficients[__zigzag[i]] / quant[__zigzag[i]]);
+
+  //DC difference, then AC run lengths
+  uint16_t bits;
+  uint8_t size = magnitude(quantized[0] - previousDc, bits);
+  previousDc = quantized[0];
+  writer.bits(dc.code[size], dc.length[size]);
+  if(size > 0) writer.bits(bits, size);
+
+  uint8_t run = 0;
+  for(uint8_t i=1; i<64; i++) {
+    if(quantized[i] == 0) {
+      run++;
+      continue;
+    }
+    while(run >= 16) {
+      writer.bits(ac.code[0xF0], ac.length[0xF0]);
+      run -= 16;
+    }
+    size = magnitude(quantized[i], bits);
+    uint8_t symbol = (run << 4) | size;
+    writer.bits(ac.code[symbol], ac.length[symbol]);
+    writer.bits(bits, size);
+    run = 0;
+  }
+  if(run > 0) writer.bits(ac.code[0x00], ac.length[0x00]);
+}
+
+
+/**
+ * hostJpegEncode
+ * Encode an RGB image (3 bytes per pixel) as a baseline JPEG, YCbCr 4:2:2
+ * @param quality   1-100, as the IJG quality
+ */
+std::vector<uint8_t> hostJpegEncode(const std::vector<uint8_t> &rgb, uint16_t width, uint16_t height, uint8_t quality) {
+  std::vector<uint8_t> out;
+  out.reserve(width * height / 2);
+  JpegWriter writer(out);
+
+  //Quantization tables, scaled as in the IJG library
+  quality = (quality < 1) ? 1 : ((quality > 100) ? 100 : quality);
+  int scale = (quality < 50) ? (5000 / quality) : (200 - (2 * quality));
+  uint8_t quantTables[2][64];
+  float quant[2][64];
+  for(uint8_t i=0; i<64; i++) {
+    int luminance = (__quantLuminance[i] * scale + 50) / 100;
+    int chrominance = (__quantChrominance[i] * scale + 50) / 100;
+    quantTables[0][i] = (luminance < 1) ? 1 : ((luminance > 255) ? 255 : luminance);
+    quantTables[1][i] = (chrominance < 1) ? 1 : ((chrominance > 255) ? 255 : chrominance);
+    quant[0][i] = quantTables[0][i];
+    quant[1][i] = quantTables[1][i];
+  }
+
+  //Headers: SOI, APP0, DQT, SOF0, DHT, SOS
+  writer.word(0xFFD8);
+  const uint8_t app0[] = {0xFF, 0xE0, 0x00, 0x10, 'J', 'F', 'I', 'F', 0x00, 0x01, 0x01, 0x00, 0x00, 0x01, 0x00, 0x01, 0x00, 0x00};
+  out.insert(out.end(), app0, app0 + sizeof(app0));
+  for(uint8_t t=0; t<2; t++) {
+    writer.word(0xFFDB);
+    writer.word(67);
+    writer.byte(t);
+    for(uint8_t i=0; i<64; i++) writer.byte(quantTables[t][__zigzag[i]]);
+  }
+  writer.word(0xFFC0);
+  writer.word(17);
+  writer.byte(8);
+  writer.word(height);
+  writer.word(width);
+  writer.byte(3);
+  const uint8_t components[3][3] = {{1, 0x21, 0}, {2, 0x11, 1}, {3, 0x11, 1}};
+  for(uint8_t c=0; c<3; c++) {
+    for(uint8_t i=0; i<3; i++) writer.byte(components[c][i]);
+  }
+  writeHuffmanTable(writer, 0x00, __dcLuminanceCounts, __dcSymbols);
+  writeHuffmanTable(writer, 0x10, __acLuminanceCounts, __acLuminanceSymbols);
+  writeHuffmanTable(writer, 0x01, __dcChrominanceCounts, __dcSymbols);
+  writeHuffmanTable(writer, 0x11, __acChrominanceCounts, __acChrominanceSymbols);
+  const uint8_t sos[] = {0xFF, 0xDA, 0x00, 0x0C, 0x03, 0x01, 0x00, 0x02, 0x11, 0x03, 0x11, 0x00, 0x3F, 0x00};
+  out.insert(out.end(), sos, sos + sizeof(sos));
+
+  HuffmanCode dc[2], ac[2];
+  buildCodes(dc[0], __dcLuminanceCounts, __dcSymbols);
+  buildCodes(ac[0], __acLuminanceCounts, __acLuminanceSymbols);
+  buildCodes(dc[1], __dcChrominanceCounts, __dcSymbols);
+  buildCodes(ac[1], __acChrominanceCounts, __acChrominanceSymbols);
+
+  //MCUs of 16x8 pixels: two luminance blocks, then Cb and Cr subsampled horizontally
+  int previousDc[3] = {0, 0, 0};
+  for(uint16_t mcuY=0; mcuY<height; mcuY+=8) {
+    for(uint16_t mcuX=0; mcuX<width; mcuX+=16) {
+      float y[2][64], cb[64], cr[64];
+      for(uint8_t j=0; j<8; j++) {
+        for(uint8_t i=0; i<16; i++) {
+          uint16_t px = ((mcuX + i) < width) ? (mcuX + i) : (width - 1);
+          uint16_t py = ((mcuY + j) < height) ? (mcuY + j) : (height - 1);
+          const uint8_t *pixel = &rgb[((size_t)py * width + px) * 3];
+          float luminance = (0.299f * pixel[0]) + (0.587f * pixel[1]) + (0.114f * pixel[2]);
+          y[i / 8][(j * 8) + (i % 8)] = luminance - 128;
+          if((i % 2) == 0) {
+            cb[(j * 8) + (i / 2)] = (-0.168736f * pixel[0]) - (0.331264f * pixel[1]) + (0.5f * pixel[2]);
+            cr[(j * 8) + (i / 2)] = (0.5f * pixel[0]) - (0.418688f * pixel[1]) - (0.081312f * pixel[2]);
+          }
+        }
+      }
+      encodeBlock(writer, y[0], quant[0], previousDc[0], dc[0], ac[0]);
+      encodeBlock(writer, y[1], quant[0], previousDc[0], dc[0], ac[0]);
+      encodeBlock(writer, cb, quant[1], previousDc[1], dc[1], ac[1]);
+      encodeBlock(writer, cr, quant[1], previousDc[2], dc[1], ac[1]);
+    }
+  }
+  writer.flush();
+  writer.word(0xFFD9);
+  return out;
+}
+
+
+/**
+ * Scene
+ */
+static uint32_t hash(uint32_t x, uint32_t y, uint32_t seed) {
+  uint32_t h = (x * 374761393U) + (y * 668265263U) + (seed * 2246822519U);
+  h = (h ^ (h >> 13)) * 1274126177U;
+  return h ^ (h >> 16);
+}
+
+//Value noise, smooth between the points of a grid of the given cell size
+static float valueNoise(float x, float y, float cell, uint32_t seed) {
+  float gx = x / cell;
+  float gy = y / cell;
+  int x0 = (int)floorf(gx);
+  int y0 = (int)floorf(gy);
+  float fx = gx - x0;
+  float fy = gy - y0;
+  fx = fx * fx * (3 - 2 * fx);
+  fy = fy * fy * (3 - 2 * fy);
+  float v00 = (hash(x0, y0, seed) & 0xFFFF) / 65535.0f;
+  float v10 = (hash(x0 + 1, y0, seed) & 0xFFFF) / 65535.0f;
+  float v01 = (hash(x0, y0 + 1, seed) & 0xFFFF) / 65535.0f;
+  float v11 = (hash(x0 + 1, y0 + 1, seed) & 0xFFFF) / 65535.0f;
+  return (v00 * (1 - fx) + v10 * fx) * (1 - fy) + (v01 * (1 - fx) + v11 * fx) * fy;
+}
+
+
+/**
+ * hostSceneRender
+ * Render the scene as RGB, 3 bytes per pixel; coordinates are relative to the frame size, so the same scene
+ * looks the same at any resolution
+ */
+std::vector<uint8_t> hostSceneRender(const HostScene &scene, uint16_t width, uint16_t height) {
+  std::vector<uint8_t> rgb((size_t)width * height * 3);
+  float horizon = 0.42f + (((hash(1, 2, scene.seed) & 0xFF) / 255.0f) * 0.1f);
+  uint8_t trees = 3 + (hash(3, 4, scene.seed) % 4);
+
+  for(uint16_t py=0; py<height; py++) {
+    for(uint16_t px=0; px<width; px++) {
+      float x = ((float)px / width) + scene.shift;
+      float y = (float)py / height;
+      float r, g, b;
+
+      if(y < horizon) {
+        //Sky: gradient with clouds
+        float cloud = valueNoise(x * 640, y * 480, 60, scene.seed + 7);
+        r = 120 + (60 * y) + (70 * cloud);
+        g = 160 + (50 * y) + (60 * cloud);
+        b = 225 + (20 * cloud);
+      } else {
+        //Ground: grass texture at several scales
+        float texture = (0.5f * valueNoise(x * 1600, y * 1200, 40, scene.seed)) + (0.3f * valueNoise(x * 1600, y * 1200, 9, scene.seed + 1)) + (0.2f * valueNoise(x * 1600, y * 1200, 2.5f, scene.seed + 2));
+        r = 60 + (70 * texture);
+        g = 95 + (80 * texture);
+        b = 35 + (40 * texture);
+      }
+
+      //Trees: dark trunks with foliage
+      for(uint8_t t=0; t<trees; t++) {
+        float treeX = (hash(t, 5, scene.seed) % 1000) / 1000.0f;
+        float trunk = 0.012f + ((hash(t, 6, scene.seed) % 100) / 5000.0f);
+        if((fabsf(x - treeX) < trunk) && (y > (horizon - 0.25f)) && (y < (horizon + 0.15f))) {
+          float bark = valueNoise(x * 1600, y * 1200, 3, scene.seed + t);
+          r = 70 + (30 * bark);
+          g = 50 + (25 * bark);
+          b = 30 + (15 * bark);
+        } else if((((x - treeX) * (x - treeX)) + ((y - horizon + 0.3f) * (y - horizon + 0.3f) * 2)) < 0.006f) {
+          float leaves = valueNoise(x * 1600, y * 1200, 6, scene.seed + 10 + t);
+          r = 30 + (40 * leaves);
+          g = 80 + (70 * leaves);
+          b = 25 + (30 * leaves);
+        }
+      }
+
+      //Animal: brown ellipse with a lighter belly
+      if(scene.animal) {
+        float dx = (x - scene.shift - scene.animalX) / (scene.animalSize / 2);
+        float dy = (y - scene.animalY) / (scene.animalSize * 0.6f * width / height / 2);
+        if(((dx * dx) + (dy * dy)) < 1.0f) {
+          float fur = valueNoise(px, py, 4, 99);
+          r = 120 + (40 * fur) + ((dy > 0.4f) ? 50 : 0);
+          g = 80 + (30 * fur) + ((dy > 0.4f) ? 40 : 0);
+          b = 45 + (20 * fur) + ((dy > 0.4f) ? 30 : 0);
+        }
+      }
+
+      //Light level and sensor noise
+      float noise = 0;
+      if(scene.noiseSeed != 0) noise = ((int)(hash(px, py, scene.noiseSeed) % (2 * scene.noise + 1)) - scene.noise);
+      uint8_t *pixel = &rgb[((size_t)py * width + px) * 3];
+      float values[3] = {r, g, b};
+      for(uint8_t c=0; c<3; c++) {
+        float v = (values[c] * scene.brightness) + noise;
+        pixel[c] = (v < 0) ? 0 : ((v > 255) ? 255 : (uint8_t)v);
+      }
+    }
+  }
+  return rgb;
+}
+
+
+/**
+ * hostScenePhoto
+ * Render the scene and encode it as JPEG
+ */
+std::vector<uint8_t> hostScenePhoto(const HostScene &scene, uint16_t width, uint16_t height, uint8_t quality) {
+  return hostJpegEncode(hostSceneRender(scene, width, height), width, height, quality);
+}
@@ -0,0 +1,46 @@
+/**
+ * @package Wildlife Camera
+ * Synthetic photos for host tests and benchmarks header
+ * Baseline JPEG encoder (YCbCr 4:2:2 and standard Huffman tables, as produced by the OV2640) and a procedural
+ * outdoor scene, so inputs of any frame size are generated instead of being stored
+ * @author WizLab.it
+ * @version 20261018.001
+ */
+
+#ifndef JPEG_H
+#define JPEG_H
+
+
+/**
+ * Includes
+ */
+#include <stdint.h>
+#include <vector>
+
+
+/**
+ * Scene
+ * Sky, textured ground and trees, with an optional animal; noise is the sensor noise of a single shot
+ */
+struct HostScene {
+  uint32_t seed = 1;          //Texture of the ground and position of the trees
+  float brightness = 1.0;     //Light level (1.0: daylight)
+  float shift = 0.0;          //Horizontal camera shift, as a fraction of the width
+  bool animal = false;
+  float animalX = 0.5;        //Center of the animal, as fractions of width and height
+  float animalY = 0.7;
+  float animalSize = 0.15;    //Width of the animal, as a fraction of the width
+  uint32_t noiseSeed = 0;     //0: no sensor noise
+  uint8_t noise = 6;          //Sensor noise amplitude
+};
+
+
+/**
+ * Functions
+ */
+std::vector<uint8_t> hostJpegEncode(const std::vector<uint8_t> &rgb, uint16_t width, uint16_t height, uint8_t quality);
+std::vector<uint8_t> hostSceneRender(const HostScene &scene, uint16_t width, uint16_t height);
+std::vector<uint8_t> hostScenePhoto(const HostScene &scene, uint16_t width, uint16_t height, uint8_t quality = 85);
+
+
+#endif
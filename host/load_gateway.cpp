@@ -0,0 +1,191 @@
+/**
+ * @package Wildlife Camera
+ * LAN gateway load test: cameras (each in its own process, with the Telegram class in gateway mode) send photos,
+ * messages and poll commands through the gateway (gateway/gateway.py) to the Bot API stand-in (botapi_standin.py),
+ * under increasingly bad network conditions between the gateway and telegram. Every camera sends one of its photos
+ * twice, as after a lost response. Prints one JSON line per scenario: throughput, batching, what happened to each photo
+ * as seen by the stand-in, and the commands relayed to the cameras.
+ * @author WizLab.it
+ * @version 20261018.001
+ */
+
+#include <Arduino.h>
+#include <esp_camera.h>
+#include "telegram.h"
+#include "hosttest.h"
+#include "jpeg.h"
+#include "loadtest.h"
+#include "sketch.h"
+
+
+/**
+ * Defines
+ */
+#define LOAD_CAMERAS          6
+#define LOAD_PHOTOS           8     //Photos of each camera (the third one is sent twice)
+#define LOAD_TOKEN            "123456789:LoadTestToken"
+#define LOAD_CHAT_ID          -1001987654321LL
+#define LOAD_EXTRA_CHAT_ID    "234567891"
+#define LOAD_DRAIN_TIMEOUT    60000
+
+
+/**
+ * Scenario: stand-in conditions (between the gateway and telegram)
+ */
+struct Scenario {
+  const char* name;
+  const char* latency;      //Milliseconds
+  const char* bandwidth;    //KB/s
+  const char* rateLimit;    //Fraction of requests answered with 429
+  const char* truncate;     //Fraction of responses cut after the request was processed
+};
+
+static const Scenario __scenarios[] = {
+  {"clean", "20", "0", "0", "0"},
+  {"slow", "300", "256", "0", "0"},
+  {"ratelimit", "50", "1024", "0.2", "0"},
+  {"lossy", "150", "512", "0.1", "0.1"},
+};
+
+
+/**
+ * Commands of fixtures/getupdates_gateway.json: /status and /photo@WildlifeCamBot to all the cameras, /photo@cam1 and
+ * /blink@cam1 to cam1, /status@cam4 to cam4; the other updates are not commands
+ */
+static uint16_t expectedCommands(uint8_t camera) {
+  if(camera == 1) return 4;
+  if(camera == 4) return 3;
+  return 2;
+}
+
+static uint16_t __commands = 0;
+
+static void commandProcessor(const char* command) {
+  __commands++;
+}
+
+
+/**
+ * Camera
+ * Photos of different scenes for each camera; commands are polled after each photo, then until all have arrived
+ */
+static void runCamera(uint8_t camera, uint16_t gatewayPort, bool clean) {
+  std::vector<std::vector<uint8_t>> photos;
+  uint16_t width, height;
+  hostFrameSizeGetDimensions(FRAMESIZE_VGA, &width, &height);
+  for(uint16_t i=0; i<LOAD_PHOTOS; i++) {
+    HostScene scene;
+    scene.animal = ((i % 2) == 0);
+    scene.noiseSeed = 1 + (camera * 100) + i;
+    photos.push_back(hostScenePhoto(scene, width, height));
+  }
+  photos.push_back(photos[2]);
+
+  Telegram telegram(LOAD_TOKEN, LOAD_CHAT_ID, commandProcessor);
+  telegram.addChatIds(LOAD_EXTRA_CHAT_ID);
+  telegram.setGateway("127.0.0.1", gatewayPort, "cam" + String(camera));
+  uint32_t tlsClients = WiFiClientSecure::hostGetInstances();
+  uint16_t reportedOk = 0;
+  for(std::vector<uint8_t> &photo : photos) {
+    setWakeupEnd(120);
+    if(telegram.sendPhoto(photo.data(), photo.size()) == 0) reportedOk++;
+    telegram.getUpdates();
+  }
+  for(uint8_t i=0; (i < 50) && (__commands < expectedCommands(camera)); i++) {
+    delay(200);
+    telegram.getUpdates();
+  }
+  int8_t messageStatus = telegram.sendMessage("cam" + String(camera) + ": load test done");
+
+  //All the photos are accepted by the gateway, commands arrive once, and no TLS client is ever created
+  CHECK(reportedOk == photos.size());
+  CHECK(__commands == expectedCommands(camera));
+  CHECK(WiFiClientSecure::hostGetInstances() == tlsClients);
+  if(clean) CHECK(messageStatus == 0);
+}
+
+
+/**
+ * Run a scenario
+ */
+static void runScenario(const Scenario &scenario) {
+  pid_t standin = -1, gateway = -1;
+  uint16_t standinPort = hostServerStart({"python3", HOST_STANDIN, "--port", "0", "--latency", scenario.latency, "--bandwidth", scenario.bandwidth,
+    "--rate-limit", scenario.rateLimit, "--truncate", scenario.truncate, "--updates", "getupdates_gateway.json"}, standin);
+  std::string devices = "";
+  for(uint8_t camera=0; camera<LOAD_CAMERAS; camera++) devices += ((camera > 0) ? ",cam" : "cam") + std::to_string(camera);
+  uint16_t gatewayPort = hostServerStart({"python3", HOST_GATEWAY, "--listen", "127.0.0.1", "--port", "0", "--token", LOAD_TOKEN,
+    "--chat-id", std::to_string(LOAD_CHAT_ID), "--chat-id", LOAD_EXTRA_CHAT_ID, "--api", "http://127.0.0.1:" + std::to_string(standinPort),
+    "--devices", devices, "--batch-delay", "0.5", "--poll-interval", "0.2", "--backoff", "0.2"}, gateway);
+  CHECK((standinPort > 0) && (gatewayPort > 0));
+  if((standinPort == 0) || (gatewayPort == 0)) {
+    hostServerStop(gateway);
+    hostServerStop(standin);
+    return;
+  }
+  bool clean = (strcmp(scenario.rateLimit, "0") == 0) && (strcmp(scenario.truncate, "0") == 0);
+
+  //Cameras
+  unsigned long start = millis();
+  pid_t cameras[LOAD_CAMERAS];
+  fflush(stdout);
+  for(uint8_t camera=0; camera<LOAD_CAMERAS; camera++) {
+    cameras[camera] = fork();
+    if(cameras[camera] == 0) {
+      runCamera(camera, gatewayPort, clean);
+      int result = (__hostFailures == 0) ? 0 : 1;
+      fflush(stdout);
+      _exit(result);
+    }
+  }
+  for(uint8_t camera=0; camera<LOAD_CAMERAS; camera++) {
+    int status = -1;
+    waitpid(cameras[camera], &status, 0);
+    CHECK(WIFEXITED(status) && (WEXITSTATUS(status) == 0));
+  }
+
+  //Wait for the gateway queue to be sent
+  JsonDocument status;
+  bool drained = false;
+  while(!drained && ((millis() - start) < LOAD_DRAIN_TIMEOUT)) {
+    drained = hostServerJson(gatewayPort, "/status", status) && (status["queue"].as<long>() == 0) && (status["in_flight"].as<long>() == 0);
+    if(!drained) delay(100);
+  }
+  CHECK(drained);
+  unsigned long duration = max(millis() - start, 1UL);
+
+  JsonDocument stats;
+  CHECK(hostServerJson(standinPort, "/stats", stats));
+  hostServerStop(gateway);
+  hostServerStop(standin);
+
+  long photos = LOAD_CAMERAS * LOAD_PHOTOS;
+  long delivered = stats["photos_unique"].as<long>();
+  long duplicated = stats["photos_duplicated"].as<long>();
+  long uploads = stats["requests"]["sendPhoto"].as<long>() + stats["requests"]["sendMediaGroup"].as<long>();
+  JsonVariant gatewayStats = status["stats"];
+  printf("{\"load\":\"gateway\",\"scenario\":\"%s\",\"cameras\":%u,\"photos\":%ld,\"seconds\":%0.1f,\"photos_per_second\":%0.1f,\"upload_requests\":%ld,"
+    "\"batches\":%ld,\"retries\":%ld,\"rate_limited\":%ld,\"truncated\":%ld,\"delivered\":%ld,\"duplicated\":%ld,\"deduplicated\":%ld,\"unconfirmed\":%ld,"
+    "\"forwarded\":%ld,\"commands\":%ld,\"commands_relayed\":%ld}\n",
+    scenario.name, LOAD_CAMERAS, photos, (duration / 1000.0), (photos * 1000.0 / duration), uploads, gatewayStats["batches"].as<long>(),
+    gatewayStats["retries"].as<long>(), stats["rate_limited"].as<long>(), stats["truncated"].as<long>(), delivered, duplicated,
+    gatewayStats["photos_duplicated"].as<long>(), gatewayStats["photos_unconfirmed"].as<long>(), stats["photos_by_file_id"].as<long>(),
+    gatewayStats["commands"].as<long>(), gatewayStats["commands_relayed"].as<long>());
+  fflush(stdout);
+
+  //Every photo is delivered once, resent photos are caught by the gateway, uploads are batched
+  CHECK(delivered == photos);
+  CHECK(duplicated == 0);
+  CHECK(gatewayStats["photos_duplicated"].as<long>() == LOAD_CAMERAS);
+  CHECK((uploads - stats["rate_limited"].as<long>()) <= (photos / 2));
+  CHECK(gatewayStats["commands"].as<long>() == 5);
+  if(clean) CHECK(stats["photos_by_file_id"].as<long>() == photos);
+  if(clean) CHECK(stats["messages"].as<long>() == LOAD_CAMERAS);
+}
+
+
+int main() {
+  hostSetTimestamp(1792300000);
+  for(const Scenario &scenario : __scenarios) runScenario(scenario);
+  return TEST_RESULT();
+}
@@ -0,0 +1,107 @@
+/**
+ * @package Wildlife Camera
+ * Telegram load test: photo uploads through the Telegram class to the Bot API stand-in (botapi_standin.py), under
+ * increasingly bad network conditions. Prints one JSON line per scenario: throughput, retries and what happened to
+ * each photo, as seen by the stand-in (delivered, duplicated, lost, delivered but reported as failed).
+ * @author WizLab.it
+ * @version 20261018.001
+ */
+
+#include <Arduino.h>
+#include <esp_camera.h>
+#include "telegram.h"
+#include "hosttest.h"
+#include "jpeg.h"
+#include "loadtest.h"
+#include "sketch.h"
+
+
+/**
+ * Scenario: stand-in conditions and number of photos
+ */
+struct Scenario {
+  const char* name;
+  const char* latency;      //Milliseconds
+  const char* bandwidth;    //KB/s
+  const char* rateLimit;    //Fraction of requests answered with 429
+  const char* truncate;     //Fraction of responses cut after the request was processed
+  uint16_t photos;
+};
+
+static const Scenario __scenarios[] = {
+  {"clean", "20", "0", "0", "0", 10},
+  {"slow", "300", "128", "0", "0", 6},
+  {"ratelimit", "50", "512", "0.2", "0", 12},
+  {"lossy", "150", "256", "0.1", "0.1", 20},
+};
+
+
+/**
+ * Run a scenario
+ * Every photo has a different content, so the stand-in can tell duplicates from different photos
+ */
+static void runScenario(const Scenario &scenario) {
+  pid_t standin = -1;
+  uint16_t port = hostServerStart({"python3", HOST_STANDIN, "--port", "0", "--latency", scenario.latency, "--bandwidth", scenario.bandwidth,
+    "--rate-limit", scenario.rateLimit, "--truncate", scenario.truncate}, standin);
+  CHECK(port > 0);
+  if(port == 0) {
+    hostServerStop(standin);
+    return;
+  }
+  char redirect[32];
+  snprintf(redirect, sizeof(redirect), "127.0.0.1:%u", port);
+  setenv("HOST_TLS_REDIRECT", redirect, 1);
+
+  const framesize_t frameSizes[] = {FRAMESIZE_VGA, FRAMESIZE_SVGA, FRAMESIZE_XGA};
+  std::vector<std::vector<uint8_t>> photos;
+  for(uint16_t i=0; i<scenario.photos; i++) {
+    uint16_t width, height;
+    hostFrameSizeGetDimensions(frameSizes[i % 3], &width, &height);
+    HostScene scene;
+    scene.animal = ((i % 2) == 0);
+    scene.noiseSeed = 1 + i;
+    photos.push_back(hostScenePhoto(scene, width, height));
+  }
+
+  Telegram telegram("123456789:LoadTestToken", -1001987654321LL);
+  uint32_t requestsBefore = telegram.getStatsRequests();
+  uint32_t retriesBefore = telegram.getStatsRetries();
+  uint16_t reportedOk = 0;
+  long bytesOk = 0;
+  unsigned long start = millis();
+  for(std::vector<uint8_t> &photo : photos) {
+    setWakeupEnd(120);
+    if(telegram.sendPhoto(photo.data(), photo.size()) == 0) {
+      reportedOk++;
+      bytesOk += photo.size();
+    }
+  }
+  unsigned long duration = max(millis() - start, 1UL);
+
+  JsonDocument stats;
+  CHECK(hostServerJson(port, "/stats", stats));
+  hostServerStop(standin);
+  long delivered = stats["photos_unique"].as<long>();
+  long duplicated = stats["photos_duplicated"].as<long>();
+
+  printf("{\"load\":\"telegram.sendPhoto\",\"scenario\":\"%s\",\"photos\":%u,\"seconds\":%0.1f,\"kbps\":%0.1f,\"requests\":%u,\"retries\":%u,"
+    "\"rate_limited\":%ld,\"truncated\":%ld,\"reported_ok\":%u,\"delivered\":%ld,\"duplicated\":%ld,\"lost\":%ld,\"unconfirmed\":%ld}\n",
+    scenario.name, scenario.photos, (duration / 1000.0), ((bytesOk / 1024.0) * 1000.0 / duration), (telegram.getStatsRequests() - requestsBefore),
+    (telegram.getStatsRetries() - retriesBefore), stats["rate_limited"].as<long>(), stats["truncated"].as<long>(), reportedOk, delivered,
+    duplicated, (scenario.photos - delivered), (delivered - reportedOk));
+  fflush(stdout);
+
+  //No photo is delivered twice, and no photo reported as sent is missing
+  CHECK(duplicated == 0);
+  CHECK(delivered >= reportedOk);
+  if(strcmp(scenario.truncate, "0") == 0) CHECK(delivered == reportedOk);
+  if(strcmp(scenario.name, "clean") == 0) CHECK(reportedOk == scenario.photos);
+}
+
+
+int main() {
+  hostSetTimestamp(1792300000);
+  for(const Scenario &scenario : __scenarios) runScenario(scenario);
+  return TEST_RESULT();
+}
@@ -0,0 +1,90 @@
+/**
+ * @package Wildlife Camera
+ * Load tests support: servers run as child processes (botapi_standin.py, gateway.py) and their JSON counters
+ * @author WizLab.it
+ * @version 20261018.001
+ */
+
+#ifndef LOADTEST_H
+#define LOADTEST_H
+
+
+/**
+ * Includes
+ */
+#include <ArduinoJson.h>
+#include <arpa/inet.h>
+#include <signal.h>
+#include <string.h>
+#include <sys/socket.h>
+#include <sys/wait.h>
+#include <unistd.h>
+#include <string>
+#include <vector>
+
+
+/**
+ * Functions
+ */
+
+//Start a server that prints "port <n>" on its first line; returns the port (0 if failed)
+static inline uint16_t hostServerStart(const std::vector<std::string> &args, pid_t &pid) {
+  int fds[2];
+  if(pipe(fds) != 0) return 0;
+  pid = fork();
+  if(pid == 0) {
+    dup2(fds[1], STDOUT_FILENO);
+    close(fds[0]);
+    close(fds[1]);
+    std::vector<char*> argv;
+    for(const std::string &arg : args) argv.push_back((char*)arg.c_str());
+    argv.push_back(NULL);
+    execvp(argv[0], argv.data());
+    _exit(127);
+  }
+  close(fds[1]);
+  char line[32] = {0};
+  size_t used = 0;
+  while((used < (sizeof(line) - 1)) && (strchr(line, '\n') == NULL)) {
+    ssize_t rb = read(fds[0], line + used, sizeof(line) - 1 - used);
+    if(rb <= 0) break;
+    used += rb;
+  }
+  close(fds[0]);
+  unsigned int port = 0;
+  if((strchr(line, '\n') == NULL) || (sscanf(line, "port %u", &port) != 1)) return 0;
+  return port;
+}
+
+static inline void hostServerStop(pid_t &pid) {
+  if(pid <= 0) return;
+  kill(pid, SIGTERM);
+  waitpid(pid, NULL, 0);
+  pid = -1;
+}
+
+//GET of a JSON document (the server closes the connection after the response)
+static inline bool hostServerJson(uint16_t port, const char* path, JsonDocument &json) {
+  int s = socket(AF_INET, SOCK_STREAM, 0);
+  struct sockaddr_in address = {};
+  address.sin_family = AF_INET;
+  address.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+  address.sin_port = htons(port);
+  if(connect(s, (struct sockaddr *)&address, sizeof(address)) != 0) {
+    close(s);
+    return false;
+  }
+  std::string request = "GET " + std::string(path) + " HTTP/1.1\r\nHost: localhost\r\n\r\n";
+  send(s, request.c_str(), request.size(), MSG_NOSIGNAL);
+  std::string response;
+  char buffer[1024];
+  ssize_t rb;
+  while((rb = recv(s, buffer, sizeof(buffer), 0)) > 0) response.append(buffer, rb);
+  close(s);
+  size_t body = response.find("\r\n\r\n");
+  if(body == std::string::npos) return false;
+  return !deserializeJson(json, response.c_str() + body + 4);
+}
+
+
+#endif
@@ -0,0 +1,94 @@
+/**
+ * @package Wildlife Camera
+ * Host build of the sketch functions used by the modules (extern.h)
+ * @author WizLab.it
+ * @version 20261018.001
+ */
+
+#include "sketch.h"
+#include "config.h"
+
+
+/**
+ * Variables
+ */
+static unsigned long __hostTimestamp = 0;         //0: host clock
+static unsigned long __hostTimestampMillis = 0;   //millis() when the timestamp was set
+static uint32_t __hostBatteryMillivolts = 4200 * _LOWBATTERY_NUMBER_OF_BATTERIES;
+static unsigned long __hostWakeupEnd = 0;
+static long __hostUtcOffset = (NTP_TIMEZONE * 3600);
+
+
+/**
+ * Host controls
+ */
+void hostSetTimestamp(unsigned long timestamp) {
+  __hostTimestamp = timestamp;
+  __hostTimestampMillis = millis();
+}
+
+void hostSetUtcOffset(long offset) {
+  __hostUtcOffset = offset;
+}
+
+void hostSetBatteryMillivolts(uint32_t millivolts) {
+  __hostBatteryMillivolts = millivolts;
+}
+
+
+/**
+ * Sketch functions
+ */
+unsigned long setWakeupEnd(unsigned long increase) {
+  unsigned long newEnd = millis() + (increase * 1000);
+  if(newEnd > __hostWakeupEnd) __hostWakeupEnd = newEnd;
+  return __hostWakeupEnd;
+}
+
+unsigned long getWakeupRemaining() {
+  unsigned long now = millis();
+  return (__hostWakeupEnd > now) ? (__hostWakeupEnd - now) : 0;
+}
+
+unsigned long getTimestamp() {
+  if(__hostTimestamp != 0) return __hostTimestamp + ((millis() - __hostTimestampMillis) / 1000);
+  return time(NULL);
+}
+
+unsigned long getUptime() {
+  return millis() / 1000;
+}
+
+String getDateFormat(String format, time_t timestamp) {
+  time_t now = (timestamp != 0) ? timestamp : getTimestamp();
+  struct tm timeinfo;
+  char datetime[50];
+  gmtime_r(&now, &timeinfo);
+  strftime(datetime, sizeof(datetime), format.c_str(), &timeinfo);
+  return String(datetime);
+}
+
+int8_t getHour(unsigned long timestamp) {
+  if(timestamp == 0) timestamp = getTimestamp();
+  if(timestamp < 1000000000) return -1;
+  return ((timestamp + __hostUtcOffset) / 3600) % 24;
+}
+
+uint32_t getBatteryVoltage(bool getRaw) {
+  return getRaw ? (uint32_t)(__hostBatteryMillivolts / _LOWBATTERY_VDIV_RATIO) : __hostBatteryMillivolts;
+}
+
+uint8_t getBatteryLevel() {
+  uint32_t batteryVoltageMillivolts = getBatteryVoltage(false);
+  if(batteryVoltageMillivolts < (3000 * _LOWBATTERY_NUMBER_OF_BATTERIES)) return 5;
+  if(batteryVoltageMillivolts > (4000 * _LOWBATTERY_NUMBER_OF_BATTERIES)) return 5;
+  if(batteryVoltageMillivolts > (3900 * _LOWBATTERY_NUMBER_OF_BATTERIES)) return 4;
+  if(batteryVoltageMillivolts > (3800 * _LOWBATTERY_NUMBER_OF_BATTERIES)) return 3;
+  if(batteryVoltageMillivolts > (3700 * _LOWBATTERY_NUMBER_OF_BATTERIES)) return 2;
+  if(batteryVoltageMillivolts > (3600 * _LOWBATTERY_NUMBER_OF_BATTERIES)) return 1;
+  return 0;
+}
+
+float cameraSdGetUsedSpace() {
+  return 0.0;
+}
@@ -0,0 +1,29 @@
+/**
+ * @package Wildlife Camera
+ * Host build of the sketch functions used by the modules (extern.h) header
+ * @author WizLab.it
+ * @version 20261018.001
+ */
+
+#ifndef SKETCH_H
+#define SKETCH_H
+
+
+/**
+ * Includes
+ */
+#include <Arduino.h>
+#include "extern.h"
+
+
+/**
+ * Functions
+ * Time is the host clock, in UTC, unless set with hostSetTimestamp(); getHour() uses the offset set with
+ * hostSetUtcOffset() (as the sketch, with the offset saved when the timezone is set); the battery voltage is set by the test
+ */
+void hostSetTimestamp(unsigned long timestamp);
+void hostSetUtcOffset(long offset);
+void hostSetBatteryMillivolts(uint32_t millivolts);
+
+
+#endif
@@ -0,0 +1,234 @@
+/**
+ * @package Wildlife Camera
+ * Clip test: AVI files written from a synthetic frame source are parsed back and checked
+ * @author WizLab.it
+ * @version 20261018.001
+ */
+
+#include <Arduino.h>
+#include "FS.h"
+#include "clip.h"
+#include "hosttest.h"
+#include <unistd.h>
+
+
+/**
+ * MemoryFileImpl
+ * File in memory, whose Nth write call can be made to fail (after writing half of the data, as a card failing mid-write)
+ */
+class MemoryFileImpl : public fs::FileImpl {
+  public:
+    std::vector<uint8_t> data;
+    size_t pos = 0;
+    int writes = 0;
+    int failWrite = -1;   //Index of the write call that fails (-1: none)
+
+    size_t write(const uint8_t *buffer, size_t size) override {
+      if(writes++ == failWrite) size /= 2;
+      if(data.size() < (pos + size)) data.resize(pos + size);
+      memcpy(data.data() + pos, buffer, size);
+      pos += size;
+      return (writes == (failWrite + 1)) ? 0 : size;
+    }
+    size_t read(uint8_t *buffer, size_t size) override { return 0; }
+    bool seek(uint32_t position, fs::SeekMode mode) override { pos = position; return true; }
+    size_t position() const override { return pos; }
+    size_t size() const override { return data.size(); }
+    void close() override {}
+    const char* path() const override { return "/memory.avi"; }
+    const char* name() const override { return "memory.avi"; }
+    operator bool() override { return true; }
+};
+
+
+/**
+ * Synthetic frame source: JPEG markers around a pattern, odd and even lengths
+ */
+static std::vector<uint8_t> syntheticFrame(uint16_t n) {
+  std::vector<uint8_t> frame(3000 + ((n * 613) % 2000));
+  for(size_t i=0; i<frame.size(); i++) frame[i] = (uint8_t)((i * 7) + n);
+  frame[0] = 0xFF;
+  frame[1] = 0xD8;
+  frame[frame.size() - 2] = 0xFF;
+  frame[frame.size() - 1] = 0xD9;
+  return frame;
+}
+
+static uint32_t getU32(const std::vector<uint8_t> &data, size_t offset) {
+  if((offset + 4) > data.size()) return 0;
+  return data[offset] | (data[offset + 1] << 8) | (data[offset + 2] << 16) | ((uint32_t)data[offset + 3] << 24);
+}
+
+static bool isFourcc(const std::vector<uint8_t> &data, size_t offset, const char* fourcc) {
+  return ((offset + 4) <= data.size()) && (memcmp(data.data() + offset, fourcc, 4) == 0);
+}
+
+
+/**
+ * checkAvi
+ * Parse an AVI written by Clip: RIFF and list sizes, headers, every frame through idx1
+ * @return    Measured stream rate (dwRate / dwScale)
+ */
+static double checkAvi(const std::vector<uint8_t> &avi, const std::vector<std::vector<uint8_t>> &frames, uint16_t width, uint16_t height) {
+  CHECK(isFourcc(avi, 0, "RIFF"));
+  CHECK(getU32(avi, 4) == (avi.size() - 8));
+  CHECK(isFourcc(avi, 8, "AVI "));
+  CHECK(isFourcc(avi, 12, "LIST") && isFourcc(avi, 20, "hdrl"));
+  CHECK((20 + getU32(avi, 16)) == 212);
+
+  //avih
+  CHECK(isFourcc(avi, 24, "avih") && (getU32(avi, 28) == 56));
+  uint32_t microSecPerFrame = getU32(avi, 32);
+  CHECK(getU32(avi, 48) == frames.size());
+  CHECK(getU32(avi, 56) == 1);
+  CHECK((getU32(avi, 64) == width) && (getU32(avi, 68) == height));
+
+  //strh: rate and scale, consistent with dwMicroSecPerFrame
+  CHECK(isFourcc(avi, 100, "strh") && isFourcc(avi, 108, "vids") && isFourcc(avi, 112, "MJPG"));
+  uint32_t scale = getU32(avi, 128);
+  uint32_t rate = getU32(avi, 132);
+  CHECK(scale > 0);
+  double fps = (scale > 0) ? ((double)rate / scale) : 0;
+  CHECK(fabs((fps * microSecPerFrame / 1000000.0) - 1.0) < 0.001);
+  CHECK(getU32(avi, 140) == frames.size());
+
+  //movi list, then idx1 right after it
+  CHECK(isFourcc(avi, 212, "LIST") && isFourcc(avi, 220, "movi"));
+  size_t idx1 = 220 + getU32(avi, 216);
+  CHECK(isFourcc(avi, idx1, "idx1"));
+  CHECK(getU32(avi, idx1 + 4) == (frames.size() * 16));
+  size_t end = idx1 + 8 + (frames.size() * 16);
+  if(end < avi.size()) {
+    CHECK(isFourcc(avi, end, "JUNK") && ((end + 8 + getU32(avi, end + 4)) == avi.size()) && ((avi.size() % 2) == 0));
+  } else {
+    CHECK(end == avi.size());
+  }
+
+  //Frames, through the index
+  for(size_t i=0; i<frames.size(); i++) {
+    size_t entry = idx1 + 8 + (i * 16);
+    size_t chunk = 220 + getU32(avi, entry + 8);
+    CHECK(isFourcc(avi, entry, "00dc") && (getU32(avi, entry + 4) == 0x10));
+    CHECK(getU32(avi, entry + 12) == frames[i].size());
+    CHECK(isFourcc(avi, chunk, "00dc") && (getU32(avi, chunk + 4) == frames[i].size()));
+    CHECK(((chunk + 8 + frames[i].size()) <= avi.size()) && (memcmp(avi.data() + chunk + 8, frames[i].data(), frames[i].size()) == 0));
+    CHECK((chunk % 2) == 0);
+  }
+
+  return fps;
+}
+
+
+/**
+ * Non-integer frame rate, written on the directory-backed file system
+ */
+static void testNonIntegerFrameRate() {
+  std::string root = hostTempDir("clip");
+  fs::FS fs(root.c_str());
+  std::vector<std::vector<uint8_t>> frames;
+
+  Clip clip;
+  CHECK(clip.open(fs.open("/clip.avi", FILE_WRITE)));
+  for(uint16_t i=0; i<12; i++) {
+    frames.push_back(syntheticFrame(i));
+    hostAdvanceMillis(75); //13.33 fps
+    CHECK(clip.addFrame(frames[i].data(), frames[i].size(), 640, 480));
+  }
+  CHECK(clip.close());
+
+  std::vector<uint8_t> avi = hostReadFile(root + "/clip.avi");
+  CHECK(avi.size() == clip.getBytes());
+  double fps = checkAvi(avi, frames, 640, 480);
+  printf("12 frames at 75 ms: %0.3f fps in the header, %0.3f fps measured\n", fps, clip.getFps());
+  CHECK(fabs(fps - (1000.0 / 75)) < 0.1);
+  CHECK(fabs(fps - clip.getFps()) < 0.001);
+  CHECK(fabs((getU32(avi, 32) / 1000.0) - 75) < 1.0);
+
+  fs.remove("/clip.avi");
+  rmdir(root.c_str());
+}
+
+
+/**
+ * Failed pad byte write: the frame is not added, and the following frames overwrite it
+ */
+static void testPadByteFailure() {
+  std::shared_ptr<MemoryFileImpl> file = std::make_shared<MemoryFileImpl>();
+  std::vector<std::vector<uint8_t>> frames;
+  std::vector<uint8_t> oddFrame = syntheticFrame(1);
+  CHECK(oddFrame.size() & 1);
+
+  //Writes: header, then chunk header, data and pad byte for each odd frame
+  file->failWrite = 1 + (2 * 3) + 2;
+
+  Clip clip;
+  CHECK(clip.open(File(file)));
+  for(uint16_t i=0; i<2; i++) {
+    frames.push_back(oddFrame);
+    CHECK(clip.addFrame(oddFrame.data(), oddFrame.size(), 320, 240));
+  }
+  hostAdvanceMillis(100);
+  CHECK(!clip.addFrame(oddFrame.data(), oddFrame.size(), 320, 240));
+  for(uint16_t i=0; i<2; i++) {
+    frames.push_back(syntheticFrame(2 + i));
+    CHECK(clip.addFrame(frames.back().data(), frames.back().size(), 320, 240));
+  }
+  CHECK(clip.close());
+  CHECK(clip.getFrames() == 4);
+
+  //The following frames are written over the partial chunk
+  CHECK(file->data.size() == clip.getBytes());
+  checkAvi(file->data, frames, 320, 240);
+}
+
+
+/**
+ * Failed frame write at the end of the clip: the index is written over the partial chunk, the bytes left after it
+ * are covered by a JUNK chunk, so the RIFF spans the whole file
+ */
+static void testFrameFailure() {
+  std::shared_ptr<MemoryFileImpl> file = std::make_shared<MemoryFileImpl>();
+  std::vector<std::vector<uint8_t>> frames;
+
+  //The data write of the fourth frame fails (half written), and it is the last one
+  Clip clip;
+  CHECK(clip.open(File(file)));
+  for(uint16_t i=0; i<3; i++) {
+    frames.push_back(syntheticFrame(i));
+    CHECK(clip.addFrame(frames[i].data(), frames[i].size(), 320, 240));
+  }
+  file->failWrite = file->writes + 1;
+  std::vector<uint8_t> failed = syntheticFrame(3);
+  hostAdvanceMillis(100);
+  CHECK(!clip.addFrame(failed.data(), failed.size(), 320, 240));
+  CHECK(clip.close());
+  CHECK(clip.getFrames() == 3);
+
+  size_t end = 220 + getU32(file->data, 216) + 8 + (frames.size() * 16);
+  CHECK(isFourcc(file->data, end, "JUNK"));
+  CHECK(file->data.size() == clip.getBytes());
+  checkAvi(file->data, frames, 320, 240);
+}
+
+
+/**
+ * Empty clip: not valid, header still consistent
+ */
+static void testEmptyClip() {
+  std::shared_ptr<MemoryFileImpl> file = std::make_shared<MemoryFileImpl>();
+  Clip clip;
+  CHECK(clip.open(File(file)));
+  CHECK(!clip.close());
+  CHECK(file->data.size() == clip.getBytes());
+  CHECK(getU32(file->data, 32) == 0);
+  CHECK(getU32(file->data, 128) > 0);
+}
+
+
+int main() {
+  testNonIntegerFrameRate();
+  testPadByteFailure();
+  testFrameFailure();
+  testEmptyClip();
+  return TEST_RESULT();
+}
@@ -0,0 +1,61 @@
+/**
+ * @package Wildlife Camera
+ * Event log test: when digests are due, and what they report
+ * @author WizLab.it
+ * @version 20261018.001
+ */
+
+#include <Arduino.h>
+#include "config.h"
+#include "eventlog.h"
+#include "hosttest.h"
+#include "sketch.h"
+
+
+/**
+ * Defines
+ */
+#define TEST_START    1792300000UL
+
+
+int main() {
+  EventLog eventLog(EVENTLOG_DIGEST_INTERVAL, EVENTLOG_IMPORTANCE_THRESHOLD);
+  hostSetTimestamp(TEST_START);
+  eventLog.clear();
+  CHECK(!eventLog.isDigestDue());
+
+  //Battery samples only (one per wake up): no digest, even after several intervals
+  for(uint16_t i=0; i<100; i++) {
+    hostSetTimestamp(TEST_START + (i * 900));
+    eventLog.log(_EVENTLOG_BATTERY, 7600 - i);
+    CHECK(!eventLog.isDigestDue());
+  }
+  CHECK(eventLog.getPendingEvents() == _EVENTLOG_SIZE);
+
+  //Motion: digest due, as the interval has elapsed; the last battery sample is reported, not listed in the timeline
+  eventLog.log(_EVENTLOG_PIR);
+  CHECK(eventLog.isDigestDue());
+  String digest = eventLog.getDigest();
+  CHECK(digest.indexOf("Motion events: 1") >= 0);
+  CHECK(digest.indexOf("Battery pack voltage: 7.50V") >= 0);
+  CHECK(digest.indexOf(" motion\n") >= 0);
+  eventLog.clear();
+
+  //Within the interval: due only when the importance threshold is reached
+  hostSetTimestamp(TEST_START + 100000);
+  eventLog.log(_EVENTLOG_BATTERY, 7500);
+  eventLog.log(_EVENTLOG_PIR);
+  CHECK(!eventLog.isDigestDue());
+  eventLog.log(_EVENTLOG_BATTERY_LEVEL, 2);
+  CHECK(eventLog.isDigestDue());
+  eventLog.clear();
+
+  //Motion only, then the interval elapses
+  eventLog.log(_EVENTLOG_PIR);
+  CHECK(!eventLog.isDigestDue());
+  hostSetTimestamp(TEST_START + 100000 + EVENTLOG_DIGEST_INTERVAL);
+  eventLog.log(_EVENTLOG_BATTERY, 7490);
+  CHECK(eventLog.isDigestDue());
+
+  return TEST_RESULT();
+}
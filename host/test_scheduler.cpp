@@ -0,0 +1,198 @@
+/**
+ * @package Wildlife Camera
+ * Scheduler test: durations calculated from simulated traces of timer wakes, PIR events, commands and battery samples
+ * Each trace runs in its own process, as the history is kept in RTC memory (static)
+ * @author WizLab.it
+ * @version 20261018.001
+ */
+
+#include <Arduino.h>
+#include "config.h"
+#include "scheduler.h"
+#include "hosttest.h"
+#include "sketch.h"
+#include <sys/wait.h>
+#include <unistd.h>
+
+
+/**
+ * Defines
+ * Durations of the sketch (WildlifeCamera.h), battery pack of config-sample.h
+ */
+#define TEST_DEEP_SLEEP       600
+#define TEST_WAKEUP_BY_TIMER  5
+#define TEST_WAKEUP_BY_PIR    60
+#define TEST_EMPTY_MV         (3600 * _LOWBATTERY_NUMBER_OF_BATTERIES)
+#define TEST_START            1792281600UL    //2026-10-18 00:00:00 UTC
+#define TEST_TIMER_PERIOD     600
+#define TEST_BATTERY_PERIOD   900             //_LOWBATTERY_CACHE_TIMEOUT
+
+
+/**
+ * Trace
+ * Timer wakes every 10 minutes; PIR events in the active local hours; a linear battery discharge, with noisy samples
+ */
+struct Trace {
+  unsigned long duration;       //In seconds
+  long utcOffset;               //In seconds
+  uint8_t activeFrom;           //Local hours with PIR events (activeFrom to activeTo, included)
+  uint8_t activeTo;
+  uint16_t commandsEvery;       //A timer wake with commands every N wakes
+  float startMillivolts;
+  float millivoltsPerHour;      //Discharge rate
+  uint16_t noise;               //ADC noise of the samples, in millivolts (uniform, plus or minus)
+};
+
+static long __lowestLifetime = -1;    //Lowest projected lifetime during the trace (-1 if always unknown)
+
+static float runTrace(Scheduler &scheduler, const Trace &trace) {
+  hostSetUtcOffset(trace.utcOffset);
+  float millivolts = trace.startMillivolts;
+  unsigned long nextSample = 0;
+  uint32_t wakes = 0;
+  srand(1);
+  for(unsigned long t=0; t<trace.duration; t+=TEST_TIMER_PERIOD) {
+    unsigned long timestamp = TEST_START + t;
+    millivolts = trace.startMillivolts - (trace.millivoltsPerHour * t / 3600.0);
+    hostSetBatteryMillivolts((uint32_t)millivolts);
+    if(t >= nextSample) {
+      long noise = (trace.noise > 0) ? ((rand() % ((2 * trace.noise) + 1)) - trace.noise) : 0;
+      scheduler.recordBatterySample((uint32_t)(millivolts + noise), timestamp);
+      nextSample = t + TEST_BATTERY_PERIOD;
+    }
+    int8_t hour = getHour(timestamp);
+    if((hour >= trace.activeFrom) && (hour <= trace.activeTo)) scheduler.recordPirEvent(hour);
+    scheduler.recordTimerWake((wakes++ % trace.commandsEvery) == 0);
+    scheduler.update(getBatteryLevel(), hour);
+    long lifetime = scheduler.getProjectedLifetime();
+    if((lifetime >= 0) && ((__lowestLifetime < 0) || (lifetime < __lowestLifetime))) __lowestLifetime = lifetime;
+  }
+  return millivolts;
+}
+
+//Local hour to the timestamp of the next day at that hour, after the trace
+static unsigned long localTime(const Trace &trace, uint8_t hour) {
+  unsigned long day = ((TEST_START + trace.duration) / 86400) + 1;
+  return (day * 86400) + (hour * 3600) + 1800 - trace.utcOffset;
+}
+
+static void isolated(void (*test)()) {
+  fflush(stdout);
+  pid_t pid = fork();
+  if(pid == 0) {
+    test();
+    int result = TEST_RESULT();
+    fflush(stdout);
+    _exit(result);
+  }
+  int status = -1;
+  waitpid(pid, &status, 0);
+  CHECK(WIFEXITED(status) && (WEXITSTATUS(status) == 0));
+}
+
+
+/**
+ * Dusk visitor, on summer time: PIR activity is binned by local hour (with the offset saved in RTC memory), so the
+ * active hours are the same for the events and for the wakes that use them
+ */
+static void testDuskVisitor() {
+  Scheduler scheduler(TEST_DEEP_SLEEP, TEST_WAKEUP_BY_TIMER, TEST_WAKEUP_BY_PIR, TEST_EMPTY_MV);
+  Trace trace = {7 * 86400, 7200, 20, 21, 50, (3925 * _LOWBATTERY_NUMBER_OF_BATTERIES), 1.5};
+  float millivolts = runTrace(scheduler, trace);
+  CHECK(getBatteryLevel() == 2);
+  CHECK(fabs(scheduler.getBatteryTrend() + trace.millivoltsPerHour) < 0.75);
+  CHECK(scheduler.getProjectedLifetime() > _SCHEDULER_LIFETIME_TARGET);
+
+  //Active hour: full PIR wake, sleep stretched by the battery level only
+  int8_t hour = getHour(localTime(trace, 20));
+  CHECK(hour == 20);
+  scheduler.update(getBatteryLevel(), hour);
+  CHECK(scheduler.getWakeupDurationByPir() == TEST_WAKEUP_BY_PIR);
+  CHECK(scheduler.getDeepSleepDuration() == (TEST_DEEP_SLEEP * 2));
+  CHECK(scheduler.getPolicy() == "power saving (x2.0)");
+
+  //The same instant as an UTC hour (timezone not set after deep sleep) would be in the idle hours
+  scheduler.update(getBatteryLevel(), (hour - (trace.utcOffset / 3600)));
+  CHECK(scheduler.getPolicy() == "power saving (x4.0), idle");
+
+  //Idle hour: longer sleep, shorter wakes
+  scheduler.update(getBatteryLevel(), getHour(localTime(trace, 13)));
+  CHECK(scheduler.getPolicy() == "power saving (x4.0), idle");
+  CHECK(scheduler.getDeepSleepDuration() == (TEST_DEEP_SLEEP * 4));
+  CHECK(scheduler.getWakeupDurationByPir() == _SCHEDULER_MIN_WAKEUP_BY_PIR);
+  CHECK(scheduler.getWakeupDurationByTimer() == _SCHEDULER_MIN_WAKEUP_BY_TIMER);
+  printf("dusk visitor: %0.0f mV, trend %0.2f mV/hour, lifetime %ld hours\n", millivolts, scheduler.getBatteryTrend(), scheduler.getProjectedLifetime());
+}
+
+
+/**
+ * Fast discharge: the projected lifetime is below the target, durations are stretched further
+ */
+static void testFastDischarge() {
+  Scheduler scheduler(TEST_DEEP_SLEEP, TEST_WAKEUP_BY_TIMER, TEST_WAKEUP_BY_PIR, TEST_EMPTY_MV);
+  Trace trace = {12 * 3600, 3600, 6, 7, 2, (3880 * _LOWBATTERY_NUMBER_OF_BATTERIES), 20.0};
+  float millivolts = runTrace(scheduler, trace);
+  long expected = (long)((millivolts - TEST_EMPTY_MV) / trace.millivoltsPerHour);
+  CHECK(getBatteryLevel() == 2);
+  CHECK(fabs(scheduler.getBatteryTrend() + trace.millivoltsPerHour) < 1.0);
+  CHECK(labs(scheduler.getProjectedLifetime() - expected) <= 2);
+  CHECK(scheduler.getProjectedLifetime() < _SCHEDULER_LIFETIME_TARGET);
+
+  //Busy camera (commands at half of the timer wakes): never idle, timer wakes are not shortened
+  scheduler.update(getBatteryLevel(), getHour(localTime(trace, 13)));
+  CHECK(scheduler.getPolicy() == "power saving (x3.0)");
+  CHECK(scheduler.getDeepSleepDuration() == (TEST_DEEP_SLEEP * 3));
+  CHECK(scheduler.getWakeupDurationByTimer() == TEST_WAKEUP_BY_TIMER);
+  CHECK(scheduler.getWakeupDurationByPir() == _SCHEDULER_MIN_WAKEUP_BY_PIR);
+  printf("fast discharge: %0.0f mV, trend %0.2f mV/hour, lifetime %ld hours\n", millivolts, scheduler.getBatteryTrend(), scheduler.getProjectedLifetime());
+}
+
+
+/**
+ * Flat battery with noisy samples: the trend stays close to zero, the projected lifetime never goes below the target
+ * and durations follow the battery level only
+ */
+static void testNoisyFlat() {
+  Scheduler scheduler(TEST_DEEP_SLEEP, TEST_WAKEUP_BY_TIMER, TEST_WAKEUP_BY_PIR, TEST_EMPTY_MV);
+  Trace trace = {3 * 86400, 0, 6, 20, 2, (3850 * _LOWBATTERY_NUMBER_OF_BATTERIES), 0.0, 20};
+  float millivolts = runTrace(scheduler, trace);
+  CHECK(getBatteryLevel() == 3);
+  CHECK(fabs(scheduler.getBatteryTrend()) < 2.0);
+  CHECK((__lowestLifetime < 0) || (__lowestLifetime >= _SCHEDULER_LIFETIME_TARGET));
+
+  scheduler.update(getBatteryLevel(), getHour(localTime(trace, 13)));
+  CHECK(scheduler.getPolicy() == "power saving (x1.5)");
+  CHECK(scheduler.getDeepSleepDuration() == (unsigned long)(TEST_DEEP_SLEEP * 1.5));
+  printf("noisy flat: %0.0f mV (+/- %u mV), trend %0.2f mV/hour, lowest lifetime %ld hours\n", millivolts, trace.noise, scheduler.getBatteryTrend(), __lowestLifetime);
+}
+
+
+/**
+ * Unknown time (NTP never reached): events are not binned, battery samples are ignored, durations follow the level
+ */
+static void testUnknownTime() {
+  Scheduler scheduler(TEST_DEEP_SLEEP, TEST_WAKEUP_BY_TIMER, TEST_WAKEUP_BY_PIR, TEST_EMPTY_MV);
+  CHECK(getHour(120) == -1);
+  for(uint16_t i=0; i<100; i++) {
+    scheduler.recordBatterySample((3750 * _LOWBATTERY_NUMBER_OF_BATTERIES) - i, 120 + (i * TEST_BATTERY_PERIOD));
+    scheduler.recordPirEvent(getHour(120 + (i * TEST_TIMER_PERIOD)));
+    scheduler.recordTimerWake(false);
+  }
+  CHECK(scheduler.getBatteryTrend() == 0);
+  CHECK(scheduler.getProjectedLifetime() == -1);
+  scheduler.update(5, -1);
+  CHECK(scheduler.getPolicy() == "normal, idle");
+  CHECK(scheduler.getDeepSleepDuration() == TEST_DEEP_SLEEP);
+  scheduler.update(1, -1);
+  CHECK(scheduler.getPolicy() == "power saving (x6.0), idle");
+  CHECK(scheduler.getDeepSleepDuration() == _SCHEDULER_MAX_DEEP_SLEEP);
+}
+
+
+int main() {
+  isolated(testDuskVisitor);
+  isolated(testFastDischarge);
+  isolated(testNoisyFlat);
+  isolated(testUnknownTime);
+  return TEST_RESULT();
+}
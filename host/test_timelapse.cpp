@@ -0,0 +1,69 @@
+/**
+ * @package Wildlife Camera
+ * Timelapse test: captures window and sleep durations in local hours, with the UTC offset saved in RTC memory (the
+ * timezone is not set on capture only wake ups, as WiFi and NTP are not used)
+ * @author WizLab.it
+ * @version 20261018.001
+ */
+
+#include <Arduino.h>
+#include "config.h"
+#include "timelapse.h"
+#include "hosttest.h"
+#include "sketch.h"
+
+
+/**
+ * Defines
+ */
+#define TEST_DAY          1792281600UL    //2026-10-18 00:00:00 UTC
+#define TEST_UTC_OFFSET   7200            //Summer time, UTC+2
+#define TEST_POLL_SLEEP   3600
+
+
+//Local time of the test day to timestamp
+static unsigned long localTime(uint8_t hour, uint8_t minute) {
+  return TEST_DAY + (hour * 3600) + (minute * 60) - TEST_UTC_OFFSET;
+}
+
+
+int main() {
+  hostSetUtcOffset(TEST_UTC_OFFSET);
+  Timelapse timelapse(15, 7, 19, 3600);
+
+  //Captures window: 07:00 to 19:00 local time (05:00 to 17:00 UTC)
+  timelapse.configure(15, 7, 19);
+  hostSetTimestamp(localTime(7, 30));
+  CHECK(timelapse.isCaptureDue());
+  timelapse.configure(15, 7, 19);
+  hostSetTimestamp(localTime(18, 50));
+  CHECK(timelapse.isCaptureDue());
+  timelapse.configure(15, 7, 19);
+  hostSetTimestamp(localTime(19, 30));
+  CHECK(!timelapse.isCaptureDue());
+  timelapse.configure(15, 7, 19);
+  hostSetTimestamp(localTime(6, 30));
+  CHECK(!timelapse.isCaptureDue());
+
+  //Before the window: the first capture (07:00 local) comes before the next polling, the next wake up is capture only
+  timelapse.configure(15, 7, 19);
+  hostSetTimestamp(localTime(6, 50));
+  CHECK(timelapse.getSleepDuration(TEST_POLL_SLEEP, true) == 600);
+  CHECK(timelapse.isCaptureOnlyWake());
+
+  //End of the window: the next capture (19:00 local) is out of it, sleep until the next polling
+  timelapse.configure(15, 7, 19);
+  hostSetTimestamp(localTime(18, 50));
+  CHECK(timelapse.getSleepDuration(TEST_POLL_SLEEP, true) == TEST_POLL_SLEEP);
+  CHECK(!timelapse.isCaptureOnlyWake());
+
+  //Night window, across midnight
+  timelapse.configure(30, 21, 5);
+  hostSetTimestamp(localTime(23, 10));
+  CHECK(timelapse.isCaptureDue());
+  timelapse.configure(30, 21, 5);
+  hostSetTimestamp(localTime(12, 0));
+  CHECK(!timelapse.isCaptureDue());
+
+  return TEST_RESULT();
+}
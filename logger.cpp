@@ -0,0 +1,174 @@
+/**
+ * @package Wildlife Camera
+ * Asynchronous buffered logging
+ * @author WizLab.it
+ * @board AI-Thinker ESP32-CAM
+ * @version 20261018.001
+ */
+
+#include "logger.h"
+
+
+/**
+ * Variables
+ * Ring buffer (head: next write position, owned by the producer; tail: next read position, owned by the flush task)
+ */
+char Logger::_buffer[_LOGGER_BUFFER_SIZE];
+std::atomic<uint16_t> Logger::_head(0);
+std::atomic<uint16_t> Logger::_tail(0);
+std::atomic<uint32_t> Logger::_dropped(0);
+TaskHandle_t Logger::_task = NULL;
+
+//Last records, for post-mortem retrieval (kept across deep sleeps and resets, not initialized at boot)
+#if LOG_PERSIST_RECORDS > 0
+RTC_NOINIT_ATTR struct {
+  uint32_t magic;
+  uint8_t next;
+  uint8_t count;
+  char records[LOG_PERSIST_RECORDS][_LOGGER_PERSIST_LENGTH];
+} __loggerPersisted;
+#endif
+
+
+/**
+ * Logger::begin
+ * Start the flush task, records logged before are written synchronously
+ */
+void Logger::begin() {
+#if LOG_PERSIST_RECORDS > 0
+  //Check persisted records (garbage after power on)
+  if((__loggerPersisted.magic != _LOGGER_PERSIST_MAGIC) || (__loggerPersisted.next >= LOG_PERSIST_RECORDS) || (__loggerPersisted.count > LOG_PERSIST_RECORDS)) {
+    memset(&__loggerPersisted, 0x00, sizeof(__loggerPersisted));
+    __loggerPersisted.magic = _LOGGER_PERSIST_MAGIC;
+  }
+  char record[_LOGGER_PERSIST_LENGTH];
+  size_t length = snprintf(record, sizeof(record), "--- Boot (reset reason: %d) ---", (int)esp_reset_reason());
+  _persist(record, length);
+#endif
+
+  if(_task != NULL) return;
+  if(xTaskCreatePinnedToCore(&Logger::_flushTask, "logger", _LOGGER_TASK_STACK_SIZE, NULL, _LOGGER_TASK_PRIORITY, &_task, 0) != pdPASS) {
+    _task = NULL;
+  }
+}
+
+
+/**
+ * Logger::write
+ * Format a record and add it to the ring buffer (a new line is appended)
+ * @param format    Format as defined for printf()
+ */
+void Logger::write(const char* format, ...) {
+  char record[_LOGGER_RECORD_MAX_LENGTH];
+  va_list args;
+  va_start(args, format);
+  int length = vsnprintf(record, (sizeof(record) - 1), format, args);
+  va_end(args);
+  if(length < 0) return;
+  if(length > (int)(sizeof(record) - 2)) length = sizeof(record) - 2;
+  _persist(record, length);
+  record[length++] = '\n';
+
+  //Flush task not running: write synchronously
+  if(_task == NULL) {
+    Serial.write((const uint8_t *)record, length);
+    return;
+  }
+
+  //Check free space (one byte is kept empty to distinguish full from empty)
+  uint16_t head = _head.load(std::memory_order_relaxed);
+  uint16_t tail = _tail.load(std::memory_order_acquire);
+  uint16_t freeSpace = (tail + _LOGGER_BUFFER_SIZE - head - 1) % _LOGGER_BUFFER_SIZE;
+  if(length > freeSpace) {
+    _dropped.fetch_add(1, std::memory_order_relaxed);
+    return;
+  }
+
+  //Copy the record, wrapping at the end of the buffer
+  uint16_t firstPart = min((uint16_t)length, (uint16_t)(_LOGGER_BUFFER_SIZE - head));
+  memcpy(&_buffer[head], record, firstPart);
+  if(firstPart < length) memcpy(_buffer, &record[firstPart], (length - firstPart));
+  _head.store(((head + length) % _LOGGER_BUFFER_SIZE), std::memory_order_release);
+}
+
+
+/**
+ * Logger::flush
+ * Wait for the flush task to write the buffered records (i.e. before deep sleep)
+ */
+void Logger::flush() {
+  if(_task != NULL) {
+    unsigned long timeout = millis() + _LOGGER_FLUSH_TIMEOUT;
+    while((_tail.load(std::memory_order_acquire) != _head.load(std::memory_order_acquire)) && (millis() < timeout)) {
+      vTaskDelay(pdMS_TO_TICKS(_LOGGER_FLUSH_INTERVAL));
+    }
+  }
+  Serial.flush();
+}
+
+
+/**
+ * Logger::getPersisted
+ * Get the last records kept in RTC memory, from the oldest
+ * @return    Records, one per line (empty if not enabled)
+ */
+String Logger::getPersisted() {
+  String records = "";
+#if LOG_PERSIST_RECORDS > 0
+  uint8_t oldest = (__loggerPersisted.count < LOG_PERSIST_RECORDS) ? 0 : __loggerPersisted.next;
+  for(uint8_t i=0; i<__loggerPersisted.count; i++) {
+    records += String(__loggerPersisted.records[(oldest + i) % LOG_PERSIST_RECORDS]) + "\n";
+  }
+#endif
+  return records;
+}
+
+
+/**
+ * Logger::_flushTask
+ * Flush task: write the buffered records on serial
+ * @param parameters    Not used
+ */
+void Logger::_flushTask(void *parameters) {
+  for(;;) {
+    _drain();
+    vTaskDelay(pdMS_TO_TICKS(_LOGGER_FLUSH_INTERVAL));
+  }
+}
+
+
+/**
+ * Logger::_drain
+ * Write all the buffered records on serial (flush task only)
+ */
+void Logger::_drain() {
+  uint16_t tail = _tail.load(std::memory_order_relaxed);
+  uint16_t head = _head.load(std::memory_order_acquire);
+  while(tail != head) {
+    uint16_t chunk = (head > tail) ? (head - tail) : (_LOGGER_BUFFER_SIZE - tail);
+    Serial.write((const uint8_t *)&_buffer[tail], chunk);
+    tail = (tail + chunk) % _LOGGER_BUFFER_SIZE;
+    _tail.store(tail, std::memory_order_release);
+  }
+
+  uint32_t dropped = _dropped.exchange(0, std::memory_order_relaxed);
+  if(dropped > 0) Serial.printf(" [-] Logger: %u records dropped (buffer full)\n", dropped);
+}
+
+
+/**
+ * Logger::_persist
+ * Keep a copy of the record in RTC memory
+ * @param record    Record (without new line)
+ * @param length    Record length
+ */
+void Logger::_persist(const char* record, size_t length) {
+#if LOG_PERSIST_RECORDS > 0
+  if(__loggerPersisted.magic != _LOGGER_PERSIST_MAGIC) return;
+  if(length > (_LOGGER_PERSIST_LENGTH - 1)) length = _LOGGER_PERSIST_LENGTH - 1;
+  memcpy(__loggerPersisted.records[__loggerPersisted.next], record, length);
+  __loggerPersisted.records[__loggerPersisted.next][length] = '\0';
+  __loggerPersisted.next = (__loggerPersisted.next + 1) % LOG_PERSIST_RECORDS;
+  if(__loggerPersisted.count < LOG_PERSIST_RECORDS) __loggerPersisted.count++;
+#endif
+}
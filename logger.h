@@ -0,0 +1,98 @@
+/**
+ * @package Wildlife Camera
+ * Asynchronous buffered logging header
+ * @author WizLab.it
+ * @board AI-Thinker ESP32-CAM
+ * @version 20261018.001
+ */
+
+#ifndef LOGGER_H
+#define LOGGER_H
+
+
+/**
+ * Includes
+ */
+#include <Arduino.h>
+#include <atomic>
+#include "config.h"
+
+
+/**
+ * Defines
+ */
+//Levels
+#define _LOG_LEVEL_NONE             0
+#define _LOG_LEVEL_ERROR            1
+#define _LOG_LEVEL_WARNING          2
+#define _LOG_LEVEL_INFO             3
+#define _LOG_LEVEL_DEBUG            4
+
+//Buffers
+#define _LOGGER_BUFFER_SIZE         4096  //Ring buffer size (records that don't fit are dropped)
+#define _LOGGER_RECORD_MAX_LENGTH   256   //Max length of a record, longer records are truncated
+#define _LOGGER_PERSIST_LENGTH      96    //Max length of a record kept in RTC memory
+#define _LOGGER_PERSIST_MAGIC       0x574C4F47
+
+//Flush task
+#define _LOGGER_TASK_PRIORITY       (tskIDLE_PRIORITY + 1)
+#define _LOGGER_TASK_STACK_SIZE     2048
+#define _LOGGER_FLUSH_INTERVAL      20    //In milliseconds
+#define _LOGGER_FLUSH_TIMEOUT       500   //In milliseconds, max wait for the buffer to be flushed before deep sleep
+
+//Log level (records above the level are removed at compile time, but still type-checked, and their arguments count as used)
+#ifndef LOG_LEVEL
+  #define LOG_LEVEL _LOG_LEVEL_INFO
+#endif
+#ifndef LOG_PERSIST_RECORDS
+  #define LOG_PERSIST_RECORDS 0
+#endif
+
+#if LOG_LEVEL >= _LOG_LEVEL_ERROR
+  #define LOG_ERROR(...) Logger::write(__VA_ARGS__)
+#else
+  #define LOG_ERROR(...) do { if(0) Logger::write(__VA_ARGS__); } while(0)
+#endif
+#if LOG_LEVEL >= _LOG_LEVEL_WARNING
+  #define LOG_WARNING(...) Logger::write(__VA_ARGS__)
+#else
+  #define LOG_WARNING(...) do { if(0) Logger::write(__VA_ARGS__); } while(0)
+#endif
+#if LOG_LEVEL >= _LOG_LEVEL_INFO
+  #define LOG_INFO(...) Logger::write(__VA_ARGS__)
+#else
+  #define LOG_INFO(...) do { if(0) Logger::write(__VA_ARGS__); } while(0)
+#endif
+#if LOG_LEVEL >= _LOG_LEVEL_DEBUG
+  #define LOG_DEBUG(...) Logger::write(__VA_ARGS__)
+#else
+  #define LOG_DEBUG(...) do { if(0) Logger::write(__VA_ARGS__); } while(0)
+#endif
+
+
+/**
+ * Class definition
+ * Records are formatted by the caller into a single-producer/single-consumer lock-free ring buffer,
+ * and written on serial by a low priority task. Records must be logged from the main loop task only.
+ */
+class Logger {
+  private:
+    static char _buffer[_LOGGER_BUFFER_SIZE];
+    static std::atomic<uint16_t> _head;
+    static std::atomic<uint16_t> _tail;
+    static std::atomic<uint32_t> _dropped;
+    static TaskHandle_t _task;
+
+    static void _flushTask(void *parameters);
+    static void _drain();
+    static void _persist(const char* record, size_t length);
+
+  public:
+    static void begin();
+    static void write(const char* format, ...) __attribute__((format(printf, 1, 2)));
+    static void flush();
+    static String getPersisted();
+};
+
+
+#endif
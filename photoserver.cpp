@@ -0,0 +1,398 @@
+/**
+ * @package Wildlife Camera
+ * LAN HTTP server for photos retrieval
+ * @author WizLab.it
+ * @board AI-Thinker ESP32-CAM
+ * @version 20261018.001
+ */
+
+#include "photoserver.h"
+
+
+/**
+ * PhotoServer
+ * Class constructor
+ * @param camera    Camera that owns the SD Card
+ */
+PhotoServer::PhotoServer(Camera *camera) : _server(_PHOTOSERVER_PORT) {
+  _camera = camera;
+  _buffer = NULL;
+  _end = 0;
+}
+
+
+/**
+ * PhotoServer::start
+ * Start the server, or extend its duration if already active
+ * @param duration    How long the server stays active (in seconds)
+ * @return            true if the server is active; false otherwise
+ */
+bool PhotoServer::start(unsigned long duration) {
+  _end = millis() + (duration * 1000);
+  if(_buffer != NULL) return true;
+
+  //Check SD Card and WiFi (SD Card is mounted again for each request, so PIR and battery pins are free in between)
+  bool sdStatus = (WiFi.status() == WL_CONNECTED) && _camera->sdOpen();
+  _camera->sdClose();
+  if(!sdStatus) return false;
+
+  //Allocate streaming buffer
+  _buffer = (uint8_t *)malloc(_PHOTOSERVER_CHUNK_SIZE);
+  if(_buffer == NULL) return false;
+
+  _server.begin();
+  LOG_INFO(" [+] Photo server started: http://%s/", WiFi.localIP().toString().c_str());
+  return true;
+}
+
+
+/**
+ * PhotoServer::stop
+ * Stop the server and release its resources
+ */
+void PhotoServer::stop() {
+  if(_buffer == NULL) return;
+  _server.end();
+  free(_buffer);
+  _buffer = NULL;
+  LOG_INFO(" [+] Photo server stopped");
+}
+
+
+/**
+ * PhotoServer::isActive
+ * Check if the server is active
+ * @return    true if the server is active; false otherwise
+ */
+bool PhotoServer::isActive() {
+  return (_buffer != NULL);
+}
+
+
+/**
+ * PhotoServer::handleClient
+ * Serve a pending request, stop the server when its duration is expired
+ */
+void PhotoServer::handleClient() {
+  if(_buffer == NULL) return;
+
+  //Check if server duration is expired
+  if(millis() > _end) {
+    stop();
+    return;
+  }
+
+  //Serve pending request
+  WiFiClient client = _server.available();
+  if(!client) return;
+  _handleRequest(client);
+  client.stop();
+
+  //Release SD Card (pins 12 and 13 are shared with PIR and battery ADC)
+  _camera->sdClose();
+}
+
+
+/**
+ * PhotoServer::_handleRequest
+ * Parse the request and route it
+ * Paths are relative to _CAMERA_SD_BASE_PATH: "/" and "/dir/" are listings, "/dir.tar" is a bundle of the directory, anything else is a file
+ * @param client    Connected client
+ */
+void PhotoServer::_handleRequest(WiFiClient &client) {
+  client.setTimeout(_PHOTOSERVER_REQUEST_TIMEOUT * 1000);
+
+  //Request line
+  String request = client.readStringUntil('\n');
+  int pathStart = request.indexOf(' ');
+  int pathEnd = request.indexOf(' ', pathStart + 1);
+  if((pathStart < 0) || (pathEnd < 0)) return;
+  String method = request.substring(0, pathStart);
+  String path = request.substring(pathStart + 1, pathEnd);
+
+  //Headers (only Range is used)
+  String range = "";
+  while(client.connected()) {
+    String line = client.readStringUntil('\n');
+    line.trim();
+    if(line.length() == 0) break;
+    if(line.substring(0, 6).equalsIgnoreCase("Range:")) {
+      range = line.substring(6);
+      range.trim();
+    }
+  }
+
+  LOG_DEBUG(" [i] Photo server request: %s %s", method.c_str(), path.c_str());
+
+  //Check request
+  if(method != "GET") {
+    _sendHeader(client, 405, "text/plain", 0);
+    return;
+  }
+  if((path[0] != '/') || (path.indexOf("..") >= 0)) {
+    _sendHeader(client, 400, "text/plain", 0);
+    return;
+  }
+
+  //Mount SD Card (it's released after each request)
+  if(!_camera->sdOpen()) {
+    _sendHeader(client, 503, "text/plain", 0);
+    return;
+  }
+
+  //Route
+  if(path.endsWith("/")) {
+    _sendListing(client, path);
+  } else if(path.endsWith(".tar")) {
+    _sendTar(client, path.substring(0, path.length() - 4));
+  } else {
+    _sendFile(client, path, range);
+  }
+}
+
+
+/**
+ * PhotoServer::_sendHeader
+ * Send the response header
+ * @param client          Connected client
+ * @param code            HTTP status code
+ * @param contentType     Content type
+ * @param contentLength   Content length, negative if unknown (the connection is closed at the end of the response)
+ * @param extraHeaders    (optional) Additional headers, each terminated by "\r\n"
+ */
+void PhotoServer::_sendHeader(WiFiClient &client, uint16_t code, const char* contentType, long contentLength, String extraHeaders) {
+  const char* status;
+  switch(code) {
+    case 200: status = "OK"; break;
+    case 206: status = "Partial Content"; break;
+    case 400: status = "Bad Request"; break;
+    case 404: status = "Not Found"; break;
+    case 405: status = "Method Not Allowed"; break;
+    case 416: status = "Range Not Satisfiable"; break;
+    default: status = "Service Unavailable"; break;
+  }
+
+  String header = "HTTP/1.1 " + String(code) + " " + status + "\r\n"
+    "Content-Type: " + contentType + "\r\n"
+    "Connection: close\r\n"
+    "Accept-Ranges: bytes\r\n";
+  if(contentLength >= 0) header += "Content-Length: " + String(contentLength) + "\r\n";
+  header += extraHeaders + "\r\n";
+  client.print(header);
+}
+
+
+/**
+ * PhotoServer::_sendListing
+ * Send a directory listing, one entry at a time
+ * @param client    Connected client
+ * @param path      Directory path (ends with "/")
+ */
+void PhotoServer::_sendListing(WiFiClient &client, String path) {
+  fs::FS &fs = SD_MMC;
+  String dirPath = String(_CAMERA_SD_BASE_PATH) + path.substring(0, path.length() - 1);
+  File dir = fs.open(dirPath.c_str());
+  if(!dir || !dir.isDirectory()) {
+    _sendHeader(client, 404, "text/plain", 0);
+    return;
+  }
+
+  _sendHeader(client, 200, "text/html", -1);
+  client.print("<html><body><h1>Wildlife Camera " + path + "</h1>\n");
+
+  //Photo DB summary
+  if(path == "/") {
+    client.print("<p>Number of photos: " + String(_camera->sdGetPhotoCounter()) + "<br>\n"
+      "Last photo: " + ((_camera->sdGetLastPhotoTimestamp() == 0) ? "-" : getDateFormat("%F, %T", _camera->sdGetLastPhotoTimestamp())) + "</p>\n");
+  }
+
+  //Entries
+  client.print("<ul>\n");
+  File entry = dir.openNextFile();
+  while(entry) {
+    String name = entry.name();
+    if(entry.isDirectory()) {
+      client.print("<li><a href=\"" + name + "/\">" + name + "/</a> (<a href=\"" + name + ".tar\">tar</a>)</li>\n");
+    } else {
+      client.print("<li><a href=\"" + name + "\">" + name + "</a> " + String(entry.size()) + " bytes</li>\n");
+    }
+    entry.close();
+    entry = dir.openNextFile();
+  }
+  dir.close();
+  client.print("</ul></body></html>\n");
+}
+
+
+/**
+ * PhotoServer::_sendFile
+ * Send a file, or the requested range of it
+ * @param client    Connected client
+ * @param path      File path
+ * @param range     Value of the Range header (i.e. "bytes=1000-", empty if not set)
+ */
+void PhotoServer::_sendFile(WiFiClient &client, String path, String range) {
+  fs::FS &fs = SD_MMC;
+  File file = fs.open((String(_CAMERA_SD_BASE_PATH) + path).c_str(), FILE_READ);
+  if(!file || file.isDirectory()) {
+    _sendHeader(client, 404, "text/plain", 0);
+    return;
+  }
+
+  //Content type
+  const char* contentType = "application/octet-stream";
+  if(path.endsWith(".jpg")) contentType = "image/jpeg";
+  else if(path.endsWith(".avi")) contentType = "video/x-msvideo";
+
+  //Range: "bytes=start-end", "bytes=start-" or "bytes=-suffix"
+  long size = file.size();
+  long start = 0;
+  long end = size - 1;
+  bool partial = false;
+  if(range.startsWith("bytes=")) {
+    int dash = range.indexOf('-');
+    String rangeStart = range.substring(6, dash);
+    String rangeEnd = range.substring(dash + 1);
+    if(dash < 0) {
+      start = size;
+    } else if(rangeStart.length() == 0) {
+      start = size - rangeEnd.toInt();
+    } else {
+      start = rangeStart.toInt();
+      if(rangeEnd.length() > 0) end = min(rangeEnd.toInt(), (size - 1));
+    }
+    if(start < 0) start = 0;
+    if(start > end) {
+      _sendHeader(client, 416, "text/plain", 0, "Content-Range: bytes */" + String(size) + "\r\n");
+      file.close();
+      return;
+    }
+    partial = true;
+  }
+
+  //Send
+  if(partial) {
+    _sendHeader(client, 206, contentType, (end - start + 1), "Content-Range: bytes " + String(start) + "-" + String(end) + "/" + String(size) + "\r\n");
+  } else {
+    _sendHeader(client, 200, contentType, size);
+  }
+  if(file.seek(start)) _streamFile(client, file, (end - start + 1));
+  file.close();
+}
+
+
+/**
+ * PhotoServer::_sendTar
+ * Send all the files of a directory as a tar bundle
+ * The length is computed with a first pass on the directory, so nothing is kept in memory
+ * @param client    Connected client
+ * @param path      Directory path (without trailing "/")
+ */
+void PhotoServer::_sendTar(WiFiClient &client, String path) {
+  fs::FS &fs = SD_MMC;
+  String dirPath = String(_CAMERA_SD_BASE_PATH) + path;
+  String dirName = path.substring(path.lastIndexOf('/') + 1);
+
+  //First pass: calculate length (header + data padded to block size, for each file, then 2 empty blocks)
+  File dir = fs.open(dirPath.c_str());
+  if(!dir || !dir.isDirectory()) {
+    _sendHeader(client, 404, "text/plain", 0);
+    return;
+  }
+  long contentLength = 2 * _PHOTOSERVER_TAR_BLOCK;
+  File entry = dir.openNextFile();
+  while(entry) {
+    if(!entry.isDirectory()) {
+      contentLength += _PHOTOSERVER_TAR_BLOCK + (((entry.size() + _PHOTOSERVER_TAR_BLOCK - 1) / _PHOTOSERVER_TAR_BLOCK) * _PHOTOSERVER_TAR_BLOCK);
+    }
+    entry.close();
+    entry = dir.openNextFile();
+  }
+  dir.close();
+
+  _sendHeader(client, 200, "application/x-tar", contentLength, "Content-Disposition: attachment; filename=\"" + dirName + ".tar\"\r\n");
+
+  //Second pass: stream files
+  bool complete = true;
+  dir = fs.open(dirPath.c_str());
+  entry = dir.openNextFile();
+  while(entry) {
+    if(!entry.isDirectory()) {
+      uint32_t size = entry.size();
+      _buildTarHeader(_buffer, dirName + "/" + entry.name(), size, entry.getLastWrite());
+      complete = (client.write(_buffer, _PHOTOSERVER_TAR_BLOCK) == _PHOTOSERVER_TAR_BLOCK) && _streamFile(client, entry, size);
+
+      //Pad data to block size
+      uint16_t padding = (_PHOTOSERVER_TAR_BLOCK - (size % _PHOTOSERVER_TAR_BLOCK)) % _PHOTOSERVER_TAR_BLOCK;
+      if(complete && (padding > 0)) {
+        memset(_buffer, 0x00, padding);
+        complete = (client.write(_buffer, padding) == padding);
+      }
+      if(!complete) break;
+    }
+    entry.close();
+    entry = dir.openNextFile();
+  }
+  entry.close();
+  dir.close();
+
+  //Failed mid-archive (SD Card read or client write): close the connection without the end of archive, so the client
+  //sees a truncated download instead of a valid tar with a short file
+  if(!complete) {
+    LOG_WARNING(" [-] Photo server: tar of %s interrupted", path.c_str());
+    client.stop();
+    return;
+  }
+
+  //End of archive
+  memset(_buffer, 0x00, 2 * _PHOTOSERVER_TAR_BLOCK);
+  client.write(_buffer, 2 * _PHOTOSERVER_TAR_BLOCK);
+}
+
+
+/**
+ * PhotoServer::_streamFile
+ * Send data from the current position of a file, in chunks of _PHOTOSERVER_CHUNK_SIZE bytes
+ * @param client    Connected client
+ * @param file      File to read
+ * @param length    Number of bytes to send
+ * @return          true if all bytes are sent; false otherwise
+ */
+bool PhotoServer::_streamFile(WiFiClient &client, File &file, uint32_t length) {
+  while(length > 0) {
+    size_t rb = file.read(_buffer, min(length, (uint32_t)_PHOTOSERVER_CHUNK_SIZE));
+    if(rb == 0) return false;
+    if(client.write(_buffer, rb) != rb) return false;
+    length -= rb;
+  }
+  return true;
+}
+
+
+/**
+ * PhotoServer::_buildTarHeader
+ * Build a ustar header block
+ * @param header    Destination (_PHOTOSERVER_TAR_BLOCK bytes)
+ * @param name      File name in the archive
+ * @param size      File size
+ * @param mtime     File modification time
+ */
+void PhotoServer::_buildTarHeader(uint8_t *header, String name, uint32_t size, time_t mtime) {
+  memset(header, 0x00, _PHOTOSERVER_TAR_BLOCK);
+  strncpy((char *)header, name.c_str(), 99);            //name
+  strcpy((char *)header + 100, "0000644");              //mode
+  strcpy((char *)header + 108, "0000000");              //uid
+  strcpy((char *)header + 116, "0000000");              //gid
+  sprintf((char *)header + 124, "%011lo", (unsigned long)size);   //size
+  sprintf((char *)header + 136, "%011lo", (unsigned long)mtime);  //mtime
+  memset(header + 148, ' ', 8);                         //checksum (spaces while calculating)
+  header[156] = '0';                                    //typeflag: regular file
+  memcpy(header + 257, "ustar", 6);                     //magic
+  memcpy(header + 263, "00", 2);                        //version
+
+  //Checksum
+  uint32_t checksum = 0;
+  for(uint16_t i=0; i<_PHOTOSERVER_TAR_BLOCK; i++) checksum += header[i];
+  sprintf((char *)header + 148, "%06lo", (unsigned long)checksum);
+  header[155] = ' ';
+}
@@ -0,0 +1,61 @@
+/**
+ * @package Wildlife Camera
+ * LAN HTTP server for photos retrieval header
+ * @author WizLab.it
+ * @board AI-Thinker ESP32-CAM
+ * @version 20261018.001
+ */
+
+#ifndef PHOTOSERVER_H
+#define PHOTOSERVER_H
+
+
+/**
+ * Defines
+ */
+#define _PHOTOSERVER_PORT             80
+#define _PHOTOSERVER_CHUNK_SIZE       8192  //Size of the buffer used to stream files
+#define _PHOTOSERVER_REQUEST_TIMEOUT  5     //In seconds, max time to receive the request headers
+#define _PHOTOSERVER_TAR_BLOCK        512
+
+
+/**
+ * Includes
+ */
+#include <Arduino.h>
+#include <WiFi.h>
+#include "FS.h"
+#include "SD_MMC.h"
+#include "camera.h"
+#include "logger.h"
+#include "extern.h"
+
+
+/**
+ * Class definition
+ */
+class PhotoServer {
+  private:
+    WiFiServer _server;
+    Camera *_camera;
+    uint8_t *_buffer;   //Streaming buffer, allocated only while the server is active
+    unsigned long _end;
+
+    void _handleRequest(WiFiClient &client);
+    void _sendHeader(WiFiClient &client, uint16_t code, const char* contentType, long contentLength, String extraHeaders = "");
+    void _sendListing(WiFiClient &client, String path);
+    void _sendFile(WiFiClient &client, String path, String range);
+    void _sendTar(WiFiClient &client, String path);
+    bool _streamFile(WiFiClient &client, File &file, uint32_t length);
+    void _buildTarHeader(uint8_t *header, String name, uint32_t size, time_t mtime);
+
+  public:
+    PhotoServer(Camera *camera);
+    bool start(unsigned long duration);
+    void stop();
+    bool isActive();
+    void handleClient();
+};
+
+
+#endif
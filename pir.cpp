@@ -38,7 +38,7 @@ void Pir::enable(void (*isr)()) {
   pinMode(_pinSignal, INPUT_PULLDOWN);
   attachInterrupt(_pinSignal, _isr, RISING);
 
-  Serial.println(" [+] Motion sensor activated");
+  LOG_INFO(" [+] Motion sensor activated");
 }
 
 
@@ -15,6 +15,7 @@
  */
 #include <Arduino.h>
 #include "driver/rtc_io.h"
+#include "logger.h"
 #include "extern.h"
 
 
@@ -0,0 +1,228 @@
+/**
+ * @package Wildlife Camera
+ * Adaptive duty-cycle scheduler
+ * @author WizLab.it
+ * @board AI-Thinker ESP32-CAM
+ * @version 20261018.001
+ */
+
+#include "scheduler.h"
+
+
+/**
+ * Variables
+ * Activity and battery history (kept across deep sleeps)
+ */
+RTC_DATA_ATTR struct {
+  uint32_t batteryMillivolts[_SCHEDULER_BATTERY_SAMPLES];
+  unsigned long batteryTimestamps[_SCHEDULER_BATTERY_SAMPLES];
+  uint8_t batteryNext = 0;
+  uint8_t batteryCount = 0;
+  uint8_t pirEvents[24];            //PIR events per hour of day (halved when a counter is full)
+  uint16_t timerWakes = 0;          //Timer wakes (halved with timerWakesWithCommands when full)
+  uint16_t timerWakesWithCommands = 0;
+} __schedulerHistory;
+
+
+/**
+ * Scheduler
+ * Class constructor
+ * @param baseDeepSleep       In seconds, deep sleep duration when power is plenty
+ * @param baseWakeupByTimer   In seconds, wake up duration by timer when power is plenty
+ * @param baseWakeupByPir     In seconds, wake up duration by PIR when power is plenty
+ * @param emptyMillivolts     Battery pack voltage (in millivolts) at which the battery is considered empty
+ */
+Scheduler::Scheduler(unsigned long baseDeepSleep, unsigned long baseWakeupByTimer, unsigned long baseWakeupByPir, uint32_t emptyMillivolts) {
+  _baseDeepSleep = baseDeepSleep;
+  _baseWakeupByTimer = baseWakeupByTimer;
+  _baseWakeupByPir = baseWakeupByPir;
+  _emptyMillivolts = emptyMillivolts;
+  _multiplier = 1.0;
+  _idle = false;
+  _deepSleep = baseDeepSleep;
+  _wakeupByTimer = baseWakeupByTimer;
+  _wakeupByPir = baseWakeupByPir;
+}
+
+
+/**
+ * Scheduler::recordBatterySample
+ * Add a battery sample to the history
+ * @param millivolts    Battery pack voltage
+ * @param timestamp     Sample timestamp (samples without a valid date are ignored)
+ */
+void Scheduler::recordBatterySample(uint32_t millivolts, unsigned long timestamp) {
+  if(timestamp < 1000000000) return;
+  __schedulerHistory.batteryMillivolts[__schedulerHistory.batteryNext] = millivolts;
+  __schedulerHistory.batteryTimestamps[__schedulerHistory.batteryNext] = timestamp;
+  __schedulerHistory.batteryNext = (__schedulerHistory.batteryNext + 1) % _SCHEDULER_BATTERY_SAMPLES;
+  if(__schedulerHistory.batteryCount < _SCHEDULER_BATTERY_SAMPLES) __schedulerHistory.batteryCount++;
+}
+
+
+/**
+ * Scheduler::recordPirEvent
+ * Add a PIR event to the history
+ * @param hour    Hour of day of the event (negative if unknown)
+ */
+void Scheduler::recordPirEvent(int8_t hour) {
+  if((hour < 0) || (hour > 23)) return;
+  if(__schedulerHistory.pirEvents[hour] == 255) {
+    for(uint8_t i=0; i<24; i++) __schedulerHistory.pirEvents[i] /= 2;
+  }
+  __schedulerHistory.pirEvents[hour]++;
+}
+
+
+/**
+ * Scheduler::recordTimerWake
+ * Add a timer wake to the history
+ * @param commandsReceived    true if telegram commands arrived during the wake
+ */
+void Scheduler::recordTimerWake(bool commandsReceived) {
+  if(__schedulerHistory.timerWakes == 1000) {
+    __schedulerHistory.timerWakes /= 2;
+    __schedulerHistory.timerWakesWithCommands /= 2;
+  }
+  __schedulerHistory.timerWakes++;
+  if(commandsReceived) __schedulerHistory.timerWakesWithCommands++;
+}
+
+
+/**
+ * Scheduler::update
+ * Calculate the durations: when power is scarce sleeps are longer and wake ups shorter, more so if the camera is idle
+ * (few telegram commands during timer wakes and no PIR activity usually at this hour)
+ * @param batteryLevel    Battery level (0-5)
+ * @param hour            Current hour of day (negative if unknown)
+ */
+void Scheduler::update(uint8_t batteryLevel, int8_t hour) {
+  //Power: battery level, then projected lifetime
+  if(batteryLevel >= 4) _multiplier = 1.0;
+  else if(batteryLevel == 3) _multiplier = 1.5;
+  else if(batteryLevel == 2) _multiplier = 2.0;
+  else _multiplier = 3.0;
+  long lifetime = getProjectedLifetime();
+  if((lifetime >= 0) && (lifetime < _SCHEDULER_LIFETIME_TARGET)) _multiplier *= 1.5;
+
+  //Activity: PIR events at this hour compared to the average hour
+  bool activeHour = false;
+  if((hour >= 0) && (hour <= 23)) {
+    uint16_t total = 0;
+    for(uint8_t i=0; i<24; i++) total += __schedulerHistory.pirEvents[i];
+    activeHour = (__schedulerHistory.pirEvents[hour] > 0) && ((__schedulerHistory.pirEvents[hour] * 24) >= total);
+  }
+  bool fewCommands = (_getCommandsRate() < _SCHEDULER_IDLE_COMMANDS_RATE);
+  _idle = fewCommands && !activeHour;
+  if(_idle && (_multiplier > 1.0)) _multiplier *= 2.0;
+
+  //Durations
+  _deepSleep = min((unsigned long)(_baseDeepSleep * _multiplier), (unsigned long)_SCHEDULER_MAX_DEEP_SLEEP);
+  if(_deepSleep < _baseDeepSleep) _deepSleep = _baseDeepSleep;
+  _wakeupByTimer = _baseWakeupByTimer;
+  if(fewCommands && (_multiplier > 1.0)) _wakeupByTimer = max((unsigned long)(_baseWakeupByTimer / _multiplier), min(_baseWakeupByTimer, (unsigned long)_SCHEDULER_MIN_WAKEUP_BY_TIMER));
+  _wakeupByPir = _baseWakeupByPir;
+  if(!activeHour) _wakeupByPir = max((unsigned long)(_baseWakeupByPir / _multiplier), min(_baseWakeupByPir, (unsigned long)_SCHEDULER_MIN_WAKEUP_BY_PIR));
+}
+
+
+/**
+ * Scheduler::getDeepSleepDuration
+ * Get deep sleep duration
+ * @return    Deep sleep duration in seconds
+ */
+unsigned long Scheduler::getDeepSleepDuration() {
+  return _deepSleep;
+}
+
+
+/**
+ * Scheduler::getWakeupDurationByTimer
+ * Get wake up duration by timer
+ * @return    Wake up duration in seconds
+ */
+unsigned long Scheduler::getWakeupDurationByTimer() {
+  return _wakeupByTimer;
+}
+
+
+/**
+ * Scheduler::getWakeupDurationByPir
+ * Get wake up duration by PIR
+ * @return    Wake up duration in seconds
+ */
+unsigned long Scheduler::getWakeupDurationByPir() {
+  return _wakeupByPir;
+}
+
+
+/**
+ * Scheduler::getBatteryTrend
+ * Get battery voltage trend, as the least-squares slope of all the samples (a single noisy sample barely moves it)
+ * @return    Trend in millivolts per hour (0 if not enough samples)
+ */
+float Scheduler::getBatteryTrend() {
+  uint8_t count = __schedulerHistory.batteryCount;
+  if(count < 3) return 0;
+  uint8_t newest = (__schedulerHistory.batteryNext + _SCHEDULER_BATTERY_SAMPLES - 1) % _SCHEDULER_BATTERY_SAMPLES;
+  uint8_t oldest = (count < _SCHEDULER_BATTERY_SAMPLES) ? 0 : __schedulerHistory.batteryNext;
+  unsigned long start = __schedulerHistory.batteryTimestamps[oldest];
+  long span = __schedulerHistory.batteryTimestamps[newest] - start;
+  if(span < _SCHEDULER_TREND_MIN_SPAN) return 0;
+
+  //Hours from the oldest sample, and their mean
+  float meanHours = 0, meanMillivolts = 0;
+  for(uint8_t i=0; i<count; i++) {
+    meanHours += (__schedulerHistory.batteryTimestamps[i] - start) / 3600.0;
+    meanMillivolts += __schedulerHistory.batteryMillivolts[i];
+  }
+  meanHours /= count;
+  meanMillivolts /= count;
+
+  //Slope
+  float sumXX = 0, sumXY = 0;
+  for(uint8_t i=0; i<count; i++) {
+    float hours = ((__schedulerHistory.batteryTimestamps[i] - start) / 3600.0) - meanHours;
+    sumXX += hours * hours;
+    sumXY += hours * (__schedulerHistory.batteryMillivolts[i] - meanMillivolts);
+  }
+  return (sumXX > 0) ? (sumXY / sumXX) : 0;
+}
+
+
+/**
+ * Scheduler::getProjectedLifetime
+ * Get projected battery lifetime, based on the battery voltage trend
+ * @return    Lifetime in hours (-1 if unknown, i.e. battery not discharging or not enough samples)
+ */
+long Scheduler::getProjectedLifetime() {
+  float trend = getBatteryTrend();
+  if(trend >= 0) return -1;
+  uint8_t newest = (__schedulerHistory.batteryNext + _SCHEDULER_BATTERY_SAMPLES - 1) % _SCHEDULER_BATTERY_SAMPLES;
+  uint32_t millivolts = __schedulerHistory.batteryMillivolts[newest];
+  if(millivolts <= _emptyMillivolts) return 0;
+  return (long)((millivolts - _emptyMillivolts) / -trend);
+}
+
+
+/**
+ * Scheduler::getPolicy
+ * Get description of the current policy
+ * @return    Policy description
+ */
+String Scheduler::getPolicy() {
+  String policy = (_multiplier > 1.0) ? "power saving (x" + String(_multiplier, 1) + ")" : "normal";
+  if(_idle) policy += ", idle";
+  return policy;
+}
+
+
+/**
+ * Scheduler::_getCommandsRate
+ * Get percentage of timer wakes with telegram commands
+ * @return    Commands rate (100 if not enough timer wakes)
+ */
+uint8_t Scheduler::_getCommandsRate() {
+  if(__schedulerHistory.timerWakes < _SCHEDULER_MIN_TIMER_WAKES) return 100;
+  return (__schedulerHistory.timerWakesWithCommands * 100) / __schedulerHistory.timerWakes;
+}
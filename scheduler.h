@@ -0,0 +1,66 @@
+/**
+ * @package Wildlife Camera
+ * Adaptive duty-cycle scheduler header
+ * @author WizLab.it
+ * @board AI-Thinker ESP32-CAM
+ * @version 20261018.001
+ */
+
+#ifndef SCHEDULER_H
+#define SCHEDULER_H
+
+
+/**
+ * Defines
+ */
+#define _SCHEDULER_BATTERY_SAMPLES        32      //Number of battery samples kept to calculate the trend (about 8 hours, one sample every 15 minutes)
+#define _SCHEDULER_TREND_MIN_SPAN         21600   //In seconds, min time between oldest and newest samples to calculate the trend
+#define _SCHEDULER_LIFETIME_TARGET        168     //In hours, projected lifetime below which durations are further stretched
+#define _SCHEDULER_MAX_DEEP_SLEEP         3600    //In seconds, max deep sleep duration
+#define _SCHEDULER_MIN_WAKEUP_BY_TIMER    3       //In seconds, min wake up duration by timer
+#define _SCHEDULER_MIN_WAKEUP_BY_PIR      20      //In seconds, min wake up duration by PIR
+#define _SCHEDULER_MIN_TIMER_WAKES        10      //Number of timer wakes needed before considering the commands rate
+#define _SCHEDULER_IDLE_COMMANDS_RATE     10      //Percentage of timer wakes with telegram commands below which the camera is idle
+
+
+/**
+ * Includes
+ */
+#include <Arduino.h>
+
+
+/**
+ * Class definition
+ * Durations are calculated by update() from the history kept in RTC memory: no hardware access, so it can be fed with simulated traces
+ */
+class Scheduler {
+  private:
+    unsigned long _baseDeepSleep;
+    unsigned long _baseWakeupByTimer;
+    unsigned long _baseWakeupByPir;
+    uint32_t _emptyMillivolts;
+
+    float _multiplier;
+    bool _idle;
+    unsigned long _deepSleep;
+    unsigned long _wakeupByTimer;
+    unsigned long _wakeupByPir;
+
+    uint8_t _getCommandsRate();
+
+  public:
+    Scheduler(unsigned long baseDeepSleep, unsigned long baseWakeupByTimer, unsigned long baseWakeupByPir, uint32_t emptyMillivolts);
+    void recordBatterySample(uint32_t millivolts, unsigned long timestamp);
+    void recordPirEvent(int8_t hour);
+    void recordTimerWake(bool commandsReceived);
+    void update(uint8_t batteryLevel, int8_t hour);
+    unsigned long getDeepSleepDuration();
+    unsigned long getWakeupDurationByTimer();
+    unsigned long getWakeupDurationByPir();
+    float getBatteryTrend();
+    long getProjectedLifetime();
+    String getPolicy();
+};
+
+
+#endif
@@ -12,6 +12,11 @@
  * Variables
  */
 RTC_DATA_ATTR long __telegramLastUpdateId = -1;
+RTC_DATA_ATTR struct {
+  uint32_t requests = 0;
+  uint32_t retries = 0;
+  uint32_t failures = 0;
+} __telegramStats;
 
 
 /**
@@ -24,10 +29,61 @@ RTC_DATA_ATTR long __telegramLastUpdateId = -1;
 Telegram::Telegram(String apiToken, int64_t chatId, void (*commandProcessorFunction)(const char*)) {
   _apiToken = apiToken;
   _chatId = chatId;
+  _extraChatIdsCount = 0;
+  _commandChatId = 0;
+  _retryAfter = 0;
+  _gatewayHost = "";
+  _gatewayPort = 80;
+  _gatewayDeviceId = "";
   _commandProcessorFunction = commandProcessorFunction;
 }
 
 
+/**
+ * Telegram::addChatIds
+ * Add additional recipients: photos are uploaded once to the main chat, then forwarded to them by file_id
+ * @param chatIds   comma-separated list of Chat IDs (i.e. "-67890,-13579")
+ * @return          number of additional recipients
+ */
+uint8_t Telegram::addChatIds(const char* chatIds) {
+  char* next = (char*)chatIds;
+  while((next != NULL) && (*next != '\0') && (_extraChatIdsCount < _TELEGRAM_MAX_RECIPIENTS)) {
+    char* end;
+    int64_t chatId = strtoll(next, &end, 10);
+    if(end == next) break;
+    if(chatId != 0) _extraChatIds[_extraChatIdsCount++] = chatId;
+    next = (*end == ',') ? (end + 1) : NULL;
+  }
+  return _extraChatIdsCount;
+}
+
+
+/**
+ * Telegram::setGateway
+ * Send requests over plain HTTP to a LAN gateway instead of telegram: the gateway queues, deduplicates and batches
+ * photos to telegram, and relays the commands of this device. Requests are sent to /device/<deviceId>/<method>,
+ * with device metadata in X-Device-* headers; telegram methods keep their payload and response format.
+ * @param host        Gateway host name or IP address
+ * @param port        Gateway port
+ * @param deviceId    ID of this device
+ */
+void Telegram::setGateway(String host, uint16_t port, String deviceId) {
+  _gatewayHost = host;
+  _gatewayPort = port;
+  _gatewayDeviceId = deviceId;
+}
+
+
+/**
+ * Telegram::isGateway
+ * Check if requests are sent to the LAN gateway
+ * @return    true if the LAN gateway is used; false if requests are sent to telegram
+ */
+bool Telegram::isGateway() {
+  return (_gatewayHost != "");
+}
+
+
 /**
  * Telegram::getUpdates
  * Get updates on a telegram chat
@@ -35,19 +91,18 @@ Telegram::Telegram(String apiToken, int64_t chatId, void (*commandProcessorFunct
  */
 int8_t Telegram::getUpdates() {
   String payload = "offset=" + String(__telegramLastUpdateId);
-  char* response;
+  char* response = NULL;
   int8_t commStatus = _httpRequest(_TELEGRAM_COMMAND_GETUPDATES, (uint8_t*)(payload.c_str()), payload.length(), &response);
   int8_t updatesCount = 0;
 
-  String logDatetime = getDateFormat("%F, %T");
-  if(logDatetime == "") logDatetime = "Unknown date";
-  Serial.printf("%s - Get telegram updates (from ID %ld): ", logDatetime.c_str(), __telegramLastUpdateId);
   if(commStatus == 0) {
-    Serial.println("OK");
+    LOG_DEBUG("%s - Get telegram updates (from ID %ld): OK", ((getDateFormat("%Y") == "") ? "Unknown date" : getDateFormat("%F, %T").c_str()), __telegramLastUpdateId);
 
     //Parse response
+    Benchmark benchmark("telegram.getUpdatesJson");
     JsonDocument jsonParsed;
     deserializeJson(jsonParsed, response);
+    benchmark.end(strlen(response));
 
     //Process updates
     JsonArray updates = jsonParsed["result"].as<JsonArray>();
@@ -59,14 +114,19 @@ int8_t Telegram::getUpdates() {
         //Set next Update ID
         __telegramLastUpdateId = updateId + 1;
 
-        //Check if emssage is a command, then process it
-        if(message[0] == '/') {
+        //Check if emssage is a command, then process it (updates without text, i.e. photos or edited messages, are skipped)
+        if((message != NULL) && (message[0] == '/')) {
           strtok((char*)message, "@");
-          Serial.printf(" [i] Received telegram command: %s\n", message);
-          if(_commandProcessorFunction == NULL) {
-            Serial.println(" [-] External command processor not defined");
+          int64_t chatId = update["message"]["chat"]["id"].as<long long>();
+          LOG_INFO(" [i] Received telegram command: %s", message);
+          if(!isAuthorizedChat(chatId)) {
+            LOG_WARNING(" [-] Telegram command from unauthorized chat %lld ignored", (long long)chatId);
+          } else if(_commandProcessorFunction == NULL) {
+            LOG_ERROR(" [-] External command processor not defined");
           } else {
+            _commandChatId = chatId;
             _commandProcessorFunction(message);
+            _commandChatId = 0;
           }
         }
 
@@ -75,8 +135,10 @@ int8_t Telegram::getUpdates() {
       }
     }
   } else {
-    Serial.printf("failed (err: %d)\n", commStatus);
+    LOG_WARNING(" [-] Get telegram updates (from ID %ld): failed (err: %d)", __telegramLastUpdateId, commStatus);
   }
+  free(response);
+  response = NULL;
 
   //If commStatus is 0, then check was successful: returns number of processed updates
   if(commStatus == 0) return updatesCount;
@@ -95,14 +157,14 @@ int8_t Telegram::getUpdates() {
 int8_t Telegram::sendMessage(String message) {
   String payload = "chat_id=" + String(_chatId) + "&text=" + urlEncode(message);
 
-  char* response;
-  int8_t commStatus = _httpRequest(_TELEGRAM_COMMAND_MESSAGE, (uint8_t*)(payload.c_str()), payload.length(), &response);
+  char* response = NULL;
+  int8_t commStatus = _httpRequestRetry(_TELEGRAM_COMMAND_MESSAGE, (uint8_t*)(payload.c_str()), payload.length(), &response);
+  free(response);
 
-  Serial.print(" [+] Send telegram message: ");
   if(commStatus == 0) {
-    Serial.println("OK");
+    LOG_INFO(" [+] Send telegram message: OK");
   } else {
-    Serial.printf("failed (err: %d)\n", commStatus);
+    LOG_ERROR(" [-] Send telegram message: failed (err: %d)", commStatus);
   }
 
   return commStatus;
@@ -117,75 +179,319 @@ int8_t Telegram::sendMessage(String message) {
  */
 int8_t Telegram::sendAction(String action) {
   String payload = "chat_id=" + String(_chatId) + "&action=" + action;
-  char* response;
+  char* response = NULL;
   int8_t commStatus = _httpRequest(_TELEGRAM_COMMAND_ACTION, (uint8_t*)(payload.c_str()), payload.length(), &response);
+  free(response);
   return commStatus;
 }
 
 
 /**
  * Telegram::sendPhoto
- * Take a photo and send it to a telegram chat
- * @param photo         pointer to the photo data
- * @param photoLength   length of the photo data
- * @return              0 if successful, negative value if error
+ * Upload a photo to the telegram chat, then forward it by file_id to the additional recipients
+ * @param photo           pointer to the photo data
+ * @param photoLength     length of the photo data
+ * @param fileIdToReturn  (optional) buffer of _TELEGRAM_FILEID_MAX_LENGTH bytes where the file_id returned by telegram is stored
+ * @param captionNote     (optional) additional line appended to the caption
+ * @return                0 if successful, negative value if error
  */
-int8_t Telegram::sendPhoto(uint8_t *photo, long photoLength) {
+int8_t Telegram::sendPhoto(uint8_t *photo, long photoLength, char* fileIdToReturn, String captionNote) {
+  //Caption
+  String caption = _getPhotoCaption();
+  if(captionNote != "") caption += "\r\n" + captionNote;
+
+  //Upload to the main chat (the LAN gateway takes care of recipients)
+  String fileId = "";
+  int8_t commStatus = _sendPhoto(0, photo, photoLength, caption, fileId);
+
+  //Return file_id
+  if(fileIdToReturn != NULL) {
+    memset(fileIdToReturn, 0x00, _TELEGRAM_FILEID_MAX_LENGTH);
+    strncpy(fileIdToReturn, fileId.c_str(), (_TELEGRAM_FILEID_MAX_LENGTH - 1));
+  }
+
+  //Forward the photo to the additional recipients without uploading it again
+  if(fileId != "") {
+    for(uint8_t i=0; i<_extraChatIdsCount; i++) {
+      _sendPhotoByFileId(_extraChatIds[i], fileId, caption);
+    }
+  }
+
+  return commStatus;
+}
+
+
+/**
+ * Telegram::sendPhotoToChat
+ * Upload a photo to a single telegram chat (not forwarded to the additional recipients)
+ * @param photo           pointer to the photo data
+ * @param photoLength     length of the photo data
+ * @param chatId          Telegram Chat ID where to send the photo
+ * @param timestamp       timestamp of the photo, shown in the caption (0: current time)
+ * @param fileIdToReturn  (optional) buffer of _TELEGRAM_FILEID_MAX_LENGTH bytes where the file_id returned by telegram is stored
+ * @return                0 if successful, negative value if error
+ */
+int8_t Telegram::sendPhotoToChat(uint8_t *photo, long photoLength, int64_t chatId, unsigned long timestamp, char* fileIdToReturn) {
+  String fileId = "";
+  int8_t commStatus = _sendPhoto(chatId, photo, photoLength, _getPhotoCaption(timestamp), fileId);
+  if(fileIdToReturn != NULL) {
+    memset(fileIdToReturn, 0x00, _TELEGRAM_FILEID_MAX_LENGTH);
+    strncpy(fileIdToReturn, fileId.c_str(), (_TELEGRAM_FILEID_MAX_LENGTH - 1));
+  }
+  return commStatus;
+}
+
+
+/**
+ * Telegram::sendPhotoByFileId
+ * Send an already uploaded photo to a single telegram chat
+ * @param fileId      file_id returned by telegram when the photo was uploaded
+ * @param chatId      Telegram Chat ID where to send the photo
+ * @param timestamp   timestamp of the photo, shown in the caption (0: current time)
+ * @return            0 if successful, negative value if error
+ */
+int8_t Telegram::sendPhotoByFileId(const char* fileId, int64_t chatId, unsigned long timestamp) {
+  //Check file_id
+  if((fileId == NULL) || (fileId[0] == '\0')) return -1;
+  return _sendPhotoByFileId(chatId, fileId, _getPhotoCaption(timestamp));
+}
+
+
+/**
+ * Telegram::isAuthorizedChat
+ * Check if a chat can send commands: only the main chat and the additional recipients are answered
+ * @param chatId    Chat ID to check
+ * @return          true if the chat is the main chat or one of the additional recipients
+ */
+bool Telegram::isAuthorizedChat(int64_t chatId) {
+  if(chatId == _chatId) return true;
+  for(uint8_t i=0; i<_extraChatIdsCount; i++) {
+    if(chatId == _extraChatIds[i]) return true;
+  }
+  return false;
+}
+
+
+/**
+ * Telegram::getCommandChatId
+ * Get the Chat ID that sent the command being processed, so replies can be sent only to it
+ * @return    Chat ID of the command, or the main Chat ID if no command is being processed
+ */
+int64_t Telegram::getCommandChatId() {
+  return (_commandChatId != 0) ? _commandChatId : _chatId;
+}
+
+
+/**
+ * Telegram::_sendPhoto
+ * Upload a photo to a telegram chat (multipart upload), or to the LAN gateway
+ * @param chatId          Telegram Chat ID where to send the photo (0: main chat; for the LAN gateway, its recipients)
+ * @param photo           pointer to the photo data
+ * @param photoLength     length of the photo data
+ * @param caption         photo caption
+ * @param fileIdToReturn  file_id returned by telegram (empty if not available)
+ * @return                0 if successful, negative value if error
+ */
+int8_t Telegram::_sendPhoto(int64_t chatId, uint8_t *photo, long photoLength, String caption, String &fileIdToReturn) {
+  fileIdToReturn = "";
+
   //Check length
   if(photoLength < 1) return -1;
 
+  //LAN gateway: send the photo as is, the gateway takes care of recipients unless a chat is set
+  if(isGateway()) {
+    char* response = NULL;
+    String query = "?caption=" + urlEncode(caption);
+    if(chatId != 0) query += "&chat_id=" + String(chatId);
+    int8_t commStatus = _httpRequestRetry(_TELEGRAM_COMMAND_GATEWAY_PHOTO, photo, photoLength, &response, query);
+    free(response);
+    if(commStatus == 0) {
+      LOG_INFO(" [+] Send photo to gateway %s: OK", _gatewayHost.c_str());
+    } else {
+      LOG_ERROR(" [-] Send photo to gateway %s: failed (err: %d)", _gatewayHost.c_str(), commStatus);
+    }
+    return commStatus;
+  }
+  if(chatId == 0) chatId = _chatId;
+
   //Send upload_photo action
   sendAction("upload_photo");
 
   //Prepare payload head and tail
-  String caption = "Wildlife Camera photo on the " + getDateFormat("%F") + " at " + getDateFormat("%T") + "\r\nSD Used Space: " + String(cameraSdGetUsedSpace()) + "%";
   String payloadHead = "--" + String(_TELEGRAM_MULTIPART_BOUNDARY) + "\r\n"
-    "Content-Disposition: form-data; name=\"chat_id\"; \r\n\r\n" + String(_chatId) + "\r\n--" + String(_TELEGRAM_MULTIPART_BOUNDARY) + "\r\n"
+    "Content-Disposition: form-data; name=\"chat_id\"; \r\n\r\n" + String(chatId) + "\r\n--" + String(_TELEGRAM_MULTIPART_BOUNDARY) + "\r\n"
     "Content-Disposition: form-data; name=\"caption\"; \r\n\r\n" + caption + "\r\n--" + String(_TELEGRAM_MULTIPART_BOUNDARY) + "\r\n"
     "Content-Disposition: form-data; name=\"photo\"; filename=\"photo.jpg\"\r\nContent-Type: image/jpeg\r\n\r\n";
   String payloadTail = "\r\n--" + String(_TELEGRAM_MULTIPART_BOUNDARY) + "--\r\n";
 
   //Create payload
+  Benchmark benchmark("telegram.photoPayload");
   long payloadLengthFinal = payloadHead.length() + photoLength + payloadTail.length(); //Calculate final payload length (head + image + tail)
   uint8_t *payload = (uint8_t *)malloc(payloadLengthFinal); //Allocate space for payload
   memcpy(payload, (uint8_t*)(payloadHead.c_str()), payloadHead.length()); //Add head to payload
   memcpy((payload + payloadHead.length()), photo, photoLength); //Add photo to payload
   memcpy((payload + payloadHead.length() + photoLength), (uint8_t*)(payloadTail.c_str()), payloadTail.length()); //Add tail to payload
+  benchmark.end(payloadLengthFinal);
 
   //Send request
-  char* response;
-  int8_t commStatus = _httpRequest(_TELEGRAM_COMMAND_PHOTO, payload, payloadLengthFinal, &response);
-  Serial.print(" [+] Send telegram photo: ");
+  char* response = NULL;
+  int8_t commStatus = _httpRequestRetry(_TELEGRAM_COMMAND_PHOTO, payload, payloadLengthFinal, &response);
   if(commStatus == 0) {
-    Serial.println("OK");
+    LOG_INFO(" [+] Send telegram photo to %lld: OK", (long long)chatId);
   } else {
-    Serial.printf("failed (err: %d)\n", commStatus);
+    LOG_ERROR(" [-] Send telegram photo to %lld: failed (err: %d)", (long long)chatId, commStatus);
   }
 
-  //Free payload and return
+  //Free payload
   free(payload);
   payload = NULL;
+
+  //Get file_id of the uploaded photo (last item is the largest size)
+  if(commStatus == 0) {
+    JsonDocument filter;
+    filter["result"]["photo"][0]["file_id"] = true;
+    JsonDocument jsonParsed;
+    deserializeJson(jsonParsed, response, DeserializationOption::Filter(filter));
+    JsonArray sizes = jsonParsed["result"]["photo"].as<JsonArray>();
+    if(sizes.size() > 0) fileIdToReturn = sizes[sizes.size() - 1]["file_id"].as<String>();
+  }
+  free(response);
+  response = NULL;
+
   return commStatus;
 }
 
 
+/**
+ * Telegram::_sendPhotoByFileId
+ * Send an already uploaded photo to a telegram chat
+ * @param chatId    Telegram Chat ID where to send the photo
+ * @param fileId    file_id returned by telegram when the photo was uploaded
+ * @param caption   photo caption
+ * @return          0 if successful, negative value if error
+ */
+int8_t Telegram::_sendPhotoByFileId(int64_t chatId, String fileId, String caption) {
+  String payload = "chat_id=" + String(chatId) + "&photo=" + urlEncode(fileId) + "&caption=" + urlEncode(caption);
+  char* response = NULL;
+  int8_t commStatus = _httpRequestRetry(_TELEGRAM_COMMAND_PHOTO_ID, (uint8_t*)(payload.c_str()), payload.length(), &response);
+  free(response);
+
+  if(commStatus == 0) {
+    LOG_INFO(" [+] Send telegram photo by file_id to %lld: OK", (long long)chatId);
+  } else {
+    LOG_ERROR(" [-] Send telegram photo by file_id to %lld: failed (err: %d)", (long long)chatId, commStatus);
+  }
+
+  return commStatus;
+}
+
+
+/**
+ * Telegram::_getPhotoCaption
+ * Build the caption for photos
+ * @param timestamp   (optional) timestamp of the photo (0: current time)
+ * @return            Photo caption
+ */
+String Telegram::_getPhotoCaption(unsigned long timestamp) {
+  return "Wildlife Camera photo on the " + getDateFormat("%F", timestamp) + " at " + getDateFormat("%T", timestamp) + "\r\nSD Used Space: " + String(cameraSdGetUsedSpace()) + "%";
+}
+
+
+/**
+ * Telegram::_httpRequestRetry
+ * Telegram request with retries on transient errors
+ * Retries honour the retry_after requested by telegram when rate limited, otherwise use exponential backoff.
+ * A random jitter is added so cameras that fire together don't retry together, and no retry is done if it
+ * would end after the wake up window.
+ * @param command           telegram command
+ * @param payload           data to be sent to telegram
+ * @param payloadLength     data length
+ * @param responseToReturn  pointer of a pointer that will be used to store the response (original variable should be NULL)
+ * @param query             (optional) query string appended to the request path
+ * @return                  0 if successful, negative value if error (see _httpRequest)
+ */
+int8_t Telegram::_httpRequestRetry(uint8_t command, uint8_t* payload, long payloadLength, char** responseToReturn, String query) {
+  int8_t commStatus;
+  for(uint8_t attempt=1; ; attempt++) {
+    __telegramStats.requests++;
+    commStatus = _httpRequest(command, payload, payloadLength, responseToReturn, query);
+
+    //Check if to retry: only on connection errors, truncated responses, rate limit and server errors
+    //(not when the response is lost after the whole request was sent: telegram may have delivered it, a retry would duplicate it)
+    bool retryable = (commStatus == -103) || (commStatus == -104) || (commStatus == -106) || (commStatus == -107);
+    if(!retryable || (attempt >= _TELEGRAM_RETRY_MAX_ATTEMPTS)) break;
+
+    //Calculate delay
+    unsigned long backoff = (unsigned long)_TELEGRAM_RETRY_BACKOFF << (attempt - 1);
+    unsigned long retryDelay;
+    if(commStatus == -106) {
+      retryDelay = (_retryAfter * 1000UL) + random(0, backoff);
+    } else {
+      retryDelay = (backoff / 2) + random(0, (backoff / 2));
+    }
+
+    //Check if retry fits in the wake up window (delay and a full request)
+    if((retryDelay + (_TELEGRAM_WAIT_TIMEOUT * 1000UL)) > getWakeupRemaining()) {
+      LOG_WARNING(" [-] Telegram request failed (err: %d), no time left to retry", commStatus);
+      break;
+    }
+
+    LOG_WARNING(" [*] Telegram request failed (err: %d), retry %d in %lu ms", commStatus, attempt, retryDelay);
+    __telegramStats.retries++;
+    free(*responseToReturn);
+    *responseToReturn = NULL;
+    delay(retryDelay);
+  }
+
+  if(commStatus != 0) __telegramStats.failures++;
+  return commStatus;
+}
+
+
+/**
+ * Telegram::getStatsRequests
+ * Get number of telegram requests (including retries) since the first boot
+ * @return    Number of requests
+ */
+uint32_t Telegram::getStatsRequests() {
+  return __telegramStats.requests;
+}
+
+
+/**
+ * Telegram::getStatsRetries
+ * Get number of retried telegram requests since the first boot
+ * @return    Number of retries
+ */
+uint32_t Telegram::getStatsRetries() {
+  return __telegramStats.retries;
+}
+
+
+/**
+ * Telegram::getStatsFailures
+ * Get number of telegram messages and photos not delivered since the first boot
+ * @return    Number of failures
+ */
+uint32_t Telegram::getStatsFailures() {
+  return __telegramStats.failures;
+}
+
+
 /**
  * Telegram::_httpRequest
- * Low-level communication with telegram server
+ * Low-level communication with telegram server (or with the LAN gateway, over plain HTTP)
  * @param command           telegram command (TELEGRAM_COMMAND_MESSAGE, TELEGRAM_COMMAND_PHOTO)
  * @param payload           data to be sent to telegram
  * @param payloadLength     data length
  * @param responseToReturn  pointer of a pointer that will be used to store the response
- * @return                  0 if successful, negative value if error
+ * @param query             (optional) query string appended to the request path
+ * @return                  0 if successful, negative value if error (-101: WiFi not connected; -102: unknown command; -103: connection failed; -104: no or truncated response; -105: telegram error; -106: rate limited; -107: telegram server error; -108: no or truncated response after the whole request was sent)
  */
-int8_t Telegram::_httpRequest(uint8_t command, uint8_t* payload, long payloadLength, char** responseToReturn) {
+int8_t Telegram::_httpRequest(uint8_t command, uint8_t* payload, long payloadLength, char** responseToReturn, String query) {
   //Check if WiFi is connected
   if(WiFi.status() != WL_CONNECTED) return -101;
 
-  //WiFi Client, no certificate check
-  WiFiClientSecure wifiClient;
-  wifiClient.setInsecure();
-
   //Set command params
   String endpoint;
   String contentType = "application/x-www-form-urlencoded";
@@ -199,55 +505,117 @@ int8_t Telegram::_httpRequest(uint8_t command, uint8_t* payload, long payloadLen
     case _TELEGRAM_COMMAND_ACTION:
       endpoint = "sendChatAction";
       break;
+    case _TELEGRAM_COMMAND_PHOTO_ID:
+      endpoint = "sendPhoto";
+      break;
     case _TELEGRAM_COMMAND_PHOTO:
       endpoint = "sendPhoto";
       contentType = "multipart/form-data; boundary=" + String(_TELEGRAM_MULTIPART_BOUNDARY);
       break;
+    case _TELEGRAM_COMMAND_GATEWAY_PHOTO:
+      if(!isGateway()) return -102;
+      endpoint = "photo";
+      contentType = "image/jpeg";
+      break;
     default:
       return -102;
   }
 
-  //Connect to telegram
-  if(!wifiClient.connect(_TELEGRAM_HOSTNAME, 443)) return -103;
+  //WiFi Client: plain for the LAN gateway, TLS without certificate check for telegram (the TLS client, with its
+  //buffers, is created only when used)
+  if(isGateway()) {
+    WiFiClient plainClient;
+    return _httpExchange(plainClient, endpoint, contentType, payload, payloadLength, responseToReturn, query);
+  }
+  WiFiClientSecure secureClient;
+  secureClient.setInsecure();
+  return _httpExchange(secureClient, endpoint, contentType, payload, payloadLength, responseToReturn, query);
+}
 
-  //Send request header
-  wifiClient.println("POST /bot" + String(_apiToken) + "/" + endpoint + " HTTP/1.1");
-  wifiClient.println("Host: " + String(_TELEGRAM_HOSTNAME));
+
+/**
+ * Telegram::_httpExchange
+ * Send a request to telegram server (or to the LAN gateway) and get its response
+ * @param wifiClient        WiFi Client to be used (TLS for telegram, plain for the LAN gateway)
+ * @param endpoint          telegram method (or gateway endpoint)
+ * @param contentType       content type of the request body
+ * @param payload           data to be sent to telegram
+ * @param payloadLength     data length
+ * @param responseToReturn  pointer of a pointer that will be used to store the response
+ * @param query             query string appended to the request path
+ * @return                  0 if successful, negative value if error (same as _httpRequest)
+ */
+int8_t Telegram::_httpExchange(WiFiClient &wifiClient, String endpoint, String contentType, uint8_t* payload, long payloadLength, char** responseToReturn, String query) {
+  //Connect to telegram or to the gateway, and send request header
+  if(isGateway()) {
+    if(!wifiClient.connect(_gatewayHost.c_str(), _gatewayPort)) return -103;
+    wifiClient.println("POST /device/" + _gatewayDeviceId + "/" + endpoint + query + " HTTP/1.1");
+    wifiClient.println("Host: " + _gatewayHost);
+    wifiClient.println("X-Device-Id: " + _gatewayDeviceId);
+    wifiClient.println("X-Device-Timestamp: " + String(getTimestamp()));
+    wifiClient.println("X-Device-Uptime: " + String(getUptime()));
+    wifiClient.println("X-Device-RSSI: " + String(WiFi.RSSI()));
+  } else {
+    if(!wifiClient.connect(_TELEGRAM_HOSTNAME, 443)) return -103;
+    wifiClient.println("POST /bot" + String(_apiToken) + "/" + endpoint + query + " HTTP/1.1");
+    wifiClient.println("Host: " + String(_TELEGRAM_HOSTNAME));
+  }
   wifiClient.println("Content-Length: " + String(payloadLength));
   wifiClient.println("Content-Type: " + contentType);
   wifiClient.println();
 
   //Send request body
-  for(size_t n=0; n<payloadLength; n=n+1024) {
-    if((n + 1024) < payloadLength) {
-      wifiClient.write((payload + n), 1024);
-    } else if((payloadLength % 1024) > 0) {
-      wifiClient.write((payload + n), (payloadLength % 1024));
-    }
+  long sent = 0;
+  while(sent < payloadLength) {
+    size_t wb = wifiClient.write((payload + sent), min(1024L, (payloadLength - sent)));
+    if(wb == 0) break;
+    sent += wb;
   }
 
-  //Get response
-  uint8_t nlcrCounter = 0;
+  //Get response: status line and headers, then body (Content-Length bytes, or until the connection is closed)
+  Benchmark benchmark("telegram.httpResponse");
+  int httpStatus = 0;
+  long contentLength = -1;
   bool isHeader = true;
-  long waitUntil = millis() + (_TELEGRAM_WAIT_TIMEOUT * 1000);
+  unsigned long waitUntil = millis() + (_TELEGRAM_WAIT_TIMEOUT * 1000);
+  String line = "";
   String response = "";
+  char buffer[512];
 
   while(waitUntil > millis()) {
-    delay(100);
-    while(wifiClient.available()) {
+    int available = wifiClient.available();
+    if(available <= 0) {
+      if(!wifiClient.connected()) break;
+      delay(10);
+      continue;
+    }
+
+    if(isHeader) {
       char c = wifiClient.read();
-      if(isHeader) {
-        if((c == '\n') || (c == '\r')) nlcrCounter++;
-        else nlcrCounter = 0;
-        if(nlcrCounter == 4) isHeader = false;
-      } else {
-        response += String(c);
+      if(c != '\n') {
+        line += c;
+        continue;
+      }
+      line.trim();
+      if(line.length() == 0) {
+        isHeader = false;
+        if(contentLength > 0) response.reserve(contentLength);
+        if(contentLength == 0) break;
+      } else if(httpStatus == 0) {
+        httpStatus = line.substring(line.indexOf(' ') + 1).toInt();
+      } else if(line.substring(0, 15).equalsIgnoreCase("Content-Length:")) {
+        contentLength = line.substring(15).toInt();
       }
+      line = "";
+    } else {
+      int rb = wifiClient.read((uint8_t *)buffer, min(available, (int)sizeof(buffer)));
+      if(rb > 0) response.concat(buffer, rb);
+      if((contentLength >= 0) && ((long)response.length() >= contentLength)) break;
     }
-    if(response.length() != 0) break;
   }
   wifiClient.stop();
-  if(response.length() == 0) return -104;
+  benchmark.end(response.length());
+  if((response.length() == 0) || ((contentLength >= 0) && ((long)response.length() < contentLength))) return ((sent == payloadLength) ? -108 : -104);
 
   //Prepare response to return
   *responseToReturn = (char *)malloc(response.length() + 5);
@@ -256,6 +624,11 @@ int8_t Telegram::_httpRequest(uint8_t command, uint8_t* payload, long payloadLen
   //Process response
   JsonDocument json;
   deserializeJson(json, response);
+  if(httpStatus == 429) {
+    _retryAfter = json["parameters"]["retry_after"] | 1;
+    return -106;
+  }
+  if(httpStatus >= 500) return -107;
   if(json["ok"] != true) return -105;
 
   //If here, all good
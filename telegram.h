@@ -15,11 +15,17 @@
 #define _TELEGRAM_HOSTNAME             "api.telegram.org"
 #define _TELEGRAM_MULTIPART_BOUNDARY   "TelegramMultipartBoundary"
 #define _TELEGRAM_WAIT_TIMEOUT         10
+#define _TELEGRAM_RETRY_MAX_ATTEMPTS   3
+#define _TELEGRAM_RETRY_BACKOFF        2000  //In milliseconds, backoff of the first retry (doubled at each retry)
+#define _TELEGRAM_MAX_RECIPIENTS       5
+#define _TELEGRAM_FILEID_MAX_LENGTH    100
 
 #define _TELEGRAM_COMMAND_GETUPDATES   1
 #define _TELEGRAM_COMMAND_MESSAGE      2
 #define _TELEGRAM_COMMAND_PHOTO        3
 #define _TELEGRAM_COMMAND_ACTION       4
+#define _TELEGRAM_COMMAND_PHOTO_ID     5
+#define _TELEGRAM_COMMAND_GATEWAY_PHOTO 6   //Raw JPEG upload to the LAN gateway
 
 
 /**
@@ -30,6 +36,8 @@
 #include <WiFi.h>
 #include <WiFiClientSecure.h>
 #include <UrlEncode.h>
+#include "benchmark.h"
+#include "logger.h"
 #include "extern.h"
 
 
@@ -40,16 +48,38 @@ class Telegram {
   private:
     String _apiToken;
     int64_t _chatId;
+    int64_t _extraChatIds[_TELEGRAM_MAX_RECIPIENTS];
+    uint8_t _extraChatIdsCount;
+    int64_t _commandChatId;   //Chat ID that sent the command being processed (0 if none)
+    uint16_t _retryAfter;   //Seconds to wait requested by telegram in the last rate limited response
+    String _gatewayHost;    //LAN gateway that relays requests to telegram (empty: direct connection to telegram)
+    uint16_t _gatewayPort;
+    String _gatewayDeviceId;
     void (*_commandProcessorFunction)(const char*); //Pointer to external command processor function
 
-    int8_t _httpRequest(uint8_t command, uint8_t* payload, long payloadLength, char** responseToReturn);
+    int8_t _httpRequest(uint8_t command, uint8_t* payload, long payloadLength, char** responseToReturn, String query = "");
+    int8_t _httpExchange(WiFiClient &wifiClient, String endpoint, String contentType, uint8_t* payload, long payloadLength, char** responseToReturn, String query);
+    int8_t _httpRequestRetry(uint8_t command, uint8_t* payload, long payloadLength, char** responseToReturn, String query = "");
+    int8_t _sendPhoto(int64_t chatId, uint8_t *photo, long photoLength, String caption, String &fileIdToReturn);
+    int8_t _sendPhotoByFileId(int64_t chatId, String fileId, String caption);
+    String _getPhotoCaption(unsigned long timestamp = 0);
 
   public:
     Telegram(String apiToken, int64_t chatId, void (*commandProcessorFunction)(const char*) = NULL);
     int8_t getUpdates();
     int8_t sendMessage(String message);
-    int8_t sendPhoto(uint8_t *photo, long photoLength);
+    uint8_t addChatIds(const char* chatIds);
+    void setGateway(String host, uint16_t port, String deviceId);
+    bool isGateway();
+    int8_t sendPhoto(uint8_t *photo, long photoLength, char* fileIdToReturn = NULL, String captionNote = "");
+    int8_t sendPhotoToChat(uint8_t *photo, long photoLength, int64_t chatId, unsigned long timestamp, char* fileIdToReturn = NULL);
+    int8_t sendPhotoByFileId(const char* fileId, int64_t chatId, unsigned long timestamp);
+    bool isAuthorizedChat(int64_t chatId);
+    int64_t getCommandChatId();
     int8_t sendAction(String action);
+    uint32_t getStatsRequests();
+    uint32_t getStatsRetries();
+    uint32_t getStatsFailures();
 };
 
 
@@ -0,0 +1,296 @@
+/**
+ * @package Wildlife Camera
+ * Scheduled timelapse
+ * @author WizLab.it
+ * @board AI-Thinker ESP32-CAM
+ * @version 20261018.001
+ */
+
+#include "timelapse.h"
+
+
+/**
+ * Variables
+ * Schedule, frames waiting for upload and costs (kept across deep sleeps)
+ */
+RTC_DATA_ATTR struct {
+  bool configured = false;
+  uint16_t interval = 0;                //In minutes (0: disabled)
+  uint8_t startHour = 0;
+  uint8_t endHour = 24;
+  unsigned long nextCapture = 0;
+  unsigned long nextPoll = 0;           //Next timer wake up with WiFi and telegram commands
+  bool captureOnlyWake = false;         //Next timer wake up is only for a capture
+  unsigned long lastUpload = 0;
+  char pending[_TIMELAPSE_MAX_PENDING][_TIMELAPSE_FILENAME_LENGTH];
+  unsigned long pendingTimestamps[_TIMELAPSE_MAX_PENDING];
+  uint8_t pendingFirst = 0;
+  uint8_t pendingCount = 0;
+  uint32_t frames = 0;
+  uint32_t framesDropped = 0;
+  uint32_t captureOnlyWakes = 0;
+  uint32_t captureOnlyMillis = 0;       //Total awake time of capture only wake ups
+  uint32_t batches = 0;
+  uint32_t framesUploaded = 0;
+  uint32_t uploadMillis = 0;            //Total awake time of wake ups with upload (WiFi connection included)
+} __timelapse;
+
+
+/**
+ * Timelapse
+ * Class constructor, the schedule is set only on the first boot (then it can be changed with configure())
+ * @param interval          In minutes, time between captures (0: disabled)
+ * @param startHour         Hour of day when captures start (0-23)
+ * @param endHour           Hour of day when captures end (1-24, can be lower than startHour for night captures)
+ * @param uploadInterval    In seconds, time between uploads of the captured frames
+ */
+Timelapse::Timelapse(uint16_t interval, uint8_t startHour, uint8_t endHour, unsigned long uploadInterval) {
+  _uploadInterval = uploadInterval;
+  if(!__timelapse.configured) {
+    configure(interval, startHour, endHour);
+    __timelapse.configured = true;
+  }
+}
+
+
+/**
+ * Timelapse::configure
+ * Set the schedule
+ * @param interval    In minutes, time between captures (0: disabled)
+ * @param startHour   Hour of day when captures start (0-23)
+ * @param endHour     Hour of day when captures end (1-24)
+ * @return            true if the schedule is valid and set; false otherwise
+ */
+bool Timelapse::configure(uint16_t interval, uint8_t startHour, uint8_t endHour) {
+  if((interval > 1440) || (startHour > 23) || (endHour > 24) || (startHour == endHour)) return false;
+  __timelapse.interval = interval;
+  __timelapse.startHour = startHour;
+  __timelapse.endHour = endHour;
+  __timelapse.nextCapture = 0;
+  __timelapse.captureOnlyWake = false;
+  return true;
+}
+
+
+/**
+ * Timelapse::isEnabled
+ * Check if the timelapse is enabled
+ * @return    true if enabled; false otherwise
+ */
+bool Timelapse::isEnabled() {
+  return (__timelapse.interval > 0);
+}
+
+
+/**
+ * Timelapse::getSchedule
+ * Get description of the schedule
+ * @return    Schedule description
+ */
+String Timelapse::getSchedule() {
+  if(!isEnabled()) return "disabled";
+  char schedule[50];
+  snprintf(schedule, sizeof(schedule), "every %u minutes, %02u:00-%02u:00", __timelapse.interval, __timelapse.startHour, __timelapse.endHour);
+  return String(schedule);
+}
+
+
+/**
+ * Timelapse::isCaptureDue
+ * Check if a frame should be captured now (date and time must be known)
+ * @return    true if a capture is due; false otherwise
+ */
+bool Timelapse::isCaptureDue() {
+  if(!isEnabled()) return false;
+  unsigned long now = getTimestamp();
+  if(now < 1000000000) return false;
+  if(!_isInWindow(getHour(now))) return false;
+  return ((now + _TIMELAPSE_EARLY_MARGIN) >= __timelapse.nextCapture);
+}
+
+
+/**
+ * Timelapse::isCaptureOnlyWake
+ * Check if the current wake up is only for a capture: telegram commands polling is not due yet, so WiFi is not needed
+ * @return    true if capture only; false otherwise
+ */
+bool Timelapse::isCaptureOnlyWake() {
+  return __timelapse.captureOnlyWake && ((getTimestamp() + _TIMELAPSE_EARLY_MARGIN) < __timelapse.nextPoll);
+}
+
+
+/**
+ * Timelapse::recordFrame
+ * Add a captured frame to the frames waiting for upload, and schedule the next capture
+ * @param filename    Frame path on SD Card, relative to the base path
+ * @param timestamp   Capture timestamp
+ */
+void Timelapse::recordFrame(const char* filename, unsigned long timestamp) {
+  __timelapse.nextCapture = _getNextCapture(timestamp);
+  __timelapse.frames++;
+  if(__timelapse.lastUpload == 0) __timelapse.lastUpload = timestamp;
+
+  //If full, the oldest frame is not uploaded
+  if(__timelapse.pendingCount == _TIMELAPSE_MAX_PENDING) {
+    __timelapse.pendingFirst = (__timelapse.pendingFirst + 1) % _TIMELAPSE_MAX_PENDING;
+    __timelapse.pendingCount--;
+    __timelapse.framesDropped++;
+  }
+  uint8_t i = (__timelapse.pendingFirst + __timelapse.pendingCount) % _TIMELAPSE_MAX_PENDING;
+  memset(__timelapse.pending[i], 0x00, _TIMELAPSE_FILENAME_LENGTH);
+  strncpy(__timelapse.pending[i], filename, (_TIMELAPSE_FILENAME_LENGTH - 1));
+  __timelapse.pendingTimestamps[i] = timestamp;
+  __timelapse.pendingCount++;
+}
+
+
+/**
+ * Timelapse::recordCaptureOnlyWake
+ * Add the cost of a capture only wake up to the statistics
+ * @param awakeMillis   Wake up duration
+ */
+void Timelapse::recordCaptureOnlyWake(unsigned long awakeMillis) {
+  __timelapse.captureOnlyWakes++;
+  __timelapse.captureOnlyMillis += awakeMillis;
+}
+
+
+/**
+ * Timelapse::isUploadDue
+ * Check if the frames waiting for upload should be uploaded (upload interval elapsed or frames list full)
+ * @return    true if the upload is due; false otherwise
+ */
+bool Timelapse::isUploadDue() {
+  if(__timelapse.pendingCount == 0) return false;
+  if(__timelapse.pendingCount == _TIMELAPSE_MAX_PENDING) return true;
+  unsigned long now = getTimestamp();
+  return (now < __timelapse.lastUpload) || ((now - __timelapse.lastUpload) >= _uploadInterval);
+}
+
+
+/**
+ * Timelapse::getPendingFrames
+ * Get number of frames waiting for upload
+ * @return    Number of frames
+ */
+uint8_t Timelapse::getPendingFrames() {
+  return __timelapse.pendingCount;
+}
+
+
+/**
+ * Timelapse::getPendingFrame
+ * Get the oldest frame waiting for upload
+ * @return    Frame path on SD Card, relative to the base path (empty if none)
+ */
+const char* Timelapse::getPendingFrame() {
+  if(__timelapse.pendingCount == 0) return "";
+  return __timelapse.pending[__timelapse.pendingFirst];
+}
+
+
+/**
+ * Timelapse::getPendingFrameTimestamp
+ * Get capture timestamp of the oldest frame waiting for upload
+ * @return    Capture timestamp (0 if none)
+ */
+unsigned long Timelapse::getPendingFrameTimestamp() {
+  if(__timelapse.pendingCount == 0) return 0;
+  return __timelapse.pendingTimestamps[__timelapse.pendingFirst];
+}
+
+
+/**
+ * Timelapse::removePendingFrame
+ * Remove the oldest frame waiting for upload (i.e. when uploaded)
+ */
+void Timelapse::removePendingFrame() {
+  if(__timelapse.pendingCount == 0) return;
+  __timelapse.pendingFirst = (__timelapse.pendingFirst + 1) % _TIMELAPSE_MAX_PENDING;
+  __timelapse.pendingCount--;
+}
+
+
+/**
+ * Timelapse::recordUpload
+ * Add an upload session to the statistics
+ * @param frames        Number of uploaded frames (if 0, the upload is retried on the next wake up with WiFi)
+ * @param awakeMillis   Wake up duration, until the end of the upload
+ */
+void Timelapse::recordUpload(uint8_t frames, unsigned long awakeMillis) {
+  if(frames == 0) return;
+  __timelapse.batches++;
+  __timelapse.framesUploaded += frames;
+  __timelapse.uploadMillis += awakeMillis;
+  __timelapse.lastUpload = getTimestamp();
+}
+
+
+/**
+ * Timelapse::getSleepDuration
+ * Get deep sleep duration: until the next telegram commands polling, or until the next capture if it comes first
+ * (in this case the next wake up is capture only)
+ * @param pollSleep   In seconds, time between telegram commands polling
+ * @param polled      true if telegram commands were polled in the current wake up
+ * @return            Deep sleep duration in seconds
+ */
+unsigned long Timelapse::getSleepDuration(unsigned long pollSleep, bool polled) {
+  unsigned long now = getTimestamp();
+  if(polled || (__timelapse.nextPoll <= now) || (__timelapse.nextPoll > (now + 86400))) __timelapse.nextPoll = now + pollSleep;
+  unsigned long sleep = __timelapse.nextPoll - now;
+
+  //Next capture
+  __timelapse.captureOnlyWake = false;
+  if(isEnabled() && (now > 1000000000)) {
+    if(__timelapse.nextCapture <= now) __timelapse.nextCapture = _getNextCapture(now);
+    if(((__timelapse.nextCapture - now) < sleep) && _isInWindow(getHour(__timelapse.nextCapture))) {
+      sleep = __timelapse.nextCapture - now;
+      __timelapse.captureOnlyWake = true;
+    }
+  }
+
+  return (sleep > 0) ? sleep : 1;
+}
+
+
+/**
+ * Timelapse::getStats
+ * Get frames statistics and per-frame cost (wake up time, as energy proxy)
+ * @return    Statistics, one per line
+ */
+String Timelapse::getStats() {
+  String stats = " [+] Frames: " + String(__timelapse.frames) + " captured, " + String(__timelapse.framesUploaded) + " uploaded in " + String(__timelapse.batches) + " batches, " + String(__timelapse.pendingCount) + " waiting\n";
+  if(__timelapse.framesDropped > 0) stats += " [-] Frames not uploaded (queue full): " + String(__timelapse.framesDropped) + "\n";
+  if(__timelapse.captureOnlyWakes > 0) stats += " [+] Capture only wake up: " + String(__timelapse.captureOnlyMillis / __timelapse.captureOnlyWakes) + " ms\n";
+  if(__timelapse.framesUploaded > 0) stats += " [+] Upload wake up, per frame: " + String(__timelapse.uploadMillis / __timelapse.framesUploaded) + " ms\n";
+  if((__timelapse.captureOnlyWakes > 0) && (__timelapse.framesUploaded > 0)) {
+    stats += " [+] Cost per frame: " + String((__timelapse.captureOnlyMillis / __timelapse.captureOnlyWakes) + (__timelapse.uploadMillis / __timelapse.framesUploaded)) + " ms awake\n";
+  }
+  return stats;
+}
+
+
+/**
+ * Timelapse::_isInWindow
+ * Check if an hour of day is in the captures window
+ * @param hour    Hour of day (0-23)
+ * @return        true if in the window; false otherwise
+ */
+bool Timelapse::_isInWindow(int8_t hour) {
+  if(__timelapse.startHour < __timelapse.endHour) return (hour >= __timelapse.startHour) && (hour < __timelapse.endHour);
+  return (hour >= __timelapse.startHour) || (hour < __timelapse.endHour);
+}
+
+
+/**
+ * Timelapse::_getNextCapture
+ * Get the next capture timestamp, aligned to the interval (i.e. every 15 minutes: at :00, :15, :30, :45)
+ * @param timestamp   Current timestamp
+ * @return            Next capture timestamp
+ */
+unsigned long Timelapse::_getNextCapture(unsigned long timestamp) {
+  unsigned long interval = __timelapse.interval * 60UL;
+  if(interval == 0) return 0;
+  unsigned long t = timestamp + _TIMELAPSE_EARLY_MARGIN;
+  return t - (t % interval) + interval;
+}
@@ -0,0 +1,59 @@
+/**
+ * @package Wildlife Camera
+ * Scheduled timelapse header
+ * @author WizLab.it
+ * @board AI-Thinker ESP32-CAM
+ * @version 20261018.001
+ */
+
+#ifndef TIMELAPSE_H
+#define TIMELAPSE_H
+
+
+/**
+ * Defines
+ */
+#define _TIMELAPSE_MAX_PENDING        24    //Frames waiting for upload kept in RTC memory (oldest are not uploaded if full, but stay on SD Card)
+#define _TIMELAPSE_FILENAME_LENGTH    48    //Max length of a frame path, relative to the SD Card base path
+#define _TIMELAPSE_EARLY_MARGIN       5     //In seconds, a capture is due also if the timer wakes up slightly early
+
+
+/**
+ * Includes
+ */
+#include <Arduino.h>
+#include "logger.h"
+#include "extern.h"
+
+
+/**
+ * Class definition
+ */
+class Timelapse {
+  private:
+    unsigned long _uploadInterval;
+
+    bool _isInWindow(int8_t hour);
+    unsigned long _getNextCapture(unsigned long timestamp);
+
+  public:
+    Timelapse(uint16_t interval, uint8_t startHour, uint8_t endHour, unsigned long uploadInterval);
+    bool configure(uint16_t interval, uint8_t startHour, uint8_t endHour);
+    bool isEnabled();
+    String getSchedule();
+    bool isCaptureDue();
+    bool isCaptureOnlyWake();
+    void recordFrame(const char* filename, unsigned long timestamp);
+    void recordCaptureOnlyWake(unsigned long awakeMillis);
+    bool isUploadDue();
+    uint8_t getPendingFrames();
+    const char* getPendingFrame();
+    unsigned long getPendingFrameTimestamp();
+    void removePendingFrame();
+    void recordUpload(uint8_t frames, unsigned long awakeMillis);
+    unsigned long getSleepDuration(unsigned long pollSleep, bool polled);
+    String getStats();
+};
+
+
+#endif